@@ -13,6 +13,7 @@
 #include <motor_controllers/communication/i_binary_signal_channel.h>
 #include <stdint.h>
 
+#include <atomic>  // std::atomic
 #include <list>
 #include <thread>  // std::thread
 
@@ -68,6 +69,25 @@ class BCM2835BinaryChannel : public IBinarySignalChannel {
    */
   std::future<BinarySignal> asyncDetectEvent() final override;
 
+  /**
+   * @brief Get a future object with the detected event and its timestamp if
+   * channel is EVENT_DETECT
+   *
+   * Can be stoped with interuptEventDetection.
+   *
+   * @return std::future<EdgeEvent>
+   */
+  std::future<EdgeEvent> asyncDetectEdgeEvent() final override;
+
+  /**
+   * @brief Subscribe to the events if channel is EVENT_DETECT.
+   *
+   * A single thread polls the pin for the whole life of the stream.
+   *
+   * @return EdgeEventStream::Ref
+   */
+  EdgeEventStream::Ref subscribeEdgeEvents() final override;
+
   /**
    * @brief Starts a thread to check the event and call callback.
    *
@@ -109,12 +129,15 @@ class BCM2835BinaryChannel : public IBinarySignalChannel {
 
   void setupEventDetection(const EventDetectType&);
 
+  EdgeEvent pollEdgeEvent();
+
  private:
   const uint8_t pinNumber_;
   const EventDetectType eventDetectValue_;
   std::thread detectEventThread_;
   bool detectEventThreadAlive_;
   bool detectEventAsyncAlive_;
+  std::atomic<bool> subscribed_;
 };
 }  // namespace communication
 }  // namespace motor_controllers
\ No newline at end of file
@@ -75,6 +75,14 @@ class BCM2835PWMChannel : public IPWMSignalChannel {
    */
   void setDutyCycle(float dutyCycle) final override;
 
+  /**
+   * @brief Set the duty cycle in the counts of the hardware, without floating
+   * point: the same as setDutyCycle(counts / getMaxValue()).
+   *
+   * @param counts between getMinValue and getMaxValue, clamped
+   */
+  void setRawDutyCycle(uint32_t counts) final override;
+
   /**
    * @brief Get the minimum value that can be send as PWM signal.
    *
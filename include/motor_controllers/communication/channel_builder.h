@@ -90,9 +90,13 @@ class ChannelBuilder : public ICommunicationInterface {
    */
   virtual ChannelMode* createChannel(const Configuration& channel) = 0;
 
+ protected:
   /**
    * @brief Unregister a channel from the communication
    *
+   * Implementations holding references to their channels can override it to
+   * drop them, and must call this one.
+   *
    * @param channel
    */
   virtual void unregisterChannel(ISignalChannel* channel) {
@@ -0,0 +1,119 @@
+/**
+ * @file gpio_cdev_binary_channel.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-05-30
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/queued_binary_signal_channel.h>
+#include <stdint.h>  // uint32_t, uint64_t
+
+namespace motor_controllers {
+
+namespace communication {
+
+/**
+ * @brief Bias applied by the GPIO chip on an input line.
+ *
+ */
+enum class GpioCdevBias { AS_IS, DISABLED, PULL_UP, PULL_DOWN };
+
+/**
+ * @brief Binary channel on a line of a Linux GPIO character device.
+ *
+ * Allows to set, get or detect events on a single line. The line is requested
+ * by the GpioCdevInterface together with the other lines of the chip.
+ *
+ * In EVENT_DETECT mode, the edges are detected by the kernel, from the GPIO
+ * interrupt, and timestamped there. The interface's reader thread publishes
+ * them to the queue of the consumer (subscribeEdgeEvents, asyncDetectEvent...)
+ * which drains it at its own pace. If the consumer falls behind by more than
+ * the queue capacity, the newest events are dropped and counted, see
+ * getOverflowCount.
+ *
+ * See: https://www.kernel.org/doc/html/latest/userspace-api/gpio/chardev.html
+ *
+ */
+class GpioCdevBinaryChannel : public QueuedBinarySignalChannel {
+ public:
+  struct Configuration {
+    uint32_t lineOffset;
+    ChannelMode channelMode;
+    EventDetectType eventDetectValue = EventDetectType::NONE;
+    GpioCdevBias bias = GpioCdevBias::PULL_UP;
+  };
+
+ public:
+  /**
+   * @brief Construct a new GpioCdevBinaryChannel for a line.
+   *
+   * This should not be called manually but rather call
+   * GpioCdevInterface::createChannel.
+   */
+  GpioCdevBinaryChannel(const Configuration& builder);
+
+  virtual ~GpioCdevBinaryChannel();
+
+  GpioCdevBinaryChannel(const GpioCdevBinaryChannel&) = delete;
+
+  GpioCdevBinaryChannel& operator=(const GpioCdevBinaryChannel&) = delete;
+
+ public:
+  /**
+   * @brief Set the value if the channel is set to OUTPUT.
+   *
+   */
+  void set(const BinarySignal&) final override;
+
+  /**
+   * @brief Get the value of the line.
+   *
+   * @return BinarySignal the level read on the line.
+   */
+  BinarySignal get() final override;
+
+ public:
+  /**
+   * @brief Attach the channel to the line request of its interface.
+   *
+   * @param requestFd file descriptor of the line request
+   * @param index index of the line in the request
+   */
+  void initialize(int requestFd, unsigned int index);
+
+  void clean();
+
+  /**
+   * @brief Queue an edge read by the interface. Never blocks.
+   *
+   * @param event
+   */
+  void onEdgeEvent(const EdgeEvent& event);
+
+  uint32_t getLineOffset() const;
+
+  /**
+   * @brief Flags of the line in the request, see linux/gpio.h
+   *
+   * @return uint64_t
+   */
+  uint64_t getLineFlags() const;
+
+ private:
+  void setInternal(const BinarySignal&);
+
+ private:
+  const uint32_t lineOffset_;
+  const EventDetectType eventDetectValue_;
+  const GpioCdevBias bias_;
+
+  int requestFd_;
+  uint64_t mask_;  // bit of the line in the request
+};
+}  // namespace communication
+}  // namespace motor_controllers
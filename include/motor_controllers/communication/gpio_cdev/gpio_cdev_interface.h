@@ -0,0 +1,127 @@
+/**
+ * @file gpio_cdev_interface.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-05-30
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/channel_builder.h>
+#include <motor_controllers/communication/gpio_cdev/gpio_cdev_binary_channel.h>
+
+#include <atomic>  // std::atomic
+#include <functional>
+#include <mutex>   // std::mutex
+#include <string>  // std::string
+#include <thread>  // std::thread
+#include <vector>  // std::vector
+
+namespace motor_controllers {
+
+namespace communication {
+using GpioCdevBinaryChannelRef =
+    std::unique_ptr<GpioCdevBinaryChannel,
+                    std::function<void(ISignalChannel*)>>;
+
+/**
+ * @brief Communication class for a Linux GPIO character device.
+ *
+ * Uses the v2 ioctl API of /dev/gpiochipN. Unlike BCM2835 and pigpio, it only
+ * takes the lines it is asked for and the edges are detected and timestamped
+ * by the kernel from the GPIO interrupt: no core is spent polling.
+ *
+ * All the channels of the interface are requested together on start, which
+ * gives a single file descriptor for the whole group. The edge events of all
+ * the lines are read from it in batches, either by a reader thread sleeping in
+ * epoll, or by the user's own event loop with getEventFileDescriptor and
+ * processEvents.
+ *
+ * Works with any chip, including the gpio-sim kernel module to run without a
+ * Raspberry Pi.
+ *
+ * See: https://www.kernel.org/doc/html/latest/userspace-api/gpio/chardev.html
+ *
+ */
+class GpioCdevInterface : public ChannelBuilder<GpioCdevBinaryChannel,
+                                                GpioCdevBinaryChannel::Configuration> {
+ public:
+  /**
+   * @brief Construct a new GpioCdevInterface object
+   *
+   * @param chipPath path of the character device, e.g. /dev/gpiochip0
+   * @param readerThread if true, start a thread to read the events. Otherwise
+   * call processEvents when getEventFileDescriptor is readable.
+   */
+  GpioCdevInterface(const std::string& chipPath = "/dev/gpiochip0",
+                    bool readerThread = true);
+
+  /**
+   * @brief Destroy the GpioCdevInterface object
+   *
+   * Also stops the communication
+   */
+  ~GpioCdevInterface();
+
+ public:
+  /**
+   * @brief Request the lines of all the channels and start reading events.
+   *
+   */
+  void start() override;
+
+  /**
+   * @brief Release the lines.
+   *
+   */
+  void stop() override;
+
+  /**
+   * @brief File descriptor of the line request, readable when edge events are
+   * pending. Can be added to an epoll set.
+   *
+   * @return int -1 if not started
+   */
+  int getEventFileDescriptor() const;
+
+  /**
+   * @brief Read the pending edge events and dispatch them to their channels.
+   *
+   * Does not block. Only call it when the reader thread is disabled.
+   *
+   * @return size_t number of events read
+   */
+  size_t processEvents();
+
+ private:
+  GpioCdevBinaryChannel* createChannel(
+      const GpioCdevBinaryChannel::Configuration& channel) final override;
+
+  void unregisterChannel(ISignalChannel* channel) final override;
+
+  void readEvents();
+
+ private:
+  // Edge events read per read() call
+  static constexpr size_t kEventBatchSize = 64;
+
+ private:
+  const std::string chipPath_;
+  const bool useReaderThread_;
+  bool running_;
+
+  int requestFd_;
+  int epollFd_;
+  int stopFd_;  // eventfd waking up the reader thread
+  std::thread readerThread_;
+
+  // Channel receiving the events of each line offset. Guarded against the
+  // removal of channels while the events are dispatched.
+  std::vector<GpioCdevBinaryChannel*> channelsByOffset_;
+  std::mutex dispatchMutex_;
+};
+}  // namespace communication
+}  // namespace motor_controllers
@@ -0,0 +1,48 @@
+/**
+ * @file i_batch_writer.h
+ * @author Pierre Venet
+ * @brief Interfaces able to send the writes of many channels together.
+ * @version 0.1
+ * @date 2021-06-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <cstddef>  // size_t
+
+namespace motor_controllers {
+namespace communication {
+
+/**
+ * @brief Communication interface whose channel writes can be grouped: between
+ * beginBatch() and flush(), the values are kept, then sent in as few bus
+ * transactions as possible.
+ *
+ * Used by the owners of many channels, e.g. motor::ServoGroup, to commit a
+ * frame at once. A batch only holds the writes of the thread which began it.
+ *
+ */
+class IBatchWriter {
+ public:
+  virtual ~IBatchWriter() = default;
+
+ public:
+  /**
+   * @brief Keep the values of the channels instead of sending them, until
+   * flush().
+   *
+   */
+  virtual void beginBatch() = 0;
+
+  /**
+   * @brief Send the values kept since beginBatch() and stop keeping them.
+   *
+   * @return size_t number of bus transactions sent
+   */
+  virtual size_t flush() = 0;
+};
+
+}  // namespace communication
+}  // namespace motor_controllers
@@ -11,7 +11,11 @@
 #pragma once
 
 #include <motor_controllers/communication/i_signal_channel.h>
+#include <motor_controllers/utils/semaphore.h>
+#include <stdint.h>  // uint64_t
 
+#include <atomic>  // std::atomic
+#include <chrono>  // std::chrono::steady_clock
 #include <future>  // std::async, std::future
 
 namespace motor_controllers {
@@ -27,6 +31,90 @@ enum class EventDetectType {
   EVENT_BOTH_EDGES,
   NONE
 };
+
+/**
+ * @brief An event detected on a channel and the time it occured.
+ *
+ * The timestamp is taken as close to the source as the backend allows (the
+ * hardware tick for pigpio, the end of the polling loop for bcm2835) and is
+ * expressed on the steady clock, such that events of different channels and
+ * backends can be compared.
+ *
+ */
+struct EdgeEvent {
+  BinarySignal level;
+  std::chrono::steady_clock::time_point timestamp;
+};
+
+/**
+ * @brief Long lived subscription to the events of an EVENT_DETECT channel.
+ *
+ * A stream is obtained once with IBinarySignalChannel::subscribeEdgeEvents and
+ * reused for every edge, instead of creating a future, and its thread, per
+ * edge. Events are queued by the backend until they are read.
+ *
+ * A stream has a single reader and must be destroyed before the channel that
+ * created it. Destroying it cancels the subscription.
+ *
+ */
+class EdgeEventStream {
+ public:
+  typedef std::unique_ptr<EdgeEventStream> Ref;
+
+ public:
+  virtual ~EdgeEventStream() = default;
+
+ public:
+  /**
+   * @brief Get the next event if there is one, without blocking.
+   *
+   * @param event set if an event was available
+   * @return true if an event was read
+   */
+  virtual bool tryNext(EdgeEvent& event) = 0;
+
+  /**
+   * @brief Block until the next event, the timeout or the cancellation.
+   *
+   * @param event set if an event was available
+   * @param timeout
+   * @return true if an event was read
+   */
+  virtual bool waitNext(EdgeEvent& event,
+                        std::chrono::nanoseconds timeout) = 0;
+
+  /**
+   * @brief Also post notifier for every new event.
+   *
+   * Allows a reader to block on several streams at once: wait on the shared
+   * notifier, then tryNext on each stream. The notifier must outlive the
+   * stream, pass nullptr to detach it.
+   *
+   * @param notifier
+   */
+  virtual void setNotifier(utils::Semaphore* notifier) = 0;
+
+  /**
+   * @brief Stop the subscription and wake up the reader. Idempotent.
+   *
+   */
+  virtual void cancel() = 0;
+
+  /**
+   * @brief Flag if the stream was cancelled.
+   *
+   * @return true if no more events will be delivered
+   */
+  virtual bool isCancelled() const = 0;
+
+  /**
+   * @brief Number of events dropped because the reader was too slow.
+   *
+   * @return uint64_t
+   */
+  virtual uint64_t getOverflowCount() const = 0;
+};
+
 /**
  * @brief Class to represent a channel used to send a signal
  *
@@ -89,6 +177,29 @@ class IBinarySignalChannel : public ISignalChannel {
    */
   virtual std::future<BinarySignal> asyncDetectEvent() = 0;
 
+  /**
+   * @brief Same as asyncDetectEvent but the future also holds the time at
+   * which the event was detected by the backend.
+   *
+   * If the channel is configured on EVENT_DETECT.
+   *
+   */
+  virtual std::future<EdgeEvent> asyncDetectEdgeEvent() = 0;
+
+  /**
+   * @brief Subscribe to the events of the channel.
+   *
+   * If the channel is configured on EVENT_DETECT. Prefer this to
+   * asyncDetectEdgeEvent when reading many events: the stream is created once
+   * and does not start a thread per event.
+   *
+   * Only one subscription may be active at a time and it cannot be mixed with
+   * asyncDetectEvent or onDetectEvent.
+   *
+   * @return EdgeEventStream::Ref
+   */
+  virtual EdgeEventStream::Ref subscribeEdgeEvents() = 0;
+
   /**
    * @brief Create a thread and call the callback at every detected event
    *
@@ -110,8 +221,45 @@ class IBinarySignalChannel : public ISignalChannel {
    */
   const ChannelMode& getChannelMode() const;
 
+  /**
+   * @brief Number of levels set on the pin, as an OUTPUT.
+   *
+   * @return uint64_t
+   */
+  uint64_t getWriteCount() const;
+
+  /**
+   * @brief Number of set() skipped because the pin already had the level.
+   *
+   * @return uint64_t
+   */
+  uint64_t getSkippedWriteCount() const;
+
+  /**
+   * @brief Forget the level last written, when the pin may have changed
+   * behind the channel (initialization, reset): the next set() is sent even if
+   * it is the same.
+   *
+   */
+  void invalidateLevel();
+
+ protected:
+  /**
+   * @brief Called by the implementations of set() before writing the pin.
+   *
+   * @param level
+   * @return false if it is the level last written: skip the write
+   */
+  bool commitLevel(BinarySignal level);
+
  protected:
   const ChannelMode channelType_;
+
+ private:
+  static constexpr int8_t kUnknownLevel = -1;
+
+  std::atomic<int8_t> committedLevel_;
+  std::atomic<uint64_t> writeCount_, skippedWriteCount_;
 };
 
 }  // namespace communication
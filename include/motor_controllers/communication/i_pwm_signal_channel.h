@@ -12,6 +12,9 @@
 
 #include <motor_controllers/communication/i_signal_channel.h>
 
+#include <atomic>   // std::atomic
+#include <cstdint>  // uint32_t, uint64_t
+
 namespace motor_controllers {
 namespace communication {
 
@@ -65,6 +68,14 @@ class IPWMSignalChannel : public ISignalChannel {
    */
   virtual void setDutyCycle(float dutyCycle) = 0;
 
+  /**
+   * @brief Set the duty cycle in the counts of the hardware, without floating
+   * point: the same as setDutyCycle(counts / getMaxValue()).
+   *
+   * @param counts between getMinValue and getMaxValue, clamped
+   */
+  virtual void setRawDutyCycle(uint32_t counts) = 0;
+
   /**
    * @brief Get the minimum value that can be send as PWM signal.
    *
@@ -78,6 +89,45 @@ class IPWMSignalChannel : public ISignalChannel {
    * @return float
    */
   virtual float getMaxValue() const = 0;
+
+  /**
+   * @brief Number of writes sent to the hardware.
+   *
+   * @return uint64_t
+   */
+  uint64_t getWriteCount() const;
+
+  /**
+   * @brief Number of writes skipped because the hardware already had the
+   * value, e.g. the same duty cycle once quantized to the range.
+   *
+   * @return uint64_t
+   */
+  uint64_t getSkippedWriteCount() const;
+
+  /**
+   * @brief Forget the value last written, when the hardware may have changed
+   * behind the channel (initialization, reset, write to all the channels):
+   * the next write is sent even if it is the same.
+   *
+   */
+  void invalidateValue();
+
+ protected:
+  /**
+   * @brief Called by the implementations before writing to the hardware, with
+   * the value as it is encoded for the hardware (e.g. the on and off counts).
+   *
+   * @param value
+   * @return false if it is the value last written: skip the write
+   */
+  bool commitValue(uint64_t value);
+
+ private:
+  static constexpr uint64_t kUnknownValue = ~uint64_t(0);
+
+  std::atomic<uint64_t> committedValue_;
+  std::atomic<uint64_t> writeCount_, skippedWriteCount_;
 };
 
 }  // namespace communication
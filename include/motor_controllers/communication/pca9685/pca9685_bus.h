@@ -0,0 +1,192 @@
+/**
+ * @file pca9685_bus.h
+ * @author Pierre Venet
+ * @brief I2C bus shared by several PCA9685 boards.
+ * @version 0.1
+ * @date 2021-06-16
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <atomic>   // std::atomic
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint16_t, uint64_t
+#include <memory>   // std::shared_ptr
+#include <mutex>    // std::mutex
+#include <string>   // std::string
+#include <thread>   // std::thread::id
+#include <vector>   // std::vector
+
+struct i2c_msg;
+
+namespace motor_controllers {
+namespace communication {
+
+class PCA9685Interface;
+
+/**
+ * @brief Opens an i2c adapter once for all the PCA9685 boards chained on it.
+ *
+ * The boards are PCA9685Interface created with the bus and their address.
+ * Every transfer names its address in an I2C_RDWR message, so no ioctl is
+ * needed to switch from one board to the next, and between beginFrame() and
+ * flush() the writes of all the boards are queued and sent together, up to
+ * 42 messages per ioctl: one system call per frame instead of one per board.
+ * As the batch of a board, the frame belongs to the thread which began it:
+ * the writes of the other threads, e.g. a motor control loop or a writer
+ * thread, are sent at once.
+ *
+ * The boards also answer the ALLCALL address, which stopAll() and
+ * setPWMFrequency() use to reach all of them in a single write. These
+ * broadcasts are never queued.
+ *
+ */
+class PCA9685Bus {
+ public:
+  typedef std::shared_ptr<PCA9685Bus> Ref;
+
+ public:
+  /**
+   * @brief Open the adapter.
+   *
+   * @param port the i2c file, e.g. /dev/i2c-1
+   */
+  explicit PCA9685Bus(const std::string& port);
+
+  ~PCA9685Bus();
+
+  PCA9685Bus(const PCA9685Bus&) = delete;
+
+  PCA9685Bus& operator=(const PCA9685Bus&) = delete;
+
+ public:
+  /**
+   * @brief Queue the writes of the boards made by the calling thread until it
+   * calls flush(), instead of sending each of them in its own transfer.
+   *
+   * @throws std::runtime_error if another thread has a frame open
+   */
+  void beginFrame();
+
+  /**
+   * @brief Send the writes queued since beginFrame() and stop queuing.
+   *
+   * @return size_t number of ioctl
+   * @throws std::runtime_error if the frame was begun by another thread, or
+   * the transfer failed
+   */
+  size_t flush();
+
+  /**
+   * @brief Turn off the outputs of all the boards, with one write to the
+   * ALLCALL address. The writes queued in a frame are dropped.
+   *
+   */
+  void stopAll();
+
+  /**
+   * @brief Set the PWM frequency of all the boards at once, through the
+   * ALLCALL address. The boards must use their internal oscillator.
+   *
+   * @param frequency in hertz
+   * @param oscillatorFrequency of the boards, in hertz
+   */
+  void setPWMFrequency(float frequency, float oscillatorFrequency = 27e6);
+
+  /**
+   * @brief Number of messages sent: one per write, two per read.
+   *
+   * @return uint64_t
+   */
+  uint64_t getMessageCount() const;
+
+  /**
+   * @brief Number of I2C_RDWR ioctl, i.e. system calls.
+   *
+   * @return uint64_t
+   */
+  uint64_t getTransferCount() const;
+
+  /**
+   * @brief Value of the PRE_SCALE register for a PWM frequency.
+   *
+   * @param frequency in hertz
+   * @param oscillatorFrequency in hertz
+   * @return uint8_t
+   */
+  static uint8_t prescaleOf(float frequency, float oscillatorFrequency);
+
+ private:
+  friend class PCA9685Interface;
+
+  /**
+   * @brief Write bytes to a board, the first being the register address.
+   * Queued if the calling thread has a frame open.
+   *
+   * @param address of the board
+   * @param bytes
+   * @param size
+   */
+  void write(uint16_t address, const uint8_t* bytes, size_t size);
+
+  /**
+   * @brief Read consecutive registers of a board, in one transfer. Sent
+   * right away, even in a frame.
+   *
+   * @param address of the board
+   * @param reg first register
+   * @param values
+   * @param size
+   */
+  void read(uint16_t address, uint8_t reg, uint8_t* values, size_t size);
+
+  /**
+   * @brief Send a write right away, with the mutex held.
+   *
+   * @param address of the board
+   * @param bytes
+   * @param size
+   */
+  void send(uint16_t address, const uint8_t* bytes, size_t size);
+
+  void attach(PCA9685Interface* board);
+
+  void detach(PCA9685Interface* board);
+
+  /**
+   * @brief Send messages, at most 42 per ioctl, with the mutex held.
+   *
+   * @param messages
+   * @param count
+   * @return size_t number of ioctl
+   */
+  size_t transfer(struct i2c_msg* messages, size_t count);
+
+ private:
+  struct Message {
+    uint16_t address;
+    size_t offset;  // in buffer_
+    size_t size;
+  };
+
+  const std::string port_;
+  int file_;
+
+  std::thread::id frameThread_;  // default id if no frame
+  std::vector<Message> messages_;
+  std::vector<uint8_t> buffer_;  // bytes of the queued messages
+
+  std::atomic<uint64_t> messageCount_, transferCount_;
+
+  // Held while using the file and the queue
+  std::mutex mutex_;
+
+  // Held while broadcasting, before the mutex of the boards, then mutex_
+  std::vector<PCA9685Interface*> boards_;
+  std::mutex boardsMutex_;
+};
+
+}  // namespace communication
+}  // namespace motor_controllers
@@ -73,6 +73,14 @@ class PCA9685Channel : public IPWMSignalChannel {
    */
   void setDutyCycle(float dutyCycle) final override;
 
+  /**
+   * @brief Set the duty cycle in the counts of the hardware, without floating
+   * point: the same as setDutyCycle(counts / getMaxValue()).
+   *
+   * @param counts between getMinValue and getMaxValue, clamped
+   */
+  void setRawDutyCycle(uint32_t counts) final override;
+
   /**
    * @brief Get the minimum value that can be send as PWM signal.
    *
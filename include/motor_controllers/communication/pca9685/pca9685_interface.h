@@ -11,11 +11,19 @@
  */
 #pragma once
 #include <motor_controllers/communication/channel_builder.h>
+#include <motor_controllers/communication/i_batch_writer.h>
 #include <motor_controllers/communication/i_communication_interface.h>
+#include <motor_controllers/communication/pca9685/pca9685_bus.h>
 #include <motor_controllers/communication/pca9685/pca9685_channel.h>
+#include <motor_controllers/utils/semaphore.h>
 
-#include <map>
+#include <atomic>   // std::atomic
+#include <bitset>   // std::bitset
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint16_t, uint32_t, uint64_t
+#include <mutex>    // std::mutex
 #include <string>
+#include <thread>  // std::thread
 
 namespace motor_controllers {
 
@@ -31,9 +39,36 @@ using PCA9685ChannelRef =
  * allow to control one of the 16 channels. This class only deals with the
  * communication, not with the data to send.
  *
+ * Each write of a channel is a bus transaction. To update many channels at
+ * once, e.g. the servos of a robot at every frame, call beginBatch(), set the
+ * channels, then flush(): the values are sent in one write per run of
+ * consecutive channels, the registers of the channels being contiguous and
+ * the chip auto-incrementing the address. The batch belongs to the thread
+ * which began it: only its writes are staged, the other threads keep writing
+ * their channels at once, e.g. the control loop of a motor on the same board
+ * during a frame of servos. Another thread cannot begin a batch before it is
+ * flushed.
+ *
+ * The interface keeps a copy of the registers it wrote or read: the
+ * read-modify-write of the mode registers need no read, and only the bytes
+ * which differ from the chip are sent. If the chip may have been reset behind
+ * the interface, e.g. by a brownout, call resync().
+ *
+ * With a writer thread, the writes of the channels do not wait for the bus:
+ * they store the value in the slot of the channel and mark it dirty, then the
+ * thread sends all the dirty channels in one batch. A value replaced before
+ * the thread reads it is never sent. Between beginBatch() and flush(), the
+ * writes of the batch thread do not wake the writer, so that a frame is sent
+ * together. The writes of the other threads still wake it at once, and it
+ * sends the channels of the batch already set with them.
+ *
+ * Several boards on the same i2c adapter share a PCA9685Bus, see there to send
+ * the frames of all the boards in one system call.
+ *
  */
 class PCA9685Interface
-    : public ChannelBuilder<PCA9685Channel, PCA9685Channel::Configuration> {
+    : public ChannelBuilder<PCA9685Channel, PCA9685Channel::Configuration>,
+      public IBatchWriter {
  public:
   /**
    * @brief Construct a new PCA9685Interface object
@@ -44,13 +79,29 @@ class PCA9685Interface
    *
    * @param port the i2c file to open the connection
    * @param i2cAdress the adress of the PCA9685 chip on the BUS.
+   * @param writerThread if true, start() starts a thread sending the values
+   * of the channels, which then never block on the bus.
+   */
+  PCA9685Interface(const std::string& port, int i2cAdress,
+                   bool writerThread = false);
+
+  /**
+   * @brief Construct a new PCA9685Interface object, for a board on a bus
+   * shared with other boards.
+   *
+   * @param bus opened i2c adapter
+   * @param i2cAdress the adress of the PCA9685 chip on the BUS.
+   * @param writerThread if true, start() starts a thread sending the values
+   * of the channels, which then never block on the bus.
    */
-  PCA9685Interface(const std::string& port, int i2cAdress);
+  PCA9685Interface(PCA9685Bus::Ref bus, int i2cAdress,
+                   bool writerThread = false);
 
   /**
    * @brief Destroy the PCA9685Interface object
    *
-   * Only when the object is destroyed, is the i2c file closed.
+   * Only when the object and the other boards of the bus are destroyed, is
+   * the i2c file closed.
    *
    */
   ~PCA9685Interface();
@@ -81,7 +132,60 @@ class PCA9685Interface
    */
   void setOscillatorFrequency(float frequency, bool externalClock = false);
 
+  /**
+   * @brief Read back the mode, prescale and channel registers from the chip,
+   * after the registers changed behind the interface, e.g. when a brownout
+   * reset the chip. The next write of each channel is sent if it differs from
+   * the chip.
+   *
+   */
+  void resync();
+
+  /**
+   * @brief Stage the values of the channels set by the calling thread instead
+   * of sending them, until it calls flush(). Setting a channel twice only
+   * sends the last value.
+   *
+   * @throws std::runtime_error if another thread has a batch open
+   */
+  void beginBatch() override;
+
+  /**
+   * @brief Send the values staged since beginBatch() and stop staging.
+   *
+   * The runs of consecutive channels are sent as plain I2C messages, not SMBus
+   * block writes, so all the 16 channels fit in a single 65 bytes transaction.
+   * In a frame of the bus, the transactions are queued with the ones of the
+   * other boards.
+   * Only the registers which change are sent, with the unchanged ones between
+   * two changes when that saves a transaction.
+   *
+   * @return size_t number of bus transactions sent, 0 with a writer thread
+   * which sends them
+   * @throws std::runtime_error if the batch was begun by another thread
+   */
+  size_t flush() override;
+
+  /**
+   * @brief Number of bus transactions, reads and writes, to measure the frame
+   * rate the bus allows.
+   *
+   * @return uint64_t
+   */
+  uint64_t getTransactionCount() const;
+
+  /**
+   * @brief Number of channel writes, or batches of the writer thread, which
+   * failed on the bus. They do not throw: the channels send their next value
+   * again.
+   *
+   * @return uint64_t
+   */
+  uint64_t getWriteErrorCount() const;
+
  private:
+  friend class PCA9685Bus;
+
   void restart();
 
   void sleep();
@@ -94,6 +198,76 @@ class PCA9685Interface
 
   void setChannelValue(uint8_t channel, uint8_t* values);
 
+  bool isBatchOwner() const {
+    return this->batchThread_.load(std::memory_order_relaxed) ==
+           std::this_thread::get_id();
+  }
+
+  /**
+   * @brief Set the 4 registers of every channel, in one transaction.
+   *
+   * @param value
+   */
+  void setAllChannelValues(uint8_t value);
+
+  /**
+   * @brief Update the shadow copy after the 4 registers of every channel were
+   * set to value, through ALL_LED or ALLCALL, and drop the values staged or
+   * waiting for the writer thread. Under busMutex_.
+   *
+   * @param value
+   */
+  void onAllChannelsWritten(uint8_t value);
+
+  /**
+   * @brief Forget the channel registers after a failed write, so that the
+   * next value of every channel is sent.
+   *
+   */
+  void invalidateChannels();
+
+  /**
+   * @brief Register value, read from the chip if the shadow copy does not
+   * know it.
+   *
+   * @param address
+   * @return uint8_t
+   */
+  uint8_t readRegister(uint8_t address);
+
+  /**
+   * @brief Write a register, unless the chip already has the value.
+   *
+   * @param address
+   * @param value
+   */
+  void writeRegister(uint8_t address, uint8_t value);
+
+  /**
+   * @brief Write consecutive registers in one transaction, relying on the
+   * auto-increment of the address.
+   *
+   * @param address of the first register
+   * @param values
+   * @param size number of registers
+   */
+  void writeRegisters(uint8_t address, const uint8_t* values, size_t size);
+
+  /**
+   * @brief Send the staged channels, with the bus mutex held.
+   *
+   * @return size_t number of bus transactions
+   */
+  size_t sendStaged();
+
+  /**
+   * @brief Loop of the writer thread.
+   *
+   */
+  void writeChannels();
+
+  void stopWriter();
+
   /**
    * @brief Set pwmFrequency_
    *
@@ -113,12 +287,41 @@ class PCA9685Interface
   PCA9685Channel* createChannel(
       const PCA9685Channel::Configuration& channelBuilder) final override;
 
+  void unregisterChannel(ISignalChannel* channel) final override;
+
  private:
-  int file_;
+  PCA9685Bus::Ref bus_;
+  const uint16_t address_;
   float oscillatorFrequency_;
   float pwmFrequency_;
   bool externalClock_;
-  std::map<uint8_t, PCA9685Channel*> channels_;
+
+  // Shadow copy of the registers
+  uint8_t registers_[256];
+  std::bitset<256> knownRegisters_;
+
+  // Batch of channel values, 4 registers per channel
+  static constexpr size_t kChannelCount = 16;
+  // Resent rather than starting a new transaction, about the cost of the
+  // start, address and register bytes
+  static constexpr size_t kMaxResentBytes = 4;
+  std::atomic<std::thread::id> batchThread_;  // default id if no batch
+  uint16_t stagedChannels_;  // bit i set if channel i is staged
+  uint8_t staged_[kChannelCount * 4];
+
+  std::atomic<uint64_t> transactionCount_;
+
+  // Writer thread, and the latest value of each channel: its 4 registers
+  const bool useWriterThread_;
+  std::atomic<bool> isWriterRunning_;
+  std::thread writerThread_;
+  utils::Semaphore wakeWriter_;
+  std::atomic<uint32_t> latestValues_[kChannelCount];
+  std::atomic<uint32_t> dirtyChannels_;  // bit i set if channel i changed
+  std::atomic<uint64_t> writeErrorCount_;
+
+  // Held while using the board, the shadow copy and the batch
+  std::mutex busMutex_;
 };
 }  // namespace communication
 }  // namespace motor_controllers
\ No newline at end of file
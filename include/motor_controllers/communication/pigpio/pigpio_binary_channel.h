@@ -10,11 +10,9 @@
  */
 #pragma once
 
-#include <motor_controllers/communication/i_binary_signal_channel.h>
+#include <motor_controllers/communication/queued_binary_signal_channel.h>
 #include <stdint.h>  // uint8_t, uint32_t
 
-#include <thread>  // std::thread
-
 namespace motor_controllers {
 
 namespace communication {
@@ -24,10 +22,16 @@ namespace communication {
  *
  * Allows to set, get or detect events on a single pin using pigpio.
  *
+ * In EVENT_DETECT mode, pigpio's alert thread publishes every level it
+ * reports, timestamped from its tick, to the queue of the consumer
+ * (subscribeEdgeEvents, asyncDetectEvent...) and returns immediately. If the
+ * consumer falls behind by more than the queue capacity, the newest events
+ * are dropped and counted, see getOverflowCount.
+ *
  * See: http://abyz.me.uk/rpi/pigpio/cif.html#
  *
  */
-class PiGPIOBinaryChannel : public IBinarySignalChannel {
+class PiGPIOBinaryChannel : public QueuedBinarySignalChannel {
  public:
   struct Configuration {
     uint8_t pinNumber;
@@ -64,32 +68,6 @@ class PiGPIOBinaryChannel : public IBinarySignalChannel {
    */
   BinarySignal get() final override;
 
-  /**
-   * @brief Get a future object with the detected event if channel is
-   * EVENT_DETECT
-   *
-   * Can be stoped with interuptEventDetection.
-   *
-   * @return std::future<BinarySignal>
-   */
-  std::future<BinarySignal> asyncDetectEvent() final override;
-
-  /**
-   * @brief Starts a thread to check the event and call callback.
-   *
-   * Can be stoped with interuptEventDetection.
-   *
-   * @param callback
-   */
-  void onDetectEvent(
-      const std::function<void(BinarySignal)>& callback) final override;
-
-  /**
-   * @brief Stops the thread or async waiting for event
-   *
-   */
-  void interuptEventDetection() final override;
-
  public:
   /**
    * @brief Initialize the channel
@@ -117,15 +95,6 @@ class PiGPIOBinaryChannel : public IBinarySignalChannel {
   const uint8_t pinNumber_;
 
   const EventDetectType eventDetectValue_;
-  std::thread detectEventThread_;
-  bool detectEventThreadAlive_;
-  bool detectEventAsyncAlive_;
-
-  BinarySignal eventDetectCurrentValue_;
-  std::mutex eventDetectionMutex_;
-  std::condition_variable eventDetectionCondVar_;
-  bool eventDetectionReady_;
-  bool eventDetectionProcessed_;
 };
 }  // namespace communication
 }  // namespace motor_controllers
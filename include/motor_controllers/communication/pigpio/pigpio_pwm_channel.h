@@ -94,6 +94,14 @@ class PiGPIOPWMChannel : public IPWMSignalChannel {
    */
   void setDutyCycle(float dutyCycle) final override;
 
+  /**
+   * @brief Set the duty cycle in the counts of the hardware, without floating
+   * point: the same as setDutyCycle(counts / getMaxValue()).
+   *
+   * @param counts between getMinValue and getMaxValue, clamped
+   */
+  void setRawDutyCycle(uint32_t counts) final override;
+
   /**
    * @brief Get the minimum value that can be send as PWM signal.
    *
@@ -118,6 +126,14 @@ class PiGPIOPWMChannel : public IPWMSignalChannel {
    */
   void initialize();
 
+ private:
+  /**
+   * @brief Send the duty cycle unless it is the one last written.
+   *
+   * @param dc in counts of the range
+   */
+  void writeDutyCycle(unsigned int dc);
+
  private:
   const uint8_t pinNumber_;
   const uint32_t range_;
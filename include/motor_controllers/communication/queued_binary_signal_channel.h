@@ -0,0 +1,148 @@
+/**
+ * @file queued_binary_signal_channel.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-06-18
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/i_binary_signal_channel.h>
+#include <motor_controllers/communication/queued_edge_event_stream.h>
+
+#include <atomic>  // std::atomic
+#include <memory>  // std::shared_ptr
+#include <thread>  // std::thread
+
+namespace motor_controllers {
+namespace communication {
+
+/**
+ * @brief Binary channel whose edges are published by a producer running for
+ * the whole life of the channel: an alert callback, a reader thread, a
+ * simulation...
+ *
+ * The producer calls publishEdgeEvent(), which never blocks. The event goes
+ * to the QueuedEdgeEventStream of the consumer attached to the channel, if
+ * any: the subscription, or the stream of asyncDetectEvent / onDetectEvent.
+ * Only one consumer may be attached at a time, the edges detected while none
+ * is are not queued.
+ *
+ */
+class QueuedBinarySignalChannel : public IBinarySignalChannel {
+ public:
+  QueuedBinarySignalChannel(const ChannelMode& channelMode);
+
+  virtual ~QueuedBinarySignalChannel();
+
+  QueuedBinarySignalChannel(const QueuedBinarySignalChannel&) = delete;
+
+  QueuedBinarySignalChannel& operator=(const QueuedBinarySignalChannel&) =
+      delete;
+
+ public:
+  /**
+   * @brief Get a future object with the detected event if channel is
+   * EVENT_DETECT
+   *
+   * The events are queued from the first call until interuptEventDetection,
+   * the next calls read them in order.
+   *
+   * @return std::future<BinarySignal>
+   */
+  std::future<BinarySignal> asyncDetectEvent() final override;
+
+  /**
+   * @brief Same as asyncDetectEvent, with the timestamp of the event.
+   *
+   * @return std::future<EdgeEvent>
+   */
+  std::future<EdgeEvent> asyncDetectEdgeEvent() final override;
+
+  /**
+   * @brief Subscribe to the events if channel is EVENT_DETECT.
+   *
+   * The stream is fed by the producer of the channel, no thread is created.
+   *
+   * @return EdgeEventStream::Ref
+   */
+  EdgeEventStream::Ref subscribeEdgeEvents() final override;
+
+  /**
+   * @brief Starts a thread to check the event and call callback.
+   *
+   * Can be stoped with interuptEventDetection.
+   *
+   * @param callback
+   */
+  void onDetectEvent(
+      const std::function<void(BinarySignal)>& callback) final override;
+
+  /**
+   * @brief Stops the thread or async waiting for event
+   *
+   */
+  void interuptEventDetection() final override;
+
+  /**
+   * @brief Number of events dropped because the consumer was too slow.
+   *
+   * @return uint64_t
+   */
+  uint64_t getOverflowCount() const;
+
+ protected:
+  /**
+   * @brief Give an edge to the consumer. Producer side, never blocks.
+   *
+   * @param event
+   * @return true if queued, false if there is no consumer or it is too slow
+   */
+  bool publishEdgeEvent(const EdgeEvent& event) noexcept;
+
+ protected:
+  EdgeEvent lastEvent_;  // returned when the detection is interupted
+
+ private:
+  class Stream;
+
+  /**
+   * @brief Publish to a stream, for a detection or a subscription.
+   *
+   * @param stream
+   */
+  void attach(Stream* stream);
+
+  /**
+   * @brief Stream of asyncDetectEvent, attached by the first call.
+   *
+   * @return std::shared_ptr<Stream>
+   */
+  std::shared_ptr<Stream> asyncDetection();
+
+  /**
+   * @brief Stop publishing to a stream and wait for a publish in progress.
+   * Does nothing if it is not attached.
+   *
+   * @param stream
+   */
+  void detach(Stream* stream);
+
+  static EdgeEvent waitEdgeEvent(Stream& stream);
+
+ private:
+  // Written by the consumer side, read by the producer.
+  std::atomic<Stream*> stream_;
+  std::atomic<int> publishing_;  // producers between load and publish
+  std::atomic<uint64_t> overflowCount_;
+
+  // Stream of asyncDetectEvent or onDetectEvent, shared with the futures
+  std::shared_ptr<Stream> detection_;
+  std::thread detectEventThread_;
+};
+
+}  // namespace communication
+}  // namespace motor_controllers
@@ -0,0 +1,89 @@
+/**
+ * @file queued_edge_event_stream.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-05-25
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/i_binary_signal_channel.h>
+#include <motor_controllers/utils/semaphore.h>
+#include <motor_controllers/utils/spsc_ring_buffer.h>
+
+#include <atomic>  // std::atomic
+
+namespace motor_controllers {
+namespace communication {
+
+/**
+ * @brief EdgeEventStream backed by a bounded lock-free queue.
+ *
+ * Building block for the backends: the producer (a polling thread, an
+ * interrupt handler...) calls publish() which never blocks, the reader uses
+ * the EdgeEventStream interface. Backends that need to stop a producer on
+ * cancellation override cancel() and call this implementation.
+ *
+ * The semaphore of the reader is only posted when it blocks in waitNext, and
+ * setNotifier / cancel wait for a publish() in progress to be done with the
+ * previous notifier: once they return, it is not posted anymore.
+ *
+ */
+class QueuedEdgeEventStream : public EdgeEventStream {
+ public:
+  // Must hold the events between two reads of the slowest reader.
+  static constexpr size_t kCapacity = 1024;
+
+ public:
+  QueuedEdgeEventStream();
+
+  virtual ~QueuedEdgeEventStream() = default;
+
+  QueuedEdgeEventStream(const QueuedEdgeEventStream&) = delete;
+
+  QueuedEdgeEventStream& operator=(const QueuedEdgeEventStream&) = delete;
+
+ public:
+  bool tryNext(EdgeEvent& event) override;
+
+  bool waitNext(EdgeEvent& event, std::chrono::nanoseconds timeout) override;
+
+  void setNotifier(utils::Semaphore* notifier) override;
+
+  void cancel() override;
+
+  bool isCancelled() const override;
+
+  uint64_t getOverflowCount() const override;
+
+ public:
+  /**
+   * @brief Queue an event for the reader. Producer side, never blocks.
+   *
+   * @param event
+   * @return true if queued, false if the queue was full and it was dropped
+   */
+  bool publish(const EdgeEvent& event) noexcept;
+
+ private:
+  /**
+   * @brief Wait for the publish() which may still use the previous notifier.
+   *
+   */
+  void waitPublishers() const;
+
+ private:
+  utils::SpscRingBuffer<EdgeEvent, kCapacity> events_;
+  utils::Semaphore eventsAvailable_;
+  std::atomic<bool> waiting_;  // the reader blocks on eventsAvailable_
+  std::atomic<utils::Semaphore*> notifier_;
+  std::atomic<int> publishing_;  // producers between load and post
+  std::atomic<bool> cancelled_;
+  std::atomic<uint64_t> overflowCount_;
+};
+
+}  // namespace communication
+}  // namespace motor_controllers
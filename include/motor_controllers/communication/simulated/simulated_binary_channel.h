@@ -0,0 +1,83 @@
+/**
+ * @file simulated_binary_channel.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-06-01
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/queued_binary_signal_channel.h>
+#include <stdint.h>  // uint8_t
+
+#include <atomic>  // std::atomic
+
+namespace motor_controllers {
+
+namespace communication {
+
+/**
+ * @brief Binary channel of the SimulatedInterface.
+ *
+ * OUTPUT channels store the level set, read by the simulation. INPUT and
+ * EVENT_DETECT channels have their level set by the simulation, which
+ * timestamps the edges on its clock. As with the hardware backends, the edges
+ * are published to the queue of the consumer (subscribeEdgeEvents,
+ * asyncDetectEvent...), the newest being dropped and counted if it falls
+ * behind, see getOverflowCount.
+ *
+ */
+class SimulatedBinaryChannel : public QueuedBinarySignalChannel {
+ public:
+  struct Configuration {
+    uint8_t pinNumber;
+    ChannelMode channelMode;
+    EventDetectType eventDetectValue = EventDetectType::NONE;
+  };
+
+ public:
+  /**
+   * @brief Construct a new SimulatedBinaryChannel for a pin.
+   *
+   * This should not be called manually but rather call
+   * SimulatedInterface::createChannel.
+   */
+  SimulatedBinaryChannel(const Configuration& builder);
+
+  virtual ~SimulatedBinaryChannel();
+
+  SimulatedBinaryChannel(const SimulatedBinaryChannel&) = delete;
+
+  SimulatedBinaryChannel& operator=(const SimulatedBinaryChannel&) = delete;
+
+ public:
+  void set(const BinarySignal&) final override;
+
+  BinarySignal get() final override;
+
+ public:
+  uint8_t getPinNumber() const;
+
+  /**
+   * @brief Set the level from the simulation, queue an event if it matches
+   * the detection. Never blocks.
+   *
+   * @param level
+   * @param timestamp on the simulation clock
+   */
+  void simulateLevel(BinarySignal level,
+                     std::chrono::steady_clock::time_point timestamp);
+
+ private:
+  bool isDetected(BinarySignal previous, BinarySignal level) const;
+
+ private:
+  const uint8_t pinNumber_;
+  const EventDetectType eventDetectValue_;
+  std::atomic<BinarySignal> level_;
+};
+}  // namespace communication
+}  // namespace motor_controllers
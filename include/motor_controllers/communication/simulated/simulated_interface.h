@@ -0,0 +1,203 @@
+/**
+ * @file simulated_interface.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-06-01
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/channel_builder.h>
+#include <motor_controllers/communication/simulated/simulated_binary_channel.h>
+#include <motor_controllers/communication/simulated/simulated_pwm_channel.h>
+
+#include <atomic>  // std::atomic
+#include <chrono>  // std::chrono
+#include <functional>
+#include <memory>  // std::unique_ptr
+#include <mutex>   // std::mutex
+#include <thread>  // std::thread
+#include <vector>  // std::vector
+
+namespace motor_controllers {
+
+namespace communication {
+using SimulatedPWMChannelRef =
+    std::unique_ptr<SimulatedPWMChannel, std::function<void(ISignalChannel*)>>;
+using SimulatedBinaryChannelRef =
+    std::unique_ptr<SimulatedBinaryChannel,
+                    std::function<void(ISignalChannel*)>>;
+
+/**
+ * @brief DC motor and encoder simulated by the SimulatedInterface.
+ *
+ * The motor is wired to the channels of the interface by their pin numbers,
+ * like it would be on a board. Pins without channel are left unconnected.
+ *
+ * The speed follows a first order model: the steady state speed is
+ * proportional to the duty cycle above the deadzone, reached with the time
+ * constant.
+ *
+ */
+struct SimulatedMotorModel {
+  // Driver: PWM and direction pins, as given to the DCMotor
+  uint8_t pwmPin;
+  std::vector<uint8_t> directionPins;
+  std::vector<BinarySignal> forwardConfiguration;
+  std::vector<BinarySignal> backwardConfiguration;
+
+  // Encoder, encoderPinB < 0 for a single channel encoder
+  uint8_t encoderPinA;
+  int encoderPinB = -1;
+  unsigned int encoderResolution = 13;
+
+  // Motor constants
+  double maxSpeed = 8000.0 / 60.0;  // rotations per second at full duty cycle
+  double timeConstant = 0.05;       // in seconds
+  double deadzone = 0.1;            // duty cycle under which it does not move
+};
+
+/**
+ * @brief Communication class simulating DC motors with encoders.
+ *
+ * Provides the PWM and binary channels of a board without any hardware, such
+ * that the DCMotor, Encoder and DCMotorFactory can be run and measured on any
+ * Linux box.
+ *
+ * A thread integrates the motor models by fixed steps and generates the
+ * quadrature edges of their encoders on the EVENT_DETECT channels. The edges
+ * are timestamped on the simulation clock, which starts at start() and runs in
+ * real time with a time scale of 1.
+ *
+ * Only a time scale of 1 gives valid results with an Encoder or a DCMotor:
+ * they compare the timestamps with the real steady_clock::now() and run their
+ * loops on it. With another scale, e.g. 0 for as fast as possible, the edges
+ * are in the future or the past of the real clock: only the model itself,
+ * getMotorSpeed() and getMotorPosition(), is then meaningful.
+ *
+ */
+class SimulatedInterface
+    : public ChannelBuilder<SimulatedPWMChannel,
+                            SimulatedPWMChannel::Configuration>,
+      public ChannelBuilder<SimulatedBinaryChannel,
+                            SimulatedBinaryChannel::Configuration> {
+ public:
+  /**
+   * @brief Construct a new SimulatedInterface object
+   *
+   * @param timeScale simulated time per real time, 1 for real time, 0 as fast
+   * as possible. Any other scale than 1 is for the model alone, see above
+   * @param step simulated time integrated at once
+   */
+  SimulatedInterface(double timeScale = 1.0,
+                     std::chrono::microseconds step =
+                         std::chrono::microseconds(100));
+
+  /**
+   * @brief Destroy the SimulatedInterface object
+   *
+   * Also stops the simulation
+   */
+  ~SimulatedInterface();
+
+ public:
+  using ChannelBuilder<SimulatedBinaryChannel,
+                       SimulatedBinaryChannel::Configuration>::configureChannel;
+  using ChannelBuilder<SimulatedPWMChannel,
+                       SimulatedPWMChannel::Configuration>::configureChannel;
+
+  /**
+   * @brief Add a motor to simulate. Only when stopped.
+   *
+   * @param model
+   * @return size_t index of the motor
+   */
+  size_t addMotor(const SimulatedMotorModel& model);
+
+  /**
+   * @brief Wire the motors to the channels and start the simulation.
+   *
+   */
+  void start() override;
+
+  /**
+   * @brief Stop the simulation.
+   *
+   */
+  void stop() override;
+
+  /**
+   * @brief Simulated speed of a motor, the ground truth for the encoder.
+   *
+   * @param motor index given by addMotor
+   * @return double in rotations per second, negative when going backward
+   */
+  double getMotorSpeed(size_t motor) const;
+
+  /**
+   * @brief Simulated position of a motor.
+   *
+   * @param motor index given by addMotor
+   * @return int64_t in encoder edges
+   */
+  int64_t getMotorPosition(size_t motor) const;
+
+  /**
+   * @brief Time elapsed on the simulation clock since start.
+   *
+   * @return std::chrono::nanoseconds
+   */
+  std::chrono::nanoseconds getSimulationTime() const;
+
+ private:
+  SimulatedPWMChannel* createChannel(
+      const SimulatedPWMChannel::Configuration& channel) final override;
+
+  SimulatedBinaryChannel* createChannel(
+      const SimulatedBinaryChannel::Configuration& channel) final override;
+
+  void unregisterChannel(ISignalChannel* channel) final override;
+
+  void simulate();
+
+ private:
+  struct Motor {
+    SimulatedMotorModel model;
+    double edgesPerRevolution;
+
+    // Wiring, resolved at start
+    SimulatedPWMChannel* pwm = nullptr;
+    std::vector<SimulatedBinaryChannel*> direction;
+    SimulatedBinaryChannel *encoderA = nullptr, *encoderB = nullptr;
+
+    // State, written by the simulation thread
+    double speed = 0.0;     // rotations per second
+    double position = 0.0;  // in edges
+    std::atomic<double> publishedSpeed{0.0};
+    std::atomic<int64_t> publishedPosition{0};
+  };
+
+  void wire(Motor& motor);
+
+  void stepMotor(Motor& motor, double dt,
+                 std::chrono::steady_clock::time_point stepStart);
+
+ private:
+  const double timeScale_;
+  const std::chrono::microseconds step_;
+
+  std::vector<std::unique_ptr<Motor>> motors_;
+
+  std::atomic<bool> running_;
+  std::thread simulationThread_;
+  std::chrono::steady_clock::time_point startTime_;
+  std::atomic<int64_t> simulationTime_;  // in nanoseconds
+
+  // Guards the wiring against the removal of channels while simulating.
+  std::mutex wiringMutex_;
+};
+}  // namespace communication
+}  // namespace motor_controllers
@@ -0,0 +1,100 @@
+/**
+ * @file simulated_pwm_channel.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-06-01
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/i_pwm_signal_channel.h>
+#include <stdint.h>
+
+#include <atomic>  // std::atomic
+
+namespace motor_controllers {
+
+namespace communication {
+
+/**
+ * @brief PWM channel of the SimulatedInterface.
+ *
+ * Only stores the duty cycle, read by the simulation of the motor it drives.
+ *
+ */
+class SimulatedPWMChannel : public IPWMSignalChannel {
+ public:
+  struct Configuration {
+    uint8_t pinNumber;
+    unsigned int range = 4096;  // resolution of the duty cycle, as a PCA9685
+  };
+
+ public:
+  /**
+   * @brief Construct a new SimulatedPWMChannel for a pin
+   *
+   * Please use SimulatedInterface::createChannel instead of using the
+   * constructor.
+   */
+  SimulatedPWMChannel(const Configuration& builder);
+
+  ~SimulatedPWMChannel() = default;
+
+  SimulatedPWMChannel(const SimulatedPWMChannel&) = delete;
+
+  SimulatedPWMChannel& operator=(const SimulatedPWMChannel&) = delete;
+
+ public:
+  void setPWMFrequency(float frequency) final override;
+
+  /**
+   * @brief Set the Pulse Width Modulation
+   *
+   * @param start start of the signal on the period, in [0, 1]
+   * @param end end of the signal on the period, in [0, 1]
+   */
+  void setPWM(float start, float end) final override;
+
+  /**
+   * @brief Set the duty cycle seen by the simulation
+   *
+   * @param dutyCycle a number between 0 and 1
+   */
+  void setDutyCycle(float dutyCycle) final override;
+
+  /**
+   * @brief Set the duty cycle in counts of the range
+   *
+   * @param counts between 0 and the range, clamped
+   */
+  void setRawDutyCycle(uint32_t counts) final override;
+
+  float getMinValue() const final override;
+
+  /**
+   * @brief The range of the configuration.
+   *
+   * @return float
+   */
+  float getMaxValue() const final override;
+
+ public:
+  uint8_t getPinNumber() const;
+
+  /**
+   * @brief Duty cycle last set, read by the simulation thread.
+   *
+   * @return float
+   */
+  float getDutyCycle() const;
+
+ private:
+  const uint8_t pinNumber_;
+  const unsigned int range_;
+  std::atomic<float> dutyCycle_;
+};
+}  // namespace communication
+}  // namespace motor_controllers
@@ -0,0 +1,192 @@
+/**
+ * @file fixed_pid_controller.h
+ * @author Pierre Venet
+ * @brief P, PI and PID controllers in fixed point.
+ * @version 0.1
+ * @date 2021-06-15
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/controller/pid_controller.h>
+#include <motor_controllers/utils/fixed_point.h>
+
+#include <algorithm>    // std::clamp
+#include <chrono>       // std::chrono
+#include <cstdint>      // int64_t
+#include <type_traits>  // std::true_type, std::void_t
+
+namespace motor_controllers {
+namespace controller {
+
+/**
+ * @brief Same controller as BasicPIDController, computed with integers only.
+ *
+ * The parameters are converted once, then an update is a few 64 bits
+ * multiplications and shifts: no floating point and no division, for the cores
+ * whose FPU is slow or missing. The targets, measurements and outputs are in
+ * Q format. The integral and the derivative keep kFractionBits more fraction
+ * bits, Ki·dt being small for short periods.
+ *
+ * Used by BasicDCMotor, it maps the duty cycles straight to the integer range
+ * of the PWM channel, see IPWMSignalChannel::setRawDutyCycle.
+ *
+ * @tparam kIntegral
+ * @tparam kDerivative
+ * @tparam kFractionBits of the values, 16 for Q16.16
+ */
+template <bool kIntegral, bool kDerivative, int kFractionBits = 16>
+class BasicFixedPIDController {
+ public:
+  typedef ControllerParameters Parameters;
+  typedef utils::Fixed<kFractionBits> Value;
+
+ public:
+  explicit BasicFixedPIDController(const Parameters& parameters = Parameters())
+      : parameters_(parameters),
+        Kp_(Value::fromDouble(parameters.Kp)),
+        Kff_(Value::fromDouble(parameters.Kff)),
+        outputMin_(Value::fromDouble(parameters.outputMin)),
+        outputMax_(Value::fromDouble(parameters.outputMax)) {
+    this->reset(std::chrono::microseconds(1000));
+  }
+
+ public:
+  /**
+   * @brief Clear the state, before the first update.
+   *
+   * @param dt period of the updates
+   */
+  void reset(std::chrono::microseconds dt) noexcept {
+    const Parameters& p = this->parameters_;
+    const double seconds = dt.count() * 1e-6;
+    this->KiDt_ = toWide(p.Ki * seconds);
+    this->KdInverseDt_ = static_cast<int64_t>(p.Kd / seconds * Value::kOne);
+    this->derivativeAlpha_ = static_cast<int64_t>(
+        seconds / (p.derivativeTimeConstant + seconds) * Value::kOne);
+    this->integral_ = 0;
+    this->derivative_ = 0;
+    this->previousMeasurement_ = Value();
+    this->hasPreviousMeasurement_ = false;
+  }
+
+  /**
+   * @brief Compute the command of one period.
+   *
+   * @param target
+   * @param measurement
+   * @return Value, within [outputMin, outputMax]
+   */
+  Value update(Value target, Value measurement) noexcept {
+    const Value error = target - measurement;
+
+    // Wide: kFractionBits more fraction bits, on 64 bits.
+    int64_t output =
+        (static_cast<int64_t>(this->Kp_.raw()) * error.raw() +
+         static_cast<int64_t>(this->Kff_.raw()) * target.raw());
+
+    if constexpr (kDerivative) {
+      // Kd/dt is folded in the rate, the filter does not change its scale.
+      const int64_t rate =
+          this->hasPreviousMeasurement_
+              ? (measurement - this->previousMeasurement_).raw() *
+                    this->KdInverseDt_
+              : 0;
+      this->previousMeasurement_ = measurement;
+      this->hasPreviousMeasurement_ = true;
+      this->derivative_ +=
+          ((rate - this->derivative_) >> kFractionBits) *
+          this->derivativeAlpha_;
+      output -= this->derivative_;
+    }
+
+    const int64_t min = static_cast<int64_t>(this->outputMin_.raw())
+                        << kFractionBits;
+    const int64_t max = static_cast<int64_t>(this->outputMax_.raw())
+                        << kFractionBits;
+
+    if constexpr (kIntegral) {
+      const int64_t integral =
+          this->integral_ + (error.raw() * this->KiDt_ >> kFractionBits);
+      const int64_t unclamped = output + integral;
+      const bool windingUp = (unclamped > max && error.raw() > 0) ||
+                             (unclamped < min && error.raw() < 0);
+      if (!windingUp) {
+        this->integral_ = integral;
+      }
+      output += this->integral_;
+    }
+
+    return Value::fromRaw(
+        static_cast<int32_t>(std::clamp(output, min, max) >> kFractionBits));
+  }
+
+  /**
+   * @brief Same update, converting from and to floating point.
+   *
+   * @param target
+   * @param measurement
+   * @return double
+   */
+  double update(double target, double measurement) noexcept {
+    return this->update(Value::fromDouble(target),
+                        Value::fromDouble(measurement))
+        .toDouble();
+  }
+
+  const Parameters& getParameters() const { return this->parameters_; }
+
+  /**
+   * @brief Integral term of the output, 0 without integral action.
+   *
+   * @return double
+   */
+  double getIntegral() const noexcept {
+    return kIntegral ? static_cast<double>(this->integral_) /
+                           (static_cast<double>(Value::kOne) * Value::kOne)
+                     : 0.0;
+  }
+
+ private:
+  // A constant with 2·kFractionBits fraction bits.
+  static int64_t toWide(double value) {
+    return static_cast<int64_t>(value * Value::kOne * Value::kOne);
+  }
+
+ private:
+  Parameters parameters_;
+  Value Kp_, Kff_, outputMin_, outputMax_;
+
+  int64_t KiDt_;  // wide
+  int64_t KdInverseDt_;
+  int64_t derivativeAlpha_;
+
+  // Wide state
+  int64_t integral_;
+  int64_t derivative_;  // filtered Kd · rate of the measurement
+
+  Value previousMeasurement_;
+  bool hasPreviousMeasurement_;
+};
+
+typedef BasicFixedPIDController<false, false> FixedPController;
+typedef BasicFixedPIDController<true, false> FixedPIController;
+typedef BasicFixedPIDController<true, true> FixedPIDController;
+
+/**
+ * @brief True for the policies computing on a Value fixed-point type, such as
+ * FixedPIController.
+ *
+ * @tparam Policy
+ */
+template <class Policy, class = void>
+struct IsFixedPoint : std::false_type {};
+
+template <class Policy>
+struct IsFixedPoint<Policy, std::void_t<typename Policy::Value>>
+    : std::true_type {};
+
+}  // namespace controller
+}  // namespace motor_controllers
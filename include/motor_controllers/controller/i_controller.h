@@ -0,0 +1,129 @@
+/**
+ * @file i_controller.h
+ * @author Pierre Venet
+ * @brief Runtime interface of the controllers.
+ * @version 0.1
+ * @date 2021-06-07
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <chrono>       // std::chrono
+#include <memory>       // std::unique_ptr
+#include <type_traits>  // std::true_type, std::void_t
+#include <utility>      // std::move, std::declval
+
+namespace motor_controllers {
+namespace controller {
+
+/**
+ * @brief Controller chosen at runtime, e.g. from Python.
+ *
+ * Same methods as the compile-time policies such as PIDController, behind a
+ * virtual call.
+ *
+ */
+class IController {
+ public:
+  typedef std::unique_ptr<IController> Ref;
+
+ public:
+  virtual ~IController() = default;
+
+  /**
+   * @brief Clear the state, before the first update.
+   *
+   * @param dt period of the updates
+   */
+  virtual void reset(std::chrono::microseconds dt) = 0;
+
+  /**
+   * @brief Compute the command of one period.
+   *
+   * @param target
+   * @param measurement
+   * @return double
+   */
+  virtual double update(double target, double measurement) = 0;
+
+  /**
+   * @brief Integral term of the last command, for the telemetry.
+   *
+   * @return double, 0 for controllers without one
+   */
+  virtual double getIntegral() const { return 0.0; }
+};
+
+template <class Policy, class = void>
+struct HasIntegral : std::false_type {};
+
+template <class Policy>
+struct HasIntegral<
+    Policy, std::void_t<decltype(std::declval<const Policy&>().getIntegral())>>
+    : std::true_type {};
+
+/**
+ * @brief Integral term of a policy, 0 when it does not tell.
+ *
+ * @tparam Policy
+ * @param policy
+ * @return double
+ */
+template <class Policy>
+double integralOf(const Policy& policy) {
+  if constexpr (HasIntegral<Policy>::value) {
+    return policy.getIntegral();
+  } else {
+    return 0.0;
+  }
+}
+
+/**
+ * @brief IController implemented by a compile-time policy.
+ *
+ * @tparam Policy e.g. PIDController
+ */
+template <class Policy>
+class PolicyController final : public IController {
+ public:
+  explicit PolicyController(const Policy& policy = Policy())
+      : policy_(policy) {}
+
+  void reset(std::chrono::microseconds dt) override { this->policy_.reset(dt); }
+
+  double update(double target, double measurement) override {
+    return this->policy_.update(target, measurement);
+  }
+
+  double getIntegral() const override { return integralOf(this->policy_); }
+
+ private:
+  Policy policy_;
+};
+
+/**
+ * @brief Policy forwarding to an IController, for the motors whose controller
+ * is chosen at runtime.
+ *
+ */
+class DynamicController {
+ public:
+  explicit DynamicController(IController::Ref controller)
+      : controller_(std::move(controller)) {}
+
+  void reset(std::chrono::microseconds dt) { this->controller_->reset(dt); }
+
+  double update(double target, double measurement) {
+    return this->controller_->update(target, measurement);
+  }
+
+  double getIntegral() const { return this->controller_->getIntegral(); }
+
+ private:
+  IController::Ref controller_;
+};
+
+}  // namespace controller
+}  // namespace motor_controllers
@@ -0,0 +1,147 @@
+/**
+ * @file pid_controller.h
+ * @author Pierre Venet
+ * @brief P, PI and PID controllers as compile-time policies.
+ * @version 0.1
+ * @date 2021-06-07
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <algorithm>  // std::clamp
+#include <chrono>     // std::chrono
+#include <limits>     // std::numeric_limits
+
+namespace motor_controllers {
+namespace controller {
+
+/**
+ * @brief Constants of the P, PI and PID controllers. The terms a controller
+ * does not have are ignored.
+ *
+ */
+struct ControllerParameters {
+  double Kp = 1.0, Ki = 0.0, Kd = 0.0;
+
+  // Low pass filter of the derivative, 0 for none
+  double derivativeTimeConstant = 0.0;  // in seconds
+
+  // Added to the output: Kff * target
+  double Kff = 0.0;
+
+  // The output is clamped, and the integral stops growing when it saturates
+  double outputMin = -std::numeric_limits<double>::infinity();
+  double outputMax = std::numeric_limits<double>::infinity();
+};
+
+/**
+ * @brief PID controller whose terms are chosen at compile time.
+ *
+ * Meant to be a template argument of BasicDCMotor: the update is non virtual,
+ * does not allocate, and the missing terms are removed by the compiler.
+ *
+ * - the integral uses clamping anti-windup: it is frozen while the output
+ * saturates in the direction of the error,
+ * - the derivative is taken on the measurement, so a change of target does not
+ * kick the output, and low pass filtered.
+ *
+ * @tparam kIntegral
+ * @tparam kDerivative
+ */
+template <bool kIntegral, bool kDerivative>
+class BasicPIDController {
+ public:
+  typedef ControllerParameters Parameters;
+
+ public:
+  explicit BasicPIDController(const Parameters& parameters = Parameters())
+      : parameters_(parameters) {
+    this->reset(std::chrono::microseconds(1000));
+  }
+
+ public:
+  /**
+   * @brief Clear the state, before the first update.
+   *
+   * @param dt period of the updates
+   */
+  void reset(std::chrono::microseconds dt) noexcept {
+    this->dt_ = dt.count() * 1e-6;
+    this->inverseDt_ = 1.0 / this->dt_;
+    this->derivativeAlpha_ =
+        this->dt_ / (this->parameters_.derivativeTimeConstant + this->dt_);
+    this->integral_ = 0.0;
+    this->derivative_ = 0.0;
+    this->previousMeasurement_ = 0.0;
+    this->hasPreviousMeasurement_ = false;
+  }
+
+  /**
+   * @brief Compute the command of one period.
+   *
+   * @param target
+   * @param measurement
+   * @return double, within [outputMin, outputMax]
+   */
+  double update(double target, double measurement) noexcept {
+    const Parameters& p = this->parameters_;
+    const double error = target - measurement;
+
+    double output = p.Kp * error + p.Kff * target;
+
+    if constexpr (kDerivative) {
+      const double rate =
+          this->hasPreviousMeasurement_
+              ? (measurement - this->previousMeasurement_) * this->inverseDt_
+              : 0.0;
+      this->previousMeasurement_ = measurement;
+      this->hasPreviousMeasurement_ = true;
+      this->derivative_ += this->derivativeAlpha_ * (rate - this->derivative_);
+      output -= p.Kd * this->derivative_;
+    }
+
+    if constexpr (kIntegral) {
+      // Ki is inside the integral, changing it does not bump the output.
+      const double integral = this->integral_ + p.Ki * error * this->dt_;
+      const double unclamped = output + integral;
+      const bool windingUp = (unclamped > p.outputMax && error > 0) ||
+                             (unclamped < p.outputMin && error < 0);
+      if (!windingUp) {
+        this->integral_ = integral;
+      }
+      output += this->integral_;
+    }
+
+    return std::clamp(output, p.outputMin, p.outputMax);
+  }
+
+  const Parameters& getParameters() const { return this->parameters_; }
+
+  /**
+   * @brief Integral term of the output, 0 without integral action.
+   *
+   * @return double
+   */
+  double getIntegral() const noexcept {
+    return kIntegral ? this->integral_ : 0.0;
+  }
+
+ private:
+  Parameters parameters_;
+  double dt_, inverseDt_;  // in seconds
+  double derivativeAlpha_;
+
+  double integral_;
+  double derivative_;  // filtered rate of the measurement
+  double previousMeasurement_;
+  bool hasPreviousMeasurement_;
+};
+
+typedef BasicPIDController<false, false> PController;
+typedef BasicPIDController<true, false> PIController;
+typedef BasicPIDController<true, true> PIDController;
+
+}  // namespace controller
+}  // namespace motor_controllers
@@ -8,16 +8,53 @@
  * @copyright Copyright (c) 2021
  *
  */
+#pragma once
+
 #include <motor_controllers/communication/i_binary_signal_channel.h>
+#include <motor_controllers/encoder/i_velocity_estimator.h>
+#include <motor_controllers/utils/semaphore.h>
+#include <motor_controllers/utils/seqlock.h>
+#include <stdint.h>
 
-#include <mutex>
-#include <thread>
+#include <atomic>  // std::atomic
+#include <chrono>  // std::chrono
+#include <thread>  // std::thread
 
 namespace motor_controllers {
 namespace encoder {
 
 enum class Direction { STOP = 0, FORWARD = 1, BACKWARD = 2, INVALID = 3 };
 
+/**
+ * @brief How the estimation thread waits for the next edge.
+ *
+ *  - BUSY_POLL spins on the channels: lowest latency, one full core per
+ *    encoder.
+ *  - BLOCKING sleeps until an edge or the end of the sampling window: almost
+ *    no CPU, the wake-up latency does not affect the speed since edges are
+ *    timestamped by the backend.
+ *  - ADAPTIVE busy polls only while the edge rate is above a threshold and
+ *    blocks otherwise.
+ */
+enum class DecodingMode { BUSY_POLL, BLOCKING, ADAPTIVE };
+
+/**
+ * @brief Snapshot of the values estimated by an Encoder.
+ *
+ * All the fields are consistent with each other. The speed is updated at the
+ * end of every sampling window, the other fields at every edge.
+ *
+ */
+struct EncoderState {
+  float speed = 0.0;
+  Direction direction = Direction::STOP;  // of the last edge
+  ulong count = 0;                        // edges, whatever their direction
+  int64_t position = 0;                   // in edges, signed
+  // Decoding errors, both mean that edges were missed.
+  uint64_t invalidTransitions = 0;  // both channels changed at once
+  uint64_t skippedEdges = 0;        // a channel reported the same level twice
+};
+
 /**
  * @brief Encoder class
  *
@@ -69,7 +106,7 @@ class Encoder {
   /**
    * @brief Get the currently estimated velocity of the shaft.
    *
-   * @return float in ticks per second
+   * @return float in rotations per second
    */
   float getSpeed() const;
 
@@ -87,11 +124,63 @@ class Encoder {
    */
   ulong getCount() const;
 
+  /**
+   * @brief Get the position of the shaft since started.
+   *
+   * Counts up when going FORWARD and down when going BACKWARD. Simple
+   * encoders always count up.
+   *
+   * @return int64_t in edges
+   */
+  int64_t getPosition() const;
+
+  /**
+   * @brief Number of edges counted per revolution of the shaft: 4 per step of
+   * the resolution for quadrature encoders, 2 for simple ones.
+   *
+   * @return double
+   */
+  double getEdgesPerRevolution() const;
+
+  /**
+   * @brief Get a consistent snapshot of speed, direction and count.
+   *
+   * Does not lock: prefer it over calling the individual getters back to back.
+   *
+   * @return EncoderState
+   */
+  EncoderState getState() const;
+
  public:
+  /**
+   * @brief Select how the decoding thread waits for edges.
+   *
+   * Must be called before start(). Defaults to ADAPTIVE.
+   *
+   * @param mode
+   * @param adaptiveEdgeRate in edges per second, the rate above which the
+   * ADAPTIVE mode busy polls. It goes back to blocking below half of it.
+   */
+  void setDecodingMode(DecodingMode mode, float adaptiveEdgeRate = 2000.0);
+
+  /**
+   * @brief Select how the speed is estimated from the edges.
+   *
+   * Must be called before start(). Defaults to a FixedWindowEstimator.
+   *
+   * @param estimator
+   */
+  void setVelocityEstimator(IVelocityEstimator::Ref estimator);
+
   /**
    * @brief Start a thread to estimate the velocity of the shaft at the
    * specified sampling frequency.
    *
+   * To decode several encoders on a shared thread, add them to an
+   * EncoderService instead. The encoders of a service are started and
+   * stopped by it: their start() and stop() do nothing, so that they can be
+   * given to a DCMotor, which starts its encoder.
+   *
    * @param samplingFrequency
    */
   void start(float samplingFrequency);
@@ -99,47 +188,122 @@ class Encoder {
   void stop();
 
  private:
+  // Decoding steps, driven either by the Encoder's own thread or by an
+  // EncoderService. Only the decoding thread may call them between
+  // beginDecoding and endDecoding.
+  friend class EncoderService;
+
   /**
-   * @brief Estimate velocity and direction of a quadrature encoder.
+   * @brief Loop of the Encoder's own thread.
    *
-   * This version is using much CPU but has a better accuracy a lower
-   * regimes.
+   */
+  void decode();
+
+  /**
+   * @brief Subscribe to the channels and reset the estimation.
    *
-   * TODO way to swith between them.
+   * Throws if the encoder is already running.
    *
    * @param samplingPeriod
+   * @param notifier posted by the channels on every edge
    */
-  void estimateVelocityQuadratureEncoder(
-      std::chrono::microseconds samplingPeriod);
+  void beginDecoding(std::chrono::microseconds samplingPeriod,
+                     utils::Semaphore* notifier);
 
   /**
-   * @brief Async estimate velocity and direction of a quadrature encoder.
+   * @brief Process the oldest pending edge, if any.
    *
-   * In this version, the program will halt waiting for an event either channel
-   * this means that the program requires less CPU, however the speed estimation
-   * is a bit twisted.
-   * because we wait for the events, we can also have half r and update the cpt
-   * every 2 events.
+   * @return true if an edge was processed
+   */
+  bool decodeNextEdge();
+
+  /**
+   * @brief Estimate the speed and direction if the sampling window is over.
    *
-   * @param samplingPeriod
+   * @param now
+   * @return true if the window was closed
+   */
+  bool closeWindowIfDue(std::chrono::steady_clock::time_point now);
+
+  /**
+   * @brief End of the current sampling window.
+   *
+   * @return std::chrono::steady_clock::time_point
+   */
+  std::chrono::steady_clock::time_point getWindowDeadline() const;
+
+  /**
+   * @brief Whether the decoding mode asks to spin rather than block.
+   *
+   */
+  bool isBusyPolling() const;
+
+  /**
+   * @brief Cancel the subscriptions and reset the state.
+   *
+   */
+  void endDecoding();
+
+  /**
+   * @brief Wait for the next edge, or return immediately when busy polling.
+   *
+   * @param eventsAvailable notifier given to beginDecoding
+   * @param busyPolling if true return immediately
+   * @param deadline end of the current sampling window
+   */
+  static void waitForEdges(utils::Semaphore& eventsAvailable, bool busyPolling,
+                           std::chrono::steady_clock::time_point deadline);
+
+  /**
+   * @brief Decide the waiting strategy for the next window.
+   *
+   * @param busyPolling the current strategy
+   * @param edgeRate edges per second measured on the last window
+   * @return true to busy poll
    */
-  void asyncEstimateVelocityQuadratureEncoder(
-      std::chrono::microseconds samplingPeriod);
+  bool shouldBusyPoll(bool busyPolling, float edgeRate) const;
 
-  void estimateVelocityEncoder(std::chrono::microseconds samplingPeriod);
+  EncoderState initialState() const;
+
+  static uint8_t readLevel(
+      const communication::IBinarySignalChannel::Ref& channel);
 
  private:
-  mutable std::mutex mtx_;
-  bool running_;
+  /**
+   * @brief Estimation state, owned by the decoding thread.
+   *
+   */
+  struct Decoder {
+    communication::EdgeEventStream::Ref streamA, streamB;
+    communication::EdgeEvent eventA, eventB;
+    bool hasA = false, hasB = false;  // an event is pending on the channel
+    uint8_t levels = 0;  // 2*A+B
+
+    std::chrono::microseconds samplingPeriod;
+    std::chrono::steady_clock::time_point windowOpen;
+    uint cpt = 0;  // edges in the current window
+    bool busyPolling = false;
+
+    EncoderState state;
+  };
+
+ private:
+  std::atomic<bool> running_;
   std::thread thread_;
+  bool isServiced_;  // added to an EncoderService
+
+  DecodingMode mode_;
+  float adaptiveEdgeRate_;
+  utils::Semaphore eventsAvailable_;  // posted by the streams on every edge
+  Decoder decoder_;
+  IVelocityEstimator::Ref estimator_;  // used by the decoding thread only
 
   communication::IBinarySignalChannel::Ref channelA_, channelB_;
 
   const uint resolution_;
 
-  ulong count_;
-  float speed_;
-  Direction direction_;
+  // Written only by the estimation thread, read by anyone.
+  utils::SeqLock<EncoderState> state_;
 };
 
 }  // namespace encoder
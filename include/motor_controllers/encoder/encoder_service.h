@@ -0,0 +1,96 @@
+/**
+ * @file encoder_service.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-05-27
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/encoder/encoder.h>
+#include <motor_controllers/utils/semaphore.h>
+
+#include <atomic>  // std::atomic
+#include <memory>  // std::unique_ptr
+#include <thread>  // std::thread
+#include <vector>  // std::vector
+
+namespace motor_controllers {
+namespace encoder {
+
+/**
+ * @brief Decode several encoders on a small, fixed number of threads.
+ *
+ * Each Encoder started on its own spends one thread waiting for its edges.
+ * The service shares its threads instead: the encoders are spread over them
+ * and every thread sleeps on a single notifier posted by all the channels of
+ * its encoders. The readers use the encoders as usual.
+ *
+ * The encoders are not owned and must outlive the service, or at least its
+ * stop(). Once added, their own start() and stop() do nothing: an encoder of
+ * the service can be given to a DCMotor, which only reads it. Its speed is
+ * estimated while the service runs.
+ *
+ */
+class EncoderService {
+ public:
+  typedef std::unique_ptr<EncoderService> Ref;
+
+ public:
+  /**
+   * @brief Construct a new Encoder Service
+   *
+   * @param numThreads number of decoding threads, the encoders are spread
+   * evenly over them.
+   */
+  EncoderService(unsigned int numThreads = 1);
+
+  ~EncoderService();
+
+  EncoderService(const EncoderService&) = delete;
+
+  EncoderService& operator=(const EncoderService&) = delete;
+
+ public:
+  /**
+   * @brief Add an encoder to decode. Only when stopped.
+   *
+   * @param encoder
+   */
+  void add(Encoder& encoder);
+
+  /**
+   * @brief Start decoding all the encoders at the given sampling frequency.
+   *
+   * @param samplingFrequency
+   */
+  void start(float samplingFrequency);
+
+  void stop();
+
+  /**
+   * @brief Number of encoders decoded.
+   *
+   */
+  size_t size() const;
+
+ private:
+  struct Worker {
+    std::vector<Encoder*> encoders;
+    utils::Semaphore eventsAvailable;  // posted by all the encoders' channels
+    std::thread thread;
+  };
+
+  void decode(Worker& worker);
+
+ private:
+  std::atomic<bool> running_;
+  std::vector<Encoder*> encoders_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}  // namespace encoder
+}  // namespace motor_controllers
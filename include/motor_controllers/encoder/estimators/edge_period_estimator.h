@@ -0,0 +1,66 @@
+/**
+ * @file edge_period_estimator.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-05-28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/encoder/i_velocity_estimator.h>
+#include <stdint.h>
+
+#include <array>  // std::array
+
+namespace motor_controllers {
+namespace encoder {
+
+/**
+ * @brief Measure the time between the last edges (1/T).
+ *
+ * Accurate at low speed where a window holds few edges, noisier at high speed
+ * where the period gets close to the timestamp resolution. Averaging over the
+ * 4 edges of a quadrature cycle removes the error due to channels that are
+ * not exactly in quadrature.
+ *
+ */
+class EdgePeriodEstimator : public IVelocityEstimator {
+ public:
+  static constexpr unsigned int kMaxAveragedEdges = 16;
+
+ public:
+  /**
+   * @brief Construct a new Edge Period Estimator
+   *
+   * @param averagedEdges number of periods averaged, at most
+   * kMaxAveragedEdges
+   */
+  EdgePeriodEstimator(unsigned int averagedEdges = 4);
+
+ public:
+  void reset(std::chrono::steady_clock::time_point now,
+             float edgesPerRevolution) override;
+
+  void onEdge(std::chrono::steady_clock::time_point timestamp) override;
+
+  float estimate(std::chrono::steady_clock::time_point now) override;
+
+ private:
+  const unsigned int averagedEdges_;
+  float edgesPerRevolution_;
+
+  // Last periods in nanoseconds, with their sum kept up to date. Integers such
+  // that the running sum does not drift.
+  std::array<int64_t, kMaxAveragedEdges> periods_;
+  unsigned int next_, filled_;
+  int64_t sum_;
+
+  bool hasEdge_;
+  std::chrono::steady_clock::time_point lastEdge_;
+};
+
+}  // namespace encoder
+}  // namespace motor_controllers
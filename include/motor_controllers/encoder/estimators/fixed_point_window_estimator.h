@@ -0,0 +1,51 @@
+/**
+ * @file fixed_point_window_estimator.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-06-15
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/encoder/i_velocity_estimator.h>
+#include <motor_controllers/utils/fixed_point.h>
+
+#include <cstdint>  // int64_t
+
+namespace motor_controllers {
+namespace encoder {
+
+/**
+ * @brief FixedWindowEstimator computed on integers, for the cores without a
+ * fast FPU.
+ *
+ * The timestamps stay in nanoseconds and the speed is a Q16 number of
+ * rotations per second: a window costs one 64 bits division, the constant
+ * turning edges per nanosecond into rotations per second being computed by
+ * reset(). estimate() converts the result once for IVelocityEstimator.
+ *
+ */
+class FixedPointWindowEstimator : public IVelocityEstimator {
+ public:
+  FixedPointWindowEstimator();
+
+ public:
+  void reset(std::chrono::steady_clock::time_point now,
+             float edgesPerRevolution) override;
+
+  void onEdge(std::chrono::steady_clock::time_point timestamp) override;
+
+  float estimate(std::chrono::steady_clock::time_point now) override;
+
+ private:
+  int64_t scale_;     // Q16 rotations per second for one edge per nanosecond
+  unsigned int cpt_;  // edges in the current window
+  int64_t windowStartEdge_, lastEdge_;  // in nanoseconds
+  int64_t speed_;                       // Q16
+};
+
+}  // namespace encoder
+}  // namespace motor_controllers
@@ -0,0 +1,46 @@
+/**
+ * @file fixed_window_estimator.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-05-28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/encoder/i_velocity_estimator.h>
+
+namespace motor_controllers {
+namespace encoder {
+
+/**
+ * @brief Count the edges of the sampling window.
+ *
+ * The speed is the number of edges over the time between the last edge of
+ * the previous window and the last edge of this one. Cheap and exact at high
+ * speed but quantized at low speed, where a window holds a few edges only.
+ *
+ */
+class FixedWindowEstimator : public IVelocityEstimator {
+ public:
+  FixedWindowEstimator();
+
+ public:
+  void reset(std::chrono::steady_clock::time_point now,
+             float edgesPerRevolution) override;
+
+  void onEdge(std::chrono::steady_clock::time_point timestamp) override;
+
+  float estimate(std::chrono::steady_clock::time_point now) override;
+
+ private:
+  float edgesPerRevolution_;
+  unsigned int cpt_;  // edges in the current window
+  std::chrono::steady_clock::time_point windowStartEdge_, lastEdge_;
+  float speed_;
+};
+
+}  // namespace encoder
+}  // namespace motor_controllers
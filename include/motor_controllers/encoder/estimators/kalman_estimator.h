@@ -0,0 +1,64 @@
+/**
+ * @file kalman_estimator.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-05-28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/encoder/i_velocity_estimator.h>
+
+namespace motor_controllers {
+namespace encoder {
+
+/**
+ * @brief Constant velocity Kalman filter on the position.
+ *
+ * The state is the position and the speed, the acceleration is modeled as
+ * white noise. Every edge is a measurement of the position, taken at its
+ * timestamp. Like the PLL, the position is known to be before the next edge
+ * between edges. The 2x2 covariance is expanded by hand.
+ *
+ */
+class KalmanEstimator : public IVelocityEstimator {
+ public:
+  /**
+   * @brief Construct a new Kalman Estimator
+   *
+   * @param accelerationNoise spectral density of the acceleration, in
+   * edges^2/s^3. Higher follows faster changes of speed but is noisier.
+   * @param measurementNoise variance of the position of an edge, in edges^2
+   */
+  KalmanEstimator(float accelerationNoise = 5e5,
+                  float measurementNoise = 0.01);
+
+ public:
+  void reset(std::chrono::steady_clock::time_point now,
+             float edgesPerRevolution) override;
+
+  void onEdge(std::chrono::steady_clock::time_point timestamp) override;
+
+  float estimate(std::chrono::steady_clock::time_point now) override;
+
+ private:
+  void predict(std::chrono::steady_clock::time_point t);
+
+  void update(float measuredPosition);
+
+ private:
+  const float q_, r_;
+  float edgesPerRevolution_;
+
+  // Position relative to the last edge in edges, and speed in edges per second
+  float position_, velocity_;
+  // Covariance, symmetric
+  float p00_, p01_, p11_;
+  std::chrono::steady_clock::time_point lastUpdate_;
+};
+
+}  // namespace encoder
+}  // namespace motor_controllers
@@ -0,0 +1,69 @@
+/**
+ * @file pll_estimator.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-05-28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/encoder/i_velocity_estimator.h>
+
+namespace motor_controllers {
+namespace encoder {
+
+/**
+ * @brief Track the position with a second order phase-locked loop.
+ *
+ * The estimated position is integrated from the estimated speed and corrected
+ * by a PI loop on the position error at every edge. Between edges, the
+ * position is known to be before the next edge which bounds the estimate when
+ * the shaft slows down. Smooth at any speed, with a lag set by the bandwidth.
+ *
+ */
+class PLLEstimator : public IVelocityEstimator {
+ public:
+  /**
+   * @brief Construct a new PLL Estimator
+   *
+   * @param bandwidth natural frequency of the loop in Hz
+   * @param damping damping ratio of the loop
+   */
+  PLLEstimator(float bandwidth = 20.0, float damping = 0.7);
+
+ public:
+  void reset(std::chrono::steady_clock::time_point now,
+             float edgesPerRevolution) override;
+
+  void onEdge(std::chrono::steady_clock::time_point timestamp) override;
+
+  float estimate(std::chrono::steady_clock::time_point now) override;
+
+ private:
+  /**
+   * @brief Integrate the position up to t.
+   *
+   * @param t
+   * @return float time elapsed since the last update in seconds
+   */
+  float advance(std::chrono::steady_clock::time_point t);
+
+  void correct(float error, float dt);
+
+ private:
+  const float kp_, ki_;
+  float edgesPerRevolution_;
+
+  // Estimated position relative to the last edge, in edges. Relative such that
+  // it keeps its precision however far the shaft goes.
+  float phase_;
+  float velocity_;  // in edges per second
+  std::chrono::steady_clock::time_point lastUpdate_;
+  float lastStep_;  // seconds between the last two updates
+};
+
+}  // namespace encoder
+}  // namespace motor_controllers
@@ -0,0 +1,61 @@
+/**
+ * @file i_velocity_estimator.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-05-28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <chrono>  // std::chrono
+#include <memory>  // std::unique_ptr
+
+namespace motor_controllers {
+namespace encoder {
+
+/**
+ * @brief Strategy used by the Encoder to turn edges into a speed.
+ *
+ * The decoding thread calls onEdge() for every edge, in order, and estimate()
+ * at the end of every sampling window. Both are called from the same thread
+ * and must do O(1) work without allocating: onEdge() runs at the edge rate.
+ *
+ */
+class IVelocityEstimator {
+ public:
+  typedef std::unique_ptr<IVelocityEstimator> Ref;
+
+ public:
+  virtual ~IVelocityEstimator() = default;
+
+ public:
+  /**
+   * @brief Forget the previous estimation. Called when decoding starts.
+   *
+   * @param now
+   * @param edgesPerRevolution number of edges decoded per shaft revolution
+   */
+  virtual void reset(std::chrono::steady_clock::time_point now,
+                     float edgesPerRevolution) = 0;
+
+  /**
+   * @brief Account for one edge.
+   *
+   * @param timestamp time of the edge given by the backend
+   */
+  virtual void onEdge(std::chrono::steady_clock::time_point timestamp) = 0;
+
+  /**
+   * @brief Current speed estimate.
+   *
+   * @param now end of the sampling window
+   * @return float in rotations per second
+   */
+  virtual float estimate(std::chrono::steady_clock::time_point now) = 0;
+};
+
+}  // namespace encoder
+}  // namespace motor_controllers
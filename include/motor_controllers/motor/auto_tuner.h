@@ -0,0 +1,127 @@
+/**
+ * @file auto_tuner.h
+ * @author Pierre Venet
+ * @brief Identification of the constants of a DC motor and of its gains.
+ * @version 0.1
+ * @date 2021-06-11
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/controller/pid_controller.h>
+#include <motor_controllers/motor/dc_motor.h>
+
+#include <chrono>   // std::chrono
+#include <cstdint>  // int64_t
+#include <vector>   // std::vector
+
+namespace motor_controllers {
+namespace motor {
+
+/**
+ * @brief Drives the PWM channel of a stopped DCMotor in open loop to identify
+ * its dead zone, gain and time constant, then proposes its maxSpeed,
+ * minDutyCycle and PI gains.
+ *
+ * Two experiments run forward, in the calling thread:
+ * - a staircase of duty cycles until the shaft moves: the dead zone
+ * - a step of duty cycle, whose response is recorded every samplePeriod in a
+ *   buffer allocated beforehand. A first order with dead time is fitted on it
+ *   by the 28% and 63% rise times.
+ *
+ * The gains follow the SIMC rules for a PI controller: the motor is seen by
+ * the controller as a unit gain, once minDutyCycle and maxSpeed are those
+ * proposed.
+ *
+ */
+class AutoTuner {
+ public:
+  struct Configuration {
+    // Period of the recording of the step response
+    std::chrono::microseconds samplePeriod = std::chrono::microseconds(1000);
+
+    // Dead zone staircase: the duty cycle goes up by deadZoneStep every
+    // deadZoneStepDuration until the encoder counts movingEdges in a step.
+    double deadZoneStep = 0.02;
+    std::chrono::milliseconds deadZoneStepDuration =
+        std::chrono::milliseconds(100);
+    int64_t movingEdges = 4;
+
+    // Step response, from rest
+    double stepDutyCycle = 1.0;
+    std::chrono::milliseconds stepDuration = std::chrono::milliseconds(1000);
+    std::chrono::milliseconds settleDuration = std::chrono::milliseconds(1000);
+
+    // Wanted time constant of the closed loop, in seconds. 0 for the largest
+    // of the dead time and half of the time constant.
+    double closedLoopTimeConstant = 0.0;
+  };
+
+  struct Sample {
+    double time;  // since the step, in seconds
+    double speed;
+    int64_t position;  // in edges
+  };
+
+  struct Result {
+    // Identified
+    double deadZone;      // duty cycle under which the motor does not move
+    double gain;          // speed per duty cycle above the dead zone
+    double timeConstant;  // in seconds
+    double deadTime;      // in seconds, including the encoder estimation
+
+    // Proposed for the DCMotor configuration
+    double minDutyCycle;
+    double maxSpeed;
+    controller::ControllerParameters controller;
+  };
+
+ public:
+  AutoTuner();
+
+  explicit AutoTuner(const Configuration& configuration);
+
+ public:
+  /**
+   * @brief Run the experiments on a motor that is not started, and identify
+   * it. Takes a few seconds, see the Configuration.
+   *
+   * @param motor
+   * @return Result
+   */
+  Result tune(DCMotor& motor);
+
+  /**
+   * @brief Step response recorded by the last tune().
+   *
+   * @return const std::vector<Sample>&
+   */
+  const std::vector<Sample>& getStepResponse() const;
+
+  /**
+   * @brief Fit a step response, e.g. recorded by another mean.
+   *
+   * @param stepResponse starting at the step, from rest
+   * @param stepDutyCycle
+   * @param deadZone
+   * @param closedLoopTimeConstant in seconds, 0 for the default
+   * @return Result
+   */
+  static Result identify(const std::vector<Sample>& stepResponse,
+                         double stepDutyCycle, double deadZone,
+                         double closedLoopTimeConstant = 0.0);
+
+ private:
+  double measureDeadZone(DCMotor& motor);
+
+  void recordStepResponse(DCMotor& motor);
+
+ private:
+  const Configuration configuration_;
+  std::vector<Sample> stepResponse_;
+};
+
+}  // namespace motor
+}  // namespace motor_controllers
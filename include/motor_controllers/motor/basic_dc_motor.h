@@ -0,0 +1,675 @@
+/**
+ * @file basic_dc_motor.h
+ * @author Pierre Venet
+ * @brief DC motor whose controller and channels are template arguments.
+ * @version 0.1
+ * @date 2021-06-07
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/i_binary_signal_channel.h>
+#include <motor_controllers/communication/i_pwm_signal_channel.h>
+#include <motor_controllers/controller/fixed_pid_controller.h>
+#include <motor_controllers/controller/i_controller.h>
+#include <motor_controllers/controller/pid_controller.h>
+#include <motor_controllers/encoder/encoder.h>
+#include <motor_controllers/motor/setpoint_generator.h>
+#include <motor_controllers/motor/telemetry_recorder.h>
+#include <motor_controllers/utils/latency_histogram.h>
+#include <motor_controllers/utils/real_time.h>
+
+#include <atomic>      // std::atomic
+#include <chrono>      // std::chrono
+#include <algorithm>   // std::min, std::max
+#include <cmath>       // std::abs, std::lround
+#include <cstdint>     // int32_t, int64_t
+#include <functional>  // std::bind
+#include <memory>      // std::unique_ptr
+#include <stdexcept>   // std::runtime_error
+#include <thread>      // std::thread
+#include <utility>     // std::move
+#include <vector>      // std::vector
+
+namespace motor_controllers {
+namespace motor {
+class AutoTuner;
+template <class Controller, class PWMChannelRef, class BinaryChannelRef>
+class BasicControllerExecutor;
+
+/**
+ * @brief Timings of a control loop.
+ *
+ */
+struct ControlLoopStatistics {
+  // How late the loop woke up after the start of its period
+  utils::LatencyHistogram::Snapshot wakeUpLateness;
+  // Time between two iterations
+  utils::LatencyHistogram::Snapshot period;
+  // Reading the encoder and computing the duty cycle
+  utils::LatencyHistogram::Snapshot computeTime;
+  // Writing the direction and the duty cycle to the channels
+  utils::LatencyHistogram::Snapshot writeLatency;
+  // By how much the missed deadlines were missed
+  utils::LatencyHistogram::Snapshot deadlineMisses;
+};
+
+/**
+ * @brief DC motor controlled in speed, by a PWM channel and direction
+ * channels, from the speed measured by an encoder.
+ *
+ * The controller is a policy with reset(dt) and update(target, measurement),
+ * e.g. controller::PIDController: its update is inlined in the control loop.
+ * The channels are held by the given Ref types, such as
+ * communication::SimulatedPWMChannelRef, so that the writes to channels whose
+ * methods are final are not virtual calls either.
+ *
+ * The target speed is sampled at each period from a SetpointGenerator: a
+ * constant speed, a ramp, a MotionProfile or timestamped setpoints, submitted
+ * without ever blocking the control thread.
+ *
+ * In position mode, after moveTo() or hold(), an outer PID loop on the
+ * position counted by the encoder is cascaded onto the speed controller: it
+ * runs in the same thread, once every positionLoopRatio periods, and its
+ * output is added to the speed of the move profile. The position needs a
+ * quadrature encoder, a simple one always counts up.
+ *
+ * With a fixed-point controller, such as controller::FixedPIController, the
+ * speed loop runs on integers: the speeds are converted once per period and
+ * the output is mapped straight to the counts of the PWM channel, see
+ * IPWMSignalChannel::setRawDutyCycle.
+ *
+ * DCMotor is the runtime flavour, with the controller and the channels behind
+ * their interfaces.
+ *
+ * @tparam Controller
+ * @tparam PWMChannelRef
+ * @tparam BinaryChannelRef
+ */
+template <class Controller,
+          class PWMChannelRef = communication::IPWMSignalChannel::Ref,
+          class BinaryChannelRef = communication::IBinarySignalChannel::Ref>
+class BasicDCMotor {
+ public:
+  typedef std::unique_ptr<BasicDCMotor> Ref;
+  typedef ControlLoopStatistics Statistics;
+
+ public:
+  struct Configuration {
+    // PWM channel and its frequency
+    PWMChannelRef pwmChannel;
+    double pwmFrequency = 20000;
+
+    // Direction control channels
+    std::vector<BinaryChannelRef> directionControl;
+    std::vector<communication::BinarySignal> forwardConfiguration;
+    std::vector<communication::BinarySignal> backwardConfiguration;
+    std::vector<communication::BinarySignal> stopConfiguration;
+
+    // Encoder and its sampling frequency
+    encoder::Encoder::Ref encoder;
+    double encoderSamplingFrequency = 500;
+
+    // Motor constants
+    double minDutyCycle;
+    double maxSpeed;
+
+    // Controller period
+    std::chrono::microseconds dt = std::chrono::microseconds(10);
+
+    // Position loop, run every positionLoopRatio periods of the speed loop. Its
+    // gains are in speed per revolution of error, its output is limited to the
+    // maximal speed.
+    controller::ControllerParameters positionController;
+    unsigned int positionLoopRatio = 10;
+
+    // Scheduling of the control thread
+    utils::RealTimeConfiguration realTime;
+
+    // Optional record of every control period
+    TelemetryRecorder::Ref telemetry;
+  };
+
+ public:
+  BasicDCMotor(Configuration& conf, Controller controller)
+      : pwmChannel_(std::move(conf.pwmChannel)),
+        pwmFrequency_(conf.pwmFrequency),
+        directionControl_(std::move(conf.directionControl)),
+        forwardConfiguration_(conf.forwardConfiguration),
+        backwardConfiguration_(conf.backwardConfiguration),
+        stopConfiguration_(conf.stopConfiguration),
+        encoder_(std::move(conf.encoder)),
+        telemetry_(std::move(conf.telemetry)),
+        encoderSamplingFrequency_(conf.encoderSamplingFrequency),
+        isRunning_(false),
+        minDutyCycle_(conf.minDutyCycle),
+        coefSpeedToDutyCycle_((1.0 - conf.minDutyCycle) / conf.maxSpeed),
+        maxSpeed_(conf.maxSpeed),
+        fullScale_(static_cast<int32_t>(this->pwmChannel_->getMaxValue())),
+        minCounts_(std::lround(conf.minDutyCycle * fullScale_)),
+        countsPerSpeed_(std::llround(coefSpeedToDutyCycle_ * fullScale_ *
+                                     utils::Q16::kOne)),
+        controller_(std::move(controller)),
+        positionController_(positionParameters(conf)),
+        positionLoopRatio_(std::max(conf.positionLoopRatio, 1u)),
+        positionDt_(conf.dt * positionLoopRatio_),
+        positionTick_(0),
+        positionCorrection_(0.0),
+        positionActive_(false),
+        dt_(conf.dt),
+        realTime_(conf.realTime),
+        timer_(conf.dt) {}
+
+  ~BasicDCMotor() { this->stop(); }
+
+  BasicDCMotor(const BasicDCMotor&) = delete;
+
+  BasicDCMotor& operator=(const BasicDCMotor&) = delete;
+
+ public:
+  void start() {
+    if (this->realTime_.lockMemory) {
+      utils::lockMemory();
+    }
+
+    this->beginControl();
+    this->controlThread_ =
+        std::thread(std::bind(&BasicDCMotor::controlLoop, this));
+
+    try {
+      utils::setThreadScheduling(this->controlThread_, this->realTime_);
+    } catch (...) {
+      this->stop();
+      throw;
+    }
+  }
+
+  void stop() {
+    if (!this->controlThread_.joinable()) return;
+
+    this->isRunning_ = false;
+    this->controlThread_.join();
+    this->endControl();
+  }
+
+  /**
+   * @brief Step the target to a constant speed.
+   *
+   * @param speed
+   */
+  void setSpeed(double speed) { this->setpoints_.setSpeed(speed); }
+
+  /**
+   * @brief Ramp the target from its current value to a constant speed.
+   *
+   * @param speed
+   * @param maxAcceleration positive, per second
+   * @param shape
+   */
+  void rampTo(double speed, double maxAcceleration,
+              ProfileShape shape = ProfileShape::TRAPEZOIDAL) {
+    this->setpoints_.rampTo(speed, maxAcceleration, shape);
+  }
+
+  /**
+   * @brief Follow the speed of a profile, then hold its final speed.
+   *
+   * @param profile
+   * @param start
+   */
+  void followProfile(const MotionProfile& profile,
+                     std::chrono::steady_clock::time_point start =
+                         std::chrono::steady_clock::now()) {
+    this->setpoints_.followProfile(profile, start);
+  }
+
+  /**
+   * @brief Queue timestamped target speeds, see
+   * SetpointGenerator::pushSetpoints.
+   *
+   * @param setpoints
+   * @return size_t number of setpoints queued
+   */
+  size_t pushSetpoints(const std::vector<Setpoint>& setpoints) {
+    return this->setpoints_.pushSetpoints(setpoints);
+  }
+
+  /**
+   * @brief Move to a position and hold it, in position mode. The move starts
+   * from the current position target, or the current position, and from rest.
+   *
+   * @param position in edges of the encoder, see getPosition()
+   * @param maxSpeed positive
+   * @param maxAcceleration positive, per second
+   * @param shape
+   */
+  void moveTo(int64_t position, double maxSpeed, double maxAcceleration,
+              ProfileShape shape = ProfileShape::TRAPEZOIDAL) {
+    this->setpoints_.moveTo(position / this->encoder_->getEdgesPerRevolution(),
+                            maxSpeed, maxAcceleration, shape);
+  }
+
+  /**
+   * @brief Hold the current position target, or the current position, in
+   * position mode.
+   *
+   */
+  void hold() { this->setpoints_.hold(); }
+
+  /**
+   * @brief Target speed of the last control period.
+   *
+   * @return double
+   */
+  double getTargetSpeed() const { return this->setpoints_.getTarget(); }
+
+  /**
+   * @brief Position counted by the encoder since start.
+   *
+   * @return int64_t in edges
+   */
+  int64_t getPosition() const { return this->encoder_->getPosition(); }
+
+  /**
+   * @brief Target position of the last control period, in edges. Follows the
+   * position when controlling the speed.
+   *
+   * @return double
+   */
+  double getTargetPosition() const {
+    return this->setpoints_.getTargetPosition() *
+           this->encoder_->getEdgesPerRevolution();
+  }
+
+  double getSpeed() const {
+    // Single snapshot: speed and direction come from the same window.
+    return speedOf(this->encoder_->getState());
+  }
+
+  /**
+   * @brief Number of control periods that missed their deadline.
+   *
+   * @return uint64_t
+   */
+  uint64_t getOverrunCount() const { return this->timer_.getOverrunCount(); }
+
+  /**
+   * @brief Number of writes sent to the PWM and direction channels.
+   *
+   * @return uint64_t
+   */
+  uint64_t getWriteCount() const {
+    uint64_t count = this->pwmChannel_->getWriteCount();
+    for (const auto& channel : this->directionControl_) {
+      count += channel->getWriteCount();
+    }
+    return count;
+  }
+
+  /**
+   * @brief Number of writes to the PWM and direction channels skipped because
+   * the hardware already had the value.
+   *
+   * @return uint64_t
+   */
+  uint64_t getSkippedWriteCount() const {
+    uint64_t count = this->pwmChannel_->getSkippedWriteCount();
+    for (const auto& channel : this->directionControl_) {
+      count += channel->getSkippedWriteCount();
+    }
+    return count;
+  }
+
+  /**
+   * @brief Timings of the control loop since start, or the last reset. Can be
+   * called while running.
+   *
+   * @return Statistics
+   */
+  Statistics getStatistics() const {
+    Statistics statistics;
+    statistics.wakeUpLateness = this->wakeUpLateness_.snapshot();
+    statistics.period = this->period_.snapshot();
+    statistics.computeTime = this->computeTime_.snapshot();
+    statistics.writeLatency = this->writeLatency_.snapshot();
+    statistics.deadlineMisses = this->deadlineMisses_.snapshot();
+    return statistics;
+  }
+
+  /**
+   * @brief Clear the timings of the control loop.
+   *
+   */
+  void resetStatistics() {
+    this->wakeUpLateness_.reset();
+    this->period_.reset();
+    this->computeTime_.reset();
+    this->writeLatency_.reset();
+    this->deadlineMisses_.reset();
+  }
+
+ private:
+  friend class AutoTuner;
+  template <class, class, class>
+  friend class BasicControllerExecutor;
+
+  void controlLoop() {
+    if (this->realTime_.lockMemory) {
+      utils::prefaultStack();
+    }
+
+    this->resetControllers(this->dt_);
+
+    // Absolute deadlines: the wake up latency does not shift the next periods.
+    this->timer_.start();
+    auto previousIteration = std::chrono::steady_clock::now();
+
+    while (this->isRunning_) {
+      const auto iterationStart = std::chrono::steady_clock::now();
+      this->period_.record(iterationStart - previousIteration);
+      previousIteration = iterationStart;
+
+      double currentSpeed, targetSpeed;
+      this->sense(iterationStart, currentSpeed, targetSpeed);
+      const auto dutyCycle =
+          this->computeDutyCycle(iterationStart, targetSpeed, currentSpeed);
+
+      const auto writeStart = std::chrono::steady_clock::now();
+      this->computeTime_.record(writeStart - iterationStart);
+
+      this->actuate(dutyCycle);
+
+      this->writeLatency_.record(std::chrono::steady_clock::now() -
+                                 writeStart);
+
+      if (this->timer_.waitNextPeriod()) {
+        this->wakeUpLateness_.record(this->timer_.getLastLateness());
+      } else {
+        this->deadlineMisses_.record(this->timer_.getLastLateness());
+      }
+    }
+  }
+
+  /**
+   * @brief Start the encoder and the PWM, everything but the control thread.
+   * Throws if already running, or if the encoder or the PWM fails to start:
+   * the motor is then left stopped, and can be started again.
+   *
+   */
+  void beginControl() {
+    if (this->isRunning_.exchange(true)) {
+      throw std::runtime_error("DCMotor already running");
+    }
+    try {
+      this->encoder_->start(this->encoderSamplingFrequency_);
+    } catch (...) {
+      this->isRunning_ = false;
+      throw;
+    }
+    try {
+      this->pwmChannel_->setPWMFrequency(this->pwmFrequency_);
+      this->setForward();
+    } catch (...) {
+      this->endControl();
+      throw;
+    }
+  }
+
+  /**
+   * @brief Stop the encoder, once the control loop is no longer running.
+   *
+   */
+  void endControl() {
+    this->isRunning_ = false;
+    this->encoder_->stop();
+  }
+
+  /**
+   * @brief Reset the speed and position controllers before running them.
+   *
+   * @param dt period of the speed loop
+   */
+  void resetControllers(std::chrono::microseconds dt) {
+    this->controller_.reset(dt);
+    this->positionDt_ = dt * this->positionLoopRatio_;
+    this->positionActive_ = false;
+  }
+
+  /**
+   * @brief Measured and target speeds of a period, from one snapshot of the
+   * encoder. Runs the position loop when due.
+   *
+   * @param now
+   * @param currentSpeed
+   * @param targetSpeed
+   */
+  void sense(std::chrono::steady_clock::time_point now, double& currentSpeed,
+             double& targetSpeed) {
+    const encoder::EncoderState state = this->encoder_->getState();
+    currentSpeed = speedOf(state);
+
+    const double position =
+        state.position / this->encoder_->getEdgesPerRevolution();
+    const Reference reference = this->setpoints_.sample(now, position);
+    if (!reference.positionControl) {
+      this->positionActive_ = false;
+      targetSpeed = reference.speed;
+      return;
+    }
+
+    if (!this->positionActive_) {
+      // Entering the position mode: start the position loop from scratch.
+      this->positionController_.reset(this->positionDt_);
+      this->positionTick_ = 0;
+      this->positionActive_ = true;
+    }
+    if (this->positionTick_ == 0) {
+      this->positionCorrection_ =
+          this->positionController_.update(reference.position, position);
+    }
+    this->positionTick_ = (this->positionTick_ + 1) % this->positionLoopRatio_;
+
+    targetSpeed = std::min(
+        std::max(reference.speed + this->positionCorrection_, -this->maxSpeed_),
+        this->maxSpeed_);
+  }
+
+  /**
+   * @brief One step of the controller, in the control thread. Recorded in the
+   * telemetry, if any.
+   *
+   * @param now start of the period
+   * @param targetSpeed
+   * @param currentSpeed
+   * @return duty cycle, its sign giving the direction: a double, or int32_t
+   * counts of the PWM channel with a fixed-point controller
+   */
+  auto computeDutyCycle(std::chrono::steady_clock::time_point now,
+                        double targetSpeed, double currentSpeed) {
+    if constexpr (controller::IsFixedPoint<Controller>::value) {
+      typedef typename Controller::Value Value;
+      const Value speed = this->controller_.update(
+          Value::fromDouble(targetSpeed), Value::fromDouble(currentSpeed));
+      const int32_t counts = countsOf(speed, this->countsPerSpeed_,
+                                      this->minCounts_, this->fullScale_);
+
+      if (this->telemetry_) {
+        this->record(now, targetSpeed, currentSpeed,
+                     controller::integralOf(this->controller_),
+                     static_cast<double>(counts) / this->fullScale_);
+      }
+      return counts;
+    } else {
+      const double speed = this->controller_.update(targetSpeed, currentSpeed);
+      const double dutyCycle = dutyCycleOf(speed, this->coefSpeedToDutyCycle_,
+                                           this->minDutyCycle_);
+
+      if (this->telemetry_) {
+        this->record(now, targetSpeed, currentSpeed,
+                     controller::integralOf(this->controller_), dutyCycle);
+      }
+      return dutyCycle;
+    }
+  }
+
+  /**
+   * @brief Duty cycle of a controller output. The minimal duty cycle is on
+   * the side of the requested direction.
+   *
+   * @param speed
+   * @param coefSpeedToDutyCycle
+   * @param minDutyCycle
+   * @return double
+   */
+  static double dutyCycleOf(double speed, double coefSpeedToDutyCycle,
+                            double minDutyCycle) {
+    return (speed < 0) ? speed * coefSpeedToDutyCycle - minDutyCycle
+                       : speed * coefSpeedToDutyCycle + minDutyCycle;
+  }
+
+  /**
+   * @brief Same mapping as dutyCycleOf, in counts of the PWM channel.
+   *
+   * @param speed fixed-point output of the controller
+   * @param countsPerSpeed in Q16
+   * @param minCounts
+   * @param fullScale
+   * @return int32_t within [-fullScale, fullScale]
+   */
+  template <class Value>
+  static int32_t countsOf(Value speed, int64_t countsPerSpeed,
+                          int64_t minCounts, int32_t fullScale) {
+    const int64_t scaled =
+        static_cast<int64_t>(speed.raw()) * countsPerSpeed >>
+        (Value::kFractionBitCount + utils::Q16::kFractionBitCount);
+    return static_cast<int32_t>(std::min<int64_t>(
+        std::max<int64_t>(speed.raw() < 0 ? scaled - minCounts
+                                          : scaled + minCounts,
+                          -fullScale),
+        fullScale));
+  }
+
+  void record(std::chrono::steady_clock::time_point now, double targetSpeed,
+              double currentSpeed, double integral, double dutyCycle) {
+    this->telemetry_->record(TelemetryRecord{
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now.time_since_epoch())
+            .count(),
+        targetSpeed, currentSpeed, targetSpeed - currentSpeed, integral,
+        dutyCycle});
+  }
+
+  /**
+   * @brief Write the duty cycle computed by the controller, its sign giving
+   * the direction. The direction channels only change when the sign does.
+   *
+   * @param dutyCycle
+   */
+  void actuate(double dutyCycle) {
+    if (dutyCycle < 0) {
+      this->setBackward();
+    } else {
+      this->setForward();
+    }
+
+    this->pwmChannel_->setDutyCycle(std::abs(dutyCycle));
+  }
+
+  /**
+   * @brief Same as above, in counts of the PWM channel.
+   *
+   * @param counts
+   */
+  void actuate(int32_t counts) {
+    if (counts < 0) {
+      this->setBackward();
+    } else {
+      this->setForward();
+    }
+
+    this->pwmChannel_->setRawDutyCycle(static_cast<uint32_t>(std::abs(counts)));
+  }
+
+  static double speedOf(const encoder::EncoderState& state) {
+    switch (state.direction) {
+      case encoder::Direction::BACKWARD:
+        return -state.speed;
+      case encoder::Direction::INVALID:
+        // what to do!?
+      default:
+        return state.speed;
+    }
+  }
+
+  static controller::ControllerParameters positionParameters(
+      const Configuration& conf) {
+    controller::ControllerParameters parameters = conf.positionController;
+    parameters.outputMin = std::max(parameters.outputMin, -conf.maxSpeed);
+    parameters.outputMax = std::min(parameters.outputMax, conf.maxSpeed);
+    return parameters;
+  }
+
+  void setForward() {
+    for (size_t i = 0; i < this->directionControl_.size(); ++i) {
+      this->directionControl_[i]->set(this->forwardConfiguration_[i]);
+    }
+  }
+
+  void setBackward() {
+    for (size_t i = 0; i < this->directionControl_.size(); ++i) {
+      this->directionControl_[i]->set(this->backwardConfiguration_[i]);
+    }
+  }
+
+  void setStop() {
+    for (size_t i = 0; i < this->directionControl_.size(); ++i) {
+      this->directionControl_[i]->set(this->stopConfiguration_[i]);
+    }
+  }
+
+ private:
+  PWMChannelRef pwmChannel_;
+  const double pwmFrequency_;
+  std::vector<BinaryChannelRef> directionControl_;
+  std::vector<communication::BinarySignal> forwardConfiguration_;
+  std::vector<communication::BinarySignal> backwardConfiguration_;
+  std::vector<communication::BinarySignal> stopConfiguration_;
+
+  encoder::Encoder::Ref encoder_;
+  TelemetryRecorder::Ref telemetry_;
+  const double encoderSamplingFrequency_;
+
+  std::thread controlThread_;
+  std::atomic<bool> isRunning_;
+
+  const double minDutyCycle_, coefSpeedToDutyCycle_, maxSpeed_;
+
+  // Same constants in counts of the PWM channel, for the fixed-point path
+  const int32_t fullScale_;
+  const int64_t minCounts_;
+  const int64_t countsPerSpeed_;  // Q16 counts per rotation per second
+
+  SetpointGenerator setpoints_;
+  Controller controller_;
+
+  // Position loop, in revolutions
+  controller::PIDController positionController_;
+  const unsigned int positionLoopRatio_;
+  std::chrono::microseconds positionDt_;
+  unsigned int positionTick_;
+  double positionCorrection_;
+  bool positionActive_;
+
+  const std::chrono::microseconds dt_;
+
+  const utils::RealTimeConfiguration realTime_;
+  utils::PeriodicTimer timer_;
+
+  utils::LatencyHistogram wakeUpLateness_, period_, computeTime_,
+      writeLatency_, deadlineMisses_;
+};
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -0,0 +1,327 @@
+/**
+ * @file controller_executor.h
+ * @author Pierre Venet
+ * @brief
+ * @version 0.1
+ * @date 2021-06-05
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/controller/fixed_pid_controller.h>
+#include <motor_controllers/controller/i_controller.h>
+#include <motor_controllers/motor/basic_dc_motor.h>
+#include <motor_controllers/utils/latency_histogram.h>
+#include <motor_controllers/utils/real_time.h>
+
+#include <algorithm>    // std::find
+#include <atomic>       // std::atomic
+#include <chrono>       // std::chrono
+#include <cstdint>      // int32_t, int64_t
+#include <functional>   // std::bind
+#include <memory>       // std::unique_ptr
+#include <stdexcept>    // std::runtime_error
+#include <thread>       // std::thread
+#include <type_traits>  // std::conditional_t
+#include <utility>      // std::move
+#include <vector>       // std::vector
+
+namespace motor_controllers {
+namespace motor {
+
+/**
+ * @brief Run the controllers of several motors on a single periodic thread.
+ *
+ * Each motor started on its own runs one control thread, waking up at its own
+ * phase. The executor runs all of them in one tick instead: it reads the speed
+ * of every motor, computes all the duty cycles, then writes them all, so the
+ * motors are actuated together and the thread wakes up once per period.
+ *
+ * The controllers of the motors are moved into an array of the executor while
+ * it runs, with the speeds, the duty cycles and the constants mapping the
+ * outputs to duty cycles in arrays over the motors: a tick is a loop over
+ * contiguous states, the update of the Controller policy being inlined. With
+ * DCMotor, i.e. ControllerExecutor, the update goes through the IController
+ * of each motor.
+ *
+ * The motors are not owned and must outlive the executor, or at least its
+ * stop(), which gives the controllers back. They must not be started on their
+ * own; setSpeed and getSpeed are used as usual.
+ *
+ * @tparam Controller
+ * @tparam PWMChannelRef
+ * @tparam BinaryChannelRef
+ */
+template <class Controller,
+          class PWMChannelRef = communication::IPWMSignalChannel::Ref,
+          class BinaryChannelRef = communication::IBinarySignalChannel::Ref>
+class BasicControllerExecutor {
+ public:
+  typedef std::unique_ptr<BasicControllerExecutor> Ref;
+  typedef BasicDCMotor<Controller, PWMChannelRef, BinaryChannelRef> Motor;
+  typedef ControlLoopStatistics Statistics;
+
+ public:
+  /**
+   * @brief Construct a new Controller Executor
+   *
+   * @param dt period of the controllers, replaces the dt of the motors
+   * @param realTime scheduling of the executor thread
+   */
+  BasicControllerExecutor(std::chrono::microseconds dt,
+                          const utils::RealTimeConfiguration& realTime =
+                              utils::RealTimeConfiguration())
+      : dt_(dt), realTime_(realTime), running_(false), timer_(dt) {}
+
+  ~BasicControllerExecutor() { this->stop(); }
+
+  BasicControllerExecutor(const BasicControllerExecutor&) = delete;
+
+  BasicControllerExecutor& operator=(const BasicControllerExecutor&) = delete;
+
+ public:
+  /**
+   * @brief Add a motor to control. Only when stopped.
+   *
+   * @param motor
+   */
+  void add(Motor& motor) {
+    if (this->running_) {
+      throw std::runtime_error("Cannot add a motor while running");
+    }
+    if (std::find(this->motors_.begin(), this->motors_.end(), &motor) !=
+        this->motors_.end()) {
+      throw std::runtime_error("Motor already added");
+    }
+    this->motors_.push_back(&motor);
+  }
+
+  /**
+   * @brief Start the motors and the control thread.
+   *
+   */
+  void start() {
+    if (this->running_) {
+      throw std::runtime_error("ControllerExecutor already running");
+    }
+    if (this->realTime_.lockMemory) {
+      utils::lockMemory();
+    }
+
+    for (size_t i = 0; i < this->motors_.size(); ++i) {
+      try {
+        this->motors_[i]->beginControl();
+      } catch (...) {
+        for (size_t j = 0; j < i; ++j) this->motors_[j]->endControl();
+        throw;
+      }
+    }
+
+    // Allocated once, the control loop only reads and writes them.
+    const size_t n = this->motors_.size();
+    Controllers& c = this->controllers_;
+    c.targetSpeed.assign(n, 0.0);
+    c.currentSpeed.assign(n, 0.0);
+    c.dutyCycle.assign(n, DutyCycle());
+    c.controllers.clear();
+    c.controllers.reserve(n);
+    c.coefSpeedToDutyCycle.resize(n);
+    c.minDutyCycle.resize(n);
+    c.countsPerSpeed.resize(n);
+    c.minCounts.resize(n);
+    c.fullScale.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      Motor& motor = *this->motors_[i];
+      motor.resetControllers(this->dt_);
+      c.controllers.push_back(std::move(motor.controller_));
+      c.coefSpeedToDutyCycle[i] = motor.coefSpeedToDutyCycle_;
+      c.minDutyCycle[i] = motor.minDutyCycle_;
+      c.countsPerSpeed[i] = motor.countsPerSpeed_;
+      c.minCounts[i] = motor.minCounts_;
+      c.fullScale[i] = motor.fullScale_;
+    }
+
+    this->running_ = true;
+    this->controlThread_ =
+        std::thread(std::bind(&BasicControllerExecutor::controlLoop, this));
+
+    try {
+      utils::setThreadScheduling(this->controlThread_, this->realTime_);
+    } catch (...) {
+      this->stop();
+      throw;
+    }
+  }
+
+  void stop() {
+    if (!this->running_) return;
+
+    this->running_ = false;
+    this->controlThread_.join();
+
+    // Give the controllers back, the motors can run on their own again.
+    Controllers& c = this->controllers_;
+    for (size_t i = 0; i < this->motors_.size(); ++i) {
+      this->motors_[i]->controller_ = std::move(c.controllers[i]);
+    }
+    c.controllers.clear();
+
+    for (auto motor : this->motors_) motor->endControl();
+  }
+
+  /**
+   * @brief Number of motors controlled.
+   *
+   */
+  size_t size() const { return this->motors_.size(); }
+
+  /**
+   * @brief Number of ticks that missed their deadline.
+   *
+   * @return uint64_t
+   */
+  uint64_t getOverrunCount() const { return this->timer_.getOverrunCount(); }
+
+  /**
+   * @brief Timings of the ticks, for all the motors at once.
+   *
+   * @return Statistics
+   */
+  Statistics getStatistics() const {
+    Statistics statistics;
+    statistics.wakeUpLateness = this->wakeUpLateness_.snapshot();
+    statistics.period = this->period_.snapshot();
+    statistics.computeTime = this->computeTime_.snapshot();
+    statistics.writeLatency = this->writeLatency_.snapshot();
+    statistics.deadlineMisses = this->deadlineMisses_.snapshot();
+    return statistics;
+  }
+
+  void resetStatistics() {
+    this->wakeUpLateness_.reset();
+    this->period_.reset();
+    this->computeTime_.reset();
+    this->writeLatency_.reset();
+    this->deadlineMisses_.reset();
+  }
+
+ private:
+  static constexpr bool kIsFixedPoint =
+      controller::IsFixedPoint<Controller>::value;
+
+  // Counts of the PWM channels with a fixed-point controller
+  typedef std::conditional_t<kIsFixedPoint, int32_t, double> DutyCycle;
+
+  void controlLoop() {
+    if (this->realTime_.lockMemory) {
+      utils::prefaultStack();
+    }
+
+    this->timer_.start();
+    auto previousIteration = std::chrono::steady_clock::now();
+
+    while (this->running_) {
+      const auto iterationStart = std::chrono::steady_clock::now();
+      this->period_.record(iterationStart - previousIteration);
+      previousIteration = iterationStart;
+
+      this->sense(iterationStart);
+      this->compute(iterationStart);
+
+      const auto writeStart = std::chrono::steady_clock::now();
+      this->computeTime_.record(writeStart - iterationStart);
+
+      this->actuate();
+
+      this->writeLatency_.record(std::chrono::steady_clock::now() -
+                                 writeStart);
+
+      if (this->timer_.waitNextPeriod()) {
+        this->wakeUpLateness_.record(this->timer_.getLastLateness());
+      } else {
+        this->deadlineMisses_.record(this->timer_.getLastLateness());
+      }
+    }
+  }
+
+  void sense(std::chrono::steady_clock::time_point now) {
+    Controllers& c = this->controllers_;
+    for (size_t i = 0; i < this->motors_.size(); ++i) {
+      this->motors_[i]->sense(now, c.currentSpeed[i], c.targetSpeed[i]);
+    }
+  }
+
+  void compute(std::chrono::steady_clock::time_point now) {
+    // Same step as BasicDCMotor::computeDutyCycle, over all the motors.
+    Controllers& c = this->controllers_;
+    const size_t n = this->motors_.size();
+    for (size_t i = 0; i < n; ++i) {
+      if constexpr (kIsFixedPoint) {
+        typedef typename Controller::Value Value;
+        const Value speed =
+            c.controllers[i].update(Value::fromDouble(c.targetSpeed[i]),
+                                    Value::fromDouble(c.currentSpeed[i]));
+        c.dutyCycle[i] = Motor::countsOf(speed, c.countsPerSpeed[i],
+                                         c.minCounts[i], c.fullScale[i]);
+      } else {
+        const double speed =
+            c.controllers[i].update(c.targetSpeed[i], c.currentSpeed[i]);
+        c.dutyCycle[i] = Motor::dutyCycleOf(speed, c.coefSpeedToDutyCycle[i],
+                                            c.minDutyCycle[i]);
+      }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      Motor& motor = *this->motors_[i];
+      if (!motor.telemetry_) continue;
+      const double dutyCycle =
+          kIsFixedPoint ? static_cast<double>(c.dutyCycle[i]) / c.fullScale[i]
+                        : c.dutyCycle[i];
+      motor.record(now, c.targetSpeed[i], c.currentSpeed[i],
+                   controller::integralOf(c.controllers[i]), dutyCycle);
+    }
+  }
+
+  void actuate() {
+    Controllers& c = this->controllers_;
+    for (size_t i = 0; i < this->motors_.size(); ++i) {
+      this->motors_[i]->actuate(c.dutyCycle[i]);
+    }
+  }
+
+ private:
+  // Controller states, one entry per motor
+  struct Controllers {
+    std::vector<double> targetSpeed, currentSpeed;
+    std::vector<Controller> controllers;
+    std::vector<double> coefSpeedToDutyCycle, minDutyCycle;
+    std::vector<int64_t> countsPerSpeed, minCounts;
+    std::vector<int32_t> fullScale;
+    std::vector<DutyCycle> dutyCycle;
+  };
+
+  const std::chrono::microseconds dt_;
+  const utils::RealTimeConfiguration realTime_;
+
+  std::vector<Motor*> motors_;
+  Controllers controllers_;
+
+  std::atomic<bool> running_;
+  std::thread controlThread_;
+  utils::PeriodicTimer timer_;
+
+  utils::LatencyHistogram wakeUpLateness_, period_, computeTime_,
+      writeLatency_, deadlineMisses_;
+};
+
+/**
+ * @brief Executor of DCMotor, whose controllers are chosen at runtime.
+ *
+ */
+typedef BasicControllerExecutor<controller::DynamicController>
+    ControllerExecutor;
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -17,6 +17,8 @@
 
 #include <memory>    // std::move, std::make_unique, std::unique_ptr
 #include <optional>  // std::optional
+#include <string>    // std::string
+#include <utility>   // std::declval
 #include <vector>    // std::vector
 
 namespace motor_controllers {
@@ -60,6 +62,17 @@ class DCMotorFactory {
     // Controller constants
     double Kp = 1.0, Ki = 0.0, Kd = 0.0;
     std::chrono::microseconds dt = std::chrono::microseconds(10);
+
+    // Position loop, cascaded onto the speed controller
+    controller::ControllerParameters positionController;
+    unsigned int positionLoopRatio = 10;
+
+    // Scheduling of the control thread
+    utils::RealTimeConfiguration realTime;
+
+    // Record of every control period, in this file when not empty
+    std::string telemetryFile;
+    size_t telemetryCapacity = 65536;
   };
 
  public:
@@ -72,10 +85,64 @@ class DCMotorFactory {
 
   DCMotorFactory& operator=(const DCMotorFactory&) = delete;
 
+ public:
+  /**
+   * @brief Channels as returned by the communication interface, e.g.
+   * SimulatedPWMChannelRef.
+   *
+   */
+  typedef decltype(std::declval<CommunicationInterface&>().configureChannel(
+      std::declval<const PWMChannelConfiguration&>())) PWMChannelRef;
+  typedef decltype(std::declval<CommunicationInterface&>().configureChannel(
+      std::declval<const BinaryChannelConfiguration&>())) BinaryChannelRef;
+
+  /**
+   * @brief Motor whose controller and channels are known at compile time.
+   *
+   */
+  template <class Controller>
+  using StaticDCMotor =
+      BasicDCMotor<Controller, PWMChannelRef, BinaryChannelRef>;
+
  public:
   DCMotor::Ref createMotor(const Configuration& configuration) {
     DCMotor::Configuration motorConf = DCMotor::Configuration();
+    this->configureMotor(configuration, motorConf);
+
+    // Controller constants
+    motorConf.Kp = configuration.Kp;
+    motorConf.Ki = configuration.Ki;
+    motorConf.Kd = configuration.Kd;
+
+    return std::unique_ptr<DCMotor>(new DCMotor(motorConf));
+  }
+
+  /**
+   * @brief Create a motor with the given controller, e.g. a PIDController. Kp,
+   * Ki and Kd of the configuration are not used.
+   *
+   * @tparam Controller
+   * @param configuration
+   * @param controller
+   * @return StaticDCMotor<Controller>::Ref
+   */
+  template <class Controller>
+  typename StaticDCMotor<Controller>::Ref createMotor(
+      const Configuration& configuration, const Controller& controller) {
+    typename StaticDCMotor<Controller>::Configuration motorConf;
+    this->configureMotor(configuration, motorConf);
+
+    return std::make_unique<StaticDCMotor<Controller>>(motorConf, controller);
+  }
 
+  void startCommunication() { this->communicationInterface_->start(); }
+
+  void stopCommunication() { this->communicationInterface_->stop(); }
+
+ private:
+  template <class MotorConfiguration>
+  void configureMotor(const Configuration& configuration,
+                      MotorConfiguration& motorConf) {
     // Motor channels
     motorConf.pwmChannel = this->communicationInterface_->configureChannel(
         configuration.pwmChannelConfiguration);
@@ -102,6 +169,7 @@ class DCMotorFactory {
       motorConf.encoder = std::make_unique<encoder::Encoder>(
           std::move(encoderChannelA), configuration.encoderResolution);
     }
+    motorConf.encoderSamplingFrequency = configuration.encoderSamplingFrequency;
 
     motorConf.forwardConfiguration = configuration.forwardConfiguration;
     motorConf.backwardConfiguration = configuration.backwardConfiguration;
@@ -111,17 +179,19 @@ class DCMotorFactory {
     motorConf.minDutyCycle = configuration.minDutyCycle;
     motorConf.maxSpeed = configuration.maxSpeed;
 
-    // Controller constants
-    motorConf.Kp = configuration.Kp;
-    motorConf.Ki = configuration.Ki;
-    motorConf.Kd = configuration.Kd;
+    // Controller period and scheduling
+    motorConf.dt = configuration.dt;
+    motorConf.realTime = configuration.realTime;
 
-    return std::unique_ptr<DCMotor>(new DCMotor(motorConf));
-  }
-
-  void startCommunication() { this->communicationInterface_->start(); }
+    if (!configuration.telemetryFile.empty()) {
+      motorConf.telemetry = std::make_unique<TelemetryRecorder>(
+          configuration.telemetryFile, configuration.telemetryCapacity);
+    }
 
-  void stopCommunication() { this->communicationInterface_->stop(); }
+    // Position loop
+    motorConf.positionController = configuration.positionController;
+    motorConf.positionLoopRatio = configuration.positionLoopRatio;
+  }
 
  private:
   std::unique_ptr<CommunicationInterface> communicationInterface_;
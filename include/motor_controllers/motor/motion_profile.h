@@ -0,0 +1,135 @@
+/**
+ * @file motion_profile.h
+ * @author Pierre Venet
+ * @brief Speed profiles with a bounded acceleration.
+ * @version 0.1
+ * @date 2021-06-09
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <array>    // std::array
+#include <cstddef>  // size_t
+
+namespace motor_controllers {
+namespace motor {
+
+/**
+ * @brief How the speed changes during the acceleration phases.
+ *
+ */
+enum class ProfileShape {
+  TRAPEZOIDAL,  // constant acceleration, the speed is a linear ramp
+  S_CURVE       // sin² acceleration, no step in the acceleration
+};
+
+/**
+ * @brief State of a profile at some time.
+ *
+ */
+struct ProfileSample {
+  double position;      // since the start of the profile
+  double speed;         // same unit as the motor speed
+  double acceleration;  // per second
+};
+
+/**
+ * @brief Speed as a function of the time, made of up to 3 phases:
+ * acceleration, cruise and deceleration.
+ *
+ * A profile is a plain value of fixed size: it can be handed to the control
+ * thread, and sampled there, without any allocation. After its last phase the
+ * profile holds its final speed.
+ *
+ * With the S_CURVE shape the acceleration is A·sin²(πt/T) over a phase of
+ * length T, so a speed change takes twice as long as with TRAPEZOIDAL for the
+ * same maximal acceleration A, but without jerk at the ends of the phases.
+ *
+ */
+class MotionProfile {
+ public:
+  /**
+   * @brief Profile holding a constant speed.
+   *
+   * @param speed
+   */
+  explicit MotionProfile(double speed = 0.0);
+
+ public:
+  /**
+   * @brief Change the speed with a bounded acceleration.
+   *
+   * @param startSpeed
+   * @param endSpeed
+   * @param maxAcceleration positive, per second
+   * @param shape
+   * @return MotionProfile
+   */
+  static MotionProfile ramp(double startSpeed, double endSpeed,
+                            double maxAcceleration,
+                            ProfileShape shape = ProfileShape::TRAPEZOIDAL);
+
+  /**
+   * @brief Travel a distance from rest to rest, with a bounded speed and
+   * acceleration. Short moves do not reach the maximal speed.
+   *
+   * @param distance signed
+   * @param maxSpeed positive
+   * @param maxAcceleration positive, per second
+   * @param shape
+   * @return MotionProfile
+   */
+  static MotionProfile move(double distance, double maxSpeed,
+                            double maxAcceleration,
+                            ProfileShape shape = ProfileShape::TRAPEZOIDAL);
+
+ public:
+  /**
+   * @brief State at a time since the start of the profile, in seconds.
+   *
+   * @param time clamped to 0 when negative
+   * @return ProfileSample
+   */
+  ProfileSample sample(double time) const;
+
+  /**
+   * @brief Length of the profile until it holds its final speed, in seconds.
+   *
+   * @return double
+   */
+  double getDuration() const;
+
+  /**
+   * @brief Position at the end of the profile.
+   *
+   * @return double
+   */
+  double getDistance() const;
+
+  double getFinalSpeed() const;
+
+ private:
+  struct Phase {
+    double duration;
+    double startSpeed;
+    double endSpeed;
+    double startPosition;
+  };
+
+  void addPhase(double duration, double startSpeed, double endSpeed);
+
+  ProfileSample samplePhase(const Phase& phase, double time) const;
+
+ private:
+  std::array<Phase, 3> phases_;
+  size_t phaseCount_;
+  ProfileShape shape_;
+  double duration_;
+  double distance_;
+  double finalSpeed_;
+};
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -0,0 +1,115 @@
+/**
+ * @file servo_group.h
+ * @author Pierre Venet
+ * @brief Servos moved together, one frame at a time.
+ * @version 0.1
+ * @date 2021-06-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/i_batch_writer.h>
+#include <motor_controllers/motor/servo_motor.h>
+
+#include <chrono>   // std::chrono
+#include <cstddef>  // size_t
+#include <cstdint>  // int32_t
+#include <vector>   // std::vector
+
+namespace motor_controllers {
+namespace motor {
+
+/**
+ * @brief How the servos go from their start to their target angle.
+ *
+ */
+enum class ServoEasing {
+  LINEAR,  // constant speed
+  SMOOTH   // smoothstep, no step in the speed at the ends
+};
+
+/**
+ * @brief Servos which start and reach their targets together, e.g. the legs of
+ * a robot.
+ *
+ * moveTo() gives a target to every servo, then each update() is a frame: the
+ * progress of the move is computed once, and the position of every servo in
+ * its table is interpolated from arrays of starts and distances, a loop the
+ * compiler vectorizes. The channels are then set between beginBatch() and
+ * flush() of the batch writers, so that a PCA9685 sends the 16 channels of a
+ * frame in one transaction.
+ *
+ * The group does not own the servos, nor the writers, and is not thread safe:
+ * update it from the thread setting the channels.
+ *
+ */
+class ServoGroup {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+ public:
+  /**
+   * @brief Construct a new ServoGroup
+   *
+   * @param writers interfaces of the channels of the servos, e.g. the
+   * PCA9685Interface of each board. Without them, every channel is written on
+   * its own.
+   */
+  explicit ServoGroup(std::vector<communication::IBatchWriter*> writers = {});
+
+ public:
+  /**
+   * @brief Add a servo, between two moves. It stays at its angle until the
+   * next move.
+   *
+   * @param servo
+   * @return size_t index of the servo in the targets
+   */
+  size_t add(ServoMotor& servo);
+
+  size_t size() const;
+
+  /**
+   * @brief Start moving every servo from its current angle to its target.
+   * The servos without an angle yet go straight to their target.
+   *
+   * @param angles target of each servo, in the order they were added
+   * @param duration of the move, the same for all the servos
+   * @param easing
+   * @param start of the move
+   */
+  void moveTo(const std::vector<double>& angles,
+              std::chrono::microseconds duration,
+              ServoEasing easing = ServoEasing::SMOOTH,
+              clock::time_point start = clock::now());
+
+  /**
+   * @brief Send the frame of a time: the angles of all the servos, in one
+   * batch.
+   *
+   * @param now
+   * @return true if the move is not over, false after its last frame
+   */
+  bool update(clock::time_point now = clock::now());
+
+  bool isMoving() const;
+
+ private:
+  const std::vector<communication::IBatchWriter*> writers_;
+  std::vector<ServoMotor*> servos_;
+
+  // Structure of arrays, in entries of the tables of the servos
+  std::vector<float> starts_;
+  std::vector<float> distances_;
+  std::vector<int32_t> indices_;
+
+  clock::time_point start_;
+  std::chrono::microseconds duration_;
+  ServoEasing easing_;
+  bool isMoving_;
+};
+
+}  // namespace motor
+}  // namespace motor_controllers
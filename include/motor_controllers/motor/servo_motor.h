@@ -0,0 +1,144 @@
+/**
+ * @file servo_motor.h
+ * @author Pierre Venet
+ * @brief Hobby servo driven by the pulse width of a PWM channel.
+ * @version 0.1
+ * @date 2021-06-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/communication/i_pwm_signal_channel.h>
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint32_t
+#include <memory>   // std::unique_ptr
+#include <vector>   // std::vector
+
+namespace motor_controllers {
+namespace motor {
+
+/**
+ * @brief Pulse width measured for an angle of the servo.
+ *
+ */
+struct ServoCalibrationPoint {
+  double angle;       // degrees
+  double pulseWidth;  // microseconds
+};
+
+/**
+ * @brief Servo whose angle is set by the pulse width of a PWM channel.
+ *
+ * The pulse width is linear between the calibration points. It is converted
+ * to counts of the channel once per PWM frequency, in a table with an entry
+ * every resolution degrees: setting an angle is then a lookup and a raw write,
+ * see IPWMSignalChannel::setRawDutyCycle.
+ *
+ * To move many servos together, add them to a ServoGroup.
+ *
+ */
+class ServoMotor {
+ public:
+  typedef std::unique_ptr<ServoMotor> Ref;
+
+ public:
+  struct Configuration {
+    // PWM channel and its frequency
+    communication::IPWMSignalChannel::Ref pwmChannel;
+    double pwmFrequency = 50;
+
+    // At least 2 points, by increasing angle, the range of the servo
+    std::vector<ServoCalibrationPoint> calibration = {{0.0, 500.0},
+                                                      {180.0, 2500.0}};
+
+    // Degrees between two entries of the table
+    double resolution = 0.25;
+  };
+
+ public:
+  explicit ServoMotor(Configuration& conf);
+
+  ~ServoMotor();
+
+ public:
+  /**
+   * @brief Set the frequency of the channel and compute the table again.
+   *
+   * @param frequency in hertz
+   */
+  void setPWMFrequency(double frequency);
+
+  /**
+   * @brief Move to an angle, rounded to the resolution.
+   *
+   * @param angle in degrees, clamped to the calibrated range
+   */
+  void setAngle(double angle);
+
+  /**
+   * @brief Last angle set, NaN before the first one.
+   *
+   * @return double in degrees
+   */
+  double getAngle() const;
+
+  double getMinAngle() const;
+
+  double getMaxAngle() const;
+
+  /**
+   * @brief Counts of the channel for an angle, from the table.
+   *
+   * @param angle in degrees, clamped to the calibrated range
+   * @return uint32_t
+   */
+  uint32_t getCounts(double angle) const;
+
+ private:
+  friend class ServoGroup;
+
+  /**
+   * @brief Entry of the table closest to an angle.
+   *
+   * @param angle in degrees, clamped
+   * @return size_t
+   */
+  size_t indexOf(double angle) const;
+
+  /**
+   * @brief Angle as a position in the table, not rounded.
+   *
+   * @param angle in degrees, clamped
+   * @return double
+   */
+  double positionOf(double angle) const;
+
+  void setIndex(size_t index) {
+    this->index_ = index;
+    this->pwmChannel_->setRawDutyCycle(this->table_[index]);
+  }
+
+  /**
+   * @brief Pulse width of an angle, from the calibration.
+   *
+   * @param angle in degrees, within the range
+   * @return double in microseconds
+   */
+  double pulseWidthOf(double angle) const;
+
+ private:
+  communication::IPWMSignalChannel::Ref pwmChannel_;
+  const std::vector<ServoCalibrationPoint> calibration_;
+  const double resolution_;
+
+  std::vector<uint32_t> table_;  // counts of the channel, every resolution_
+
+  static constexpr size_t kNoIndex = ~size_t(0);
+  size_t index_;  // in table_, kNoIndex before the first angle
+};
+
+}  // namespace motor
+}  // namespace motor_controllers
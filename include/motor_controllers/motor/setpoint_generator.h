@@ -0,0 +1,209 @@
+/**
+ * @file setpoint_generator.h
+ * @author Pierre Venet
+ * @brief Target of a control loop, from commands of other threads.
+ * @version 0.1
+ * @date 2021-06-09
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <motor_controllers/motor/motion_profile.h>
+#include <motor_controllers/utils/spsc_ring_buffer.h>
+#include <motor_controllers/utils/triple_buffer.h>
+
+#include <atomic>   // std::atomic
+#include <chrono>   // std::chrono
+#include <cstdint>  // uint64_t
+#include <mutex>    // std::mutex
+#include <vector>   // std::vector
+
+namespace motor_controllers {
+namespace motor {
+
+/**
+ * @brief Target speed to reach at a given time.
+ *
+ */
+struct Setpoint {
+  std::chrono::steady_clock::time_point time;
+  double speed;
+};
+
+/**
+ * @brief What the control loop regulates during a period.
+ *
+ */
+struct Reference {
+  bool positionControl = false;
+  double position = 0.0;  // target position, in position control
+  double speed = 0.0;     // target speed, the feedforward in position control
+};
+
+/**
+ * @brief Turns the commands of the callers into a Reference, sampled by the
+ * control thread at each period.
+ *
+ * A speed command is either a constant speed, a ramp from the current target,
+ * a MotionProfile or a stream of timestamped setpoints, interpolated linearly.
+ * A position command is either a move along a MotionProfile or holding the
+ * current position. Positions are in revolutions, i.e. the unit of the speeds
+ * times seconds.
+ * The latest command wins: it goes through a TripleBuffer, and the setpoints
+ * through a SpscRingBuffer, so the control thread never waits for a caller.
+ * The callers are serialised between themselves by a mutex.
+ *
+ */
+class SetpointGenerator {
+ public:
+  static constexpr size_t kStreamCapacity = 256;
+
+ public:
+  SetpointGenerator();
+
+  SetpointGenerator(const SetpointGenerator&) = delete;
+
+  SetpointGenerator& operator=(const SetpointGenerator&) = delete;
+
+ public:
+  /**
+   * @brief Step to a constant speed.
+   *
+   * @param speed
+   */
+  void setSpeed(double speed);
+
+  /**
+   * @brief Ramp from the current target to a constant speed.
+   *
+   * @param speed
+   * @param maxAcceleration positive, per second
+   * @param shape
+   */
+  void rampTo(double speed, double maxAcceleration,
+              ProfileShape shape = ProfileShape::TRAPEZOIDAL);
+
+  /**
+   * @brief Follow the speed of a profile, then hold its final speed.
+   *
+   * @param profile
+   * @param start time of the beginning of the profile
+   */
+  void followProfile(const MotionProfile& profile,
+                     std::chrono::steady_clock::time_point start =
+                         std::chrono::steady_clock::now());
+
+  /**
+   * @brief Queue timestamped setpoints, in increasing time order. The target
+   * goes linearly from one to the next, and holds the last one.
+   *
+   * Queuing after another command starts a new stream, from the current
+   * target. The queue is bounded: when it is full the remaining setpoints are
+   * not taken, the caller can push them again once some are due.
+   *
+   * @param setpoints
+   * @return size_t number of setpoints queued
+   */
+  size_t pushSetpoints(const std::vector<Setpoint>& setpoints);
+
+  /**
+   * @brief Move from the current position, or position target, to a position
+   * and hold it. The move starts and ends at rest.
+   *
+   * @param position
+   * @param maxSpeed positive
+   * @param maxAcceleration positive, per second
+   * @param shape
+   */
+  void moveTo(double position, double maxSpeed, double maxAcceleration,
+              ProfileShape shape = ProfileShape::TRAPEZOIDAL);
+
+  /**
+   * @brief Hold the current position, or position target.
+   *
+   */
+  void hold();
+
+  /**
+   * @brief Last target speed sampled by the control thread. Thread safe.
+   *
+   * @return double
+   */
+  double getTarget() const;
+
+  /**
+   * @brief Last target position sampled by the control thread, or the
+   * measured position when controlling the speed. Thread safe.
+   *
+   * @return double
+   */
+  double getTargetPosition() const;
+
+  /**
+   * @brief Reference at the given time, to be called by the control thread
+   * only.
+   *
+   * @param now
+   * @param position measured, where the position commands start from
+   * @return Reference
+   */
+  Reference sample(std::chrono::steady_clock::time_point now, double position);
+
+ private:
+  enum class Mode { SPEED, RAMP, PROFILE, STREAM, MOVE, HOLD };
+
+  struct Command {
+    Mode mode = Mode::SPEED;
+    double speed = 0.0;
+    double position = 0.0;
+    double maxAcceleration = 0.0;
+    ProfileShape shape = ProfileShape::TRAPEZOIDAL;
+    MotionProfile profile;
+    std::chrono::steady_clock::time_point start;
+    uint64_t stream = 0;
+  };
+
+  struct StreamedSetpoint {
+    Setpoint setpoint;
+    uint64_t stream;
+  };
+
+  void submit(Command& command);
+
+  // With the mutex of the callers held
+  void write(Command& command);
+
+  void apply(const Command& command, std::chrono::steady_clock::time_point now,
+             double position);
+
+  double sampleStream(std::chrono::steady_clock::time_point now);
+
+  bool peekSetpoint();
+
+ private:
+  // Callers
+  std::mutex mtx_;
+  Mode lastMode_;
+  uint64_t lastStream_;
+
+  utils::TripleBuffer<Command> mailbox_;
+  utils::SpscRingBuffer<StreamedSetpoint, kStreamCapacity> setpoints_;
+
+  // Control thread
+  Mode mode_;
+  double target_;
+  double targetPosition_;
+  MotionProfile profile_;
+  std::chrono::steady_clock::time_point profileStart_;
+  double moveStart_;
+  uint64_t stream_;
+  StreamedSetpoint previous_, next_;
+  bool hasNext_;
+
+  std::atomic<double> publishedTarget_, publishedPosition_;
+};
+
+}  // namespace motor
+}  // namespace motor_controllers
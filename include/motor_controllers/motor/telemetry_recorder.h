@@ -0,0 +1,116 @@
+/**
+ * @file telemetry_recorder.h
+ * @author Pierre Venet
+ * @brief Ring of control loop records in a memory-mapped file.
+ * @version 0.1
+ * @date 2021-06-14
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <atomic>   // std::atomic
+#include <cstddef>  // size_t
+#include <cstdint>  // int64_t, uint64_t
+#include <memory>   // std::unique_ptr
+#include <string>   // std::string
+
+namespace motor_controllers {
+namespace motor {
+
+/**
+ * @brief One control period. Little endian doubles, as read by
+ * motor_controllers/telemetry.py.
+ *
+ */
+struct TelemetryRecord {
+  int64_t timestamp;  // CLOCK_MONOTONIC, in nanoseconds
+  double setpoint;    // target speed
+  double speed;       // measured speed
+  double error;       // setpoint - speed
+  double integral;    // of the speed controller, 0 if it has none
+  double dutyCycle;   // signed by the direction
+};
+
+/**
+ * @brief Layout of the start of the file, followed by capacity records.
+ *
+ */
+struct TelemetryHeader {
+  char magic[8];  // "MCTELEM"
+  uint32_t version;
+  uint32_t recordSize;
+  uint64_t capacity;
+  uint64_t writeIndex;  // number of records written since the start
+  uint8_t reserved[32];
+};
+
+/**
+ * @brief Fixed-size ring of TelemetryRecord written by a control loop at every
+ * period, and read from the file by other processes, e.g. as a numpy array.
+ *
+ * The file is mapped and prefaulted once, a record is then a few stores into
+ * the mapping and a release store of the write index: no allocation, no lock,
+ * no system call. The reader checks the write index again after copying, the
+ * records overwritten meanwhile are torn and must be dropped.
+ *
+ */
+class TelemetryRecorder {
+ public:
+  typedef std::unique_ptr<TelemetryRecorder> Ref;
+
+  static constexpr uint32_t kVersion = 1;
+
+ public:
+  /**
+   * @brief Create, or truncate, the file and map it.
+   *
+   * @param path
+   * @param capacity number of records kept
+   */
+  TelemetryRecorder(const std::string& path, size_t capacity);
+
+  ~TelemetryRecorder();
+
+  TelemetryRecorder(const TelemetryRecorder&) = delete;
+
+  TelemetryRecorder& operator=(const TelemetryRecorder&) = delete;
+
+ public:
+  /**
+   * @brief Append a record, overwriting the oldest one when full. Single
+   * writer.
+   *
+   * @param record
+   */
+  void record(const TelemetryRecord& record) noexcept {
+    const uint64_t index = this->writeIndex_->load(std::memory_order_relaxed);
+    this->records_[index % this->capacity_] = record;
+    this->writeIndex_->store(index + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief Number of records written since the creation.
+   *
+   * @return uint64_t
+   */
+  uint64_t getWriteIndex() const {
+    return this->writeIndex_->load(std::memory_order_acquire);
+  }
+
+  size_t getCapacity() const { return this->capacity_; }
+
+  const std::string& getPath() const { return this->path_; }
+
+ private:
+  const std::string path_;
+  const size_t capacity_;
+  size_t size_;  // of the mapping, in bytes
+  void* mapping_;
+  std::atomic<uint64_t>* writeIndex_;
+  TelemetryRecord* records_;
+};
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -0,0 +1,126 @@
+/**
+ * @file fixed_point.h
+ * @author Pierre Venet
+ * @brief Q-format fixed-point numbers.
+ * @version 0.1
+ * @date 2021-06-15
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <cstdint>  // int32_t, int64_t
+#include <limits>   // std::numeric_limits
+
+namespace motor_controllers {
+namespace utils {
+
+/**
+ * @brief Signed number stored on 32 bits, kFractionBits of them after the
+ * point: Fixed<16> is Q16.16, from -32768 to 32768 by steps of 1/65536.
+ *
+ * Additions are integer additions and products go through 64 bits, for the
+ * cores without a fast FPU. The conversions from floating point saturate and
+ * are meant to be done once, outside of the loops.
+ *
+ * @tparam kFractionBits
+ */
+template <int kFractionBits>
+class Fixed {
+  static_assert(kFractionBits > 0 && kFractionBits < 31,
+                "Fixed needs integer and fraction bits");
+
+ public:
+  static constexpr int kFractionBitCount = kFractionBits;
+  static constexpr int32_t kOne = int32_t(1) << kFractionBits;
+
+ public:
+  constexpr Fixed() : raw_(0) {}
+
+  static constexpr Fixed fromRaw(int32_t raw) {
+    Fixed value;
+    value.raw_ = raw;
+    return value;
+  }
+
+  static constexpr Fixed fromDouble(double value) {
+    return fromRaw(saturate(value * kOne + (value < 0 ? -0.5 : 0.5)));
+  }
+
+  static constexpr Fixed max() {
+    return fromRaw(std::numeric_limits<int32_t>::max());
+  }
+
+  static constexpr Fixed min() {
+    return fromRaw(std::numeric_limits<int32_t>::min());
+  }
+
+ public:
+  constexpr int32_t raw() const { return this->raw_; }
+
+  constexpr double toDouble() const {
+    return static_cast<double>(this->raw_) / kOne;
+  }
+
+  constexpr Fixed operator+(Fixed other) const {
+    return fromRaw(this->raw_ + other.raw_);
+  }
+
+  constexpr Fixed operator-(Fixed other) const {
+    return fromRaw(this->raw_ - other.raw_);
+  }
+
+  constexpr Fixed operator-() const { return fromRaw(-this->raw_); }
+
+  constexpr Fixed operator*(Fixed other) const {
+    return fromRaw(static_cast<int32_t>(
+        (static_cast<int64_t>(this->raw_) * other.raw_) >> kFractionBits));
+  }
+
+  Fixed& operator+=(Fixed other) {
+    this->raw_ += other.raw_;
+    return *this;
+  }
+
+  Fixed& operator-=(Fixed other) {
+    this->raw_ -= other.raw_;
+    return *this;
+  }
+
+  constexpr bool operator<(Fixed other) const {
+    return this->raw_ < other.raw_;
+  }
+  constexpr bool operator>(Fixed other) const {
+    return this->raw_ > other.raw_;
+  }
+  constexpr bool operator<=(Fixed other) const {
+    return this->raw_ <= other.raw_;
+  }
+  constexpr bool operator>=(Fixed other) const {
+    return this->raw_ >= other.raw_;
+  }
+  constexpr bool operator==(Fixed other) const {
+    return this->raw_ == other.raw_;
+  }
+  constexpr bool operator!=(Fixed other) const {
+    return this->raw_ != other.raw_;
+  }
+
+ private:
+  static constexpr int32_t saturate(double raw) {
+    return (raw >= static_cast<double>(std::numeric_limits<int32_t>::max()))
+               ? std::numeric_limits<int32_t>::max()
+           : (raw <= static_cast<double>(std::numeric_limits<int32_t>::min()))
+               ? std::numeric_limits<int32_t>::min()
+               : static_cast<int32_t>(raw);
+  }
+
+ private:
+  int32_t raw_;
+};
+
+typedef Fixed<16> Q16;
+
+}  // namespace utils
+}  // namespace motor_controllers
@@ -0,0 +1,183 @@
+/**
+ * @file latency_histogram.h
+ * @author Pierre Venet
+ * @brief Lock-free histogram of durations.
+ * @version 0.1
+ * @date 2021-06-04
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <algorithm>  // std::min
+#include <array>      // std::array
+#include <atomic>     // std::atomic
+#include <chrono>     // std::chrono
+#include <cstdint>    // uint64_t
+#include <limits>     // std::numeric_limits
+
+namespace motor_controllers {
+namespace utils {
+
+/**
+ * @brief Histogram of durations with fixed, logarithmic buckets.
+ *
+ * Each power of two is split in 4 buckets, i.e. a resolution of 25% or better,
+ * from 1 ns to about 18 minutes. Recording is a few relaxed atomic increments,
+ * without lock nor allocation, so it can be done in a control loop while other
+ * threads read it.
+ *
+ * A snapshot or a reset concurrent to record() can be off by the samples
+ * being recorded, the histogram does not stop the writer.
+ *
+ */
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBuckets = 4;
+  static constexpr size_t kBucketCount = 160;
+
+  /**
+   * @brief Copy of the histogram at some point in time.
+   *
+   */
+  struct Snapshot {
+    std::array<uint64_t, kBucketCount> counts = {};
+    uint64_t count = 0;
+    std::chrono::nanoseconds min = std::chrono::nanoseconds(0);
+    std::chrono::nanoseconds max = std::chrono::nanoseconds(0);
+    std::chrono::nanoseconds sum = std::chrono::nanoseconds(0);
+
+    /**
+     * @brief Average of the samples.
+     *
+     * @return std::chrono::nanoseconds
+     */
+    std::chrono::nanoseconds mean() const {
+      return (this->count > 0) ? this->sum / static_cast<int64_t>(this->count)
+                               : std::chrono::nanoseconds(0);
+    }
+
+    /**
+     * @brief Upper bound of the bucket holding the given percentile.
+     *
+     * @param percentile in [0, 100]
+     * @return std::chrono::nanoseconds, at most the max
+     */
+    std::chrono::nanoseconds percentile(double percentile) const {
+      if (this->count == 0) return std::chrono::nanoseconds(0);
+
+      const double target = percentile / 100.0 * this->count;
+      uint64_t cumulated = 0;
+      for (size_t i = 0; i < kBucketCount; ++i) {
+        cumulated += this->counts[i];
+        if (cumulated > 0 && cumulated >= target) {
+          const auto upper =
+              (i + 1 < kBucketCount)
+                  ? std::chrono::nanoseconds(bucketLowerBound(i + 1) - 1)
+                  : this->max;
+          return std::min(upper, this->max);
+        }
+      }
+      return this->max;
+    }
+  };
+
+ public:
+  LatencyHistogram() { this->reset(); }
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+ public:
+  /**
+   * @brief Add a sample. Negative durations are counted as 0.
+   *
+   * @param duration
+   */
+  void record(std::chrono::nanoseconds duration) noexcept {
+    const uint64_t value =
+        (duration.count() > 0) ? static_cast<uint64_t>(duration.count()) : 0;
+
+    this->counts_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    this->count_.fetch_add(1, std::memory_order_relaxed);
+    this->sum_.fetch_add(value, std::memory_order_relaxed);
+
+    // Single writer in practice: no need for a compare and swap loop.
+    if (value < this->min_.load(std::memory_order_relaxed)) {
+      this->min_.store(value, std::memory_order_relaxed);
+    }
+    if (value > this->max_.load(std::memory_order_relaxed)) {
+      this->max_.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Copy the histogram.
+   *
+   * @return Snapshot
+   */
+  Snapshot snapshot() const {
+    Snapshot snapshot;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      snapshot.counts[i] = this->counts_[i].load(std::memory_order_relaxed);
+    }
+    snapshot.count = this->count_.load(std::memory_order_relaxed);
+    if (snapshot.count > 0) {
+      snapshot.min = std::chrono::nanoseconds(
+          this->min_.load(std::memory_order_relaxed));
+      snapshot.max = std::chrono::nanoseconds(
+          this->max_.load(std::memory_order_relaxed));
+      snapshot.sum = std::chrono::nanoseconds(
+          this->sum_.load(std::memory_order_relaxed));
+    }
+    return snapshot;
+  }
+
+  /**
+   * @brief Clear the samples.
+   *
+   */
+  void reset() noexcept {
+    for (auto& count : this->counts_) {
+      count.store(0, std::memory_order_relaxed);
+    }
+    this->count_.store(0, std::memory_order_relaxed);
+    this->sum_.store(0, std::memory_order_relaxed);
+    this->min_.store(std::numeric_limits<uint64_t>::max(),
+                     std::memory_order_relaxed);
+    this->max_.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Smallest duration counted in a bucket, in nanoseconds.
+   *
+   * @param index
+   * @return uint64_t
+   */
+  static constexpr uint64_t bucketLowerBound(size_t index) {
+    if (index < kSubBuckets) return index;
+    const size_t octave = index / kSubBuckets + 1;
+    return (kSubBuckets + index % kSubBuckets) << (octave - 2);
+  }
+
+ private:
+  static size_t bucketIndex(uint64_t value) {
+    if (value < kSubBuckets) return value;
+    const size_t octave = 63 - __builtin_clzll(value);  // >= 2
+    const size_t index =
+        (octave - 1) * kSubBuckets + ((value >> (octave - 2)) & 3);
+    return (index < kBucketCount) ? index : kBucketCount - 1;
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, kBucketCount> counts_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> min_;
+  std::atomic<uint64_t> max_;
+};
+
+}  // namespace utils
+}  // namespace motor_controllers
@@ -0,0 +1,194 @@
+/**
+ * @file real_time.h
+ * @author Pierre Venet
+ * @brief Scheduling helpers for the periodic control threads.
+ * @version 0.1
+ * @date 2021-06-03
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <errno.h>     // errno, EINTR
+#include <pthread.h>   // pthread_setschedparam, pthread_setaffinity_np
+#include <sched.h>     // SCHED_FIFO, cpu_set_t
+#include <string.h>    // strerror
+#include <sys/mman.h>  // mlockall
+#include <time.h>      // clock_nanosleep
+
+#include <atomic>     // std::atomic
+#include <chrono>     // std::chrono
+#include <cstdint>    // int64_t, uint64_t
+#include <stdexcept>  // std::runtime_error
+#include <string>     // std::string
+#include <thread>     // std::thread
+
+namespace motor_controllers {
+namespace utils {
+
+/**
+ * @brief How a periodic thread is scheduled. The defaults leave it as a
+ * regular thread.
+ *
+ * A SCHED_FIFO priority needs CAP_SYS_NICE (or an rtprio limit) and locking
+ * the memory CAP_IPC_LOCK (or a memlock limit).
+ *
+ */
+struct RealTimeConfiguration {
+  int priority = 0;         // SCHED_FIFO priority in [1, 99], 0 to keep
+                            // SCHED_OTHER
+  int cpu = -1;             // core the thread is pinned to, -1 for any
+  bool lockMemory = false;  // mlockall and prefault the stack of the thread
+};
+
+/**
+ * @brief Lock the current and future pages of the process in RAM, so that the
+ * control threads never wait on a page fault.
+ *
+ */
+inline void lockMemory() {
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    throw std::runtime_error(std::string("mlockall failed: ") +
+                             strerror(errno));
+  }
+}
+
+/**
+ * @brief Touch the stack of the calling thread, once the memory is locked its
+ * pages are then resident.
+ *
+ */
+inline void prefaultStack() {
+  constexpr size_t kStackPrefaultSize = 64 * 1024;
+  unsigned char stack[kStackPrefaultSize];
+  volatile unsigned char* page = stack;
+  for (size_t i = 0; i < kStackPrefaultSize; i += 4096) {
+    page[i] = 0;
+  }
+}
+
+/**
+ * @brief Apply the priority and affinity of the configuration to a thread.
+ *
+ * @param thread
+ * @param configuration
+ */
+inline void setThreadScheduling(std::thread& thread,
+                                const RealTimeConfiguration& configuration) {
+  if (configuration.cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(configuration.cpu, &cpus);
+    const int error =
+        pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+    if (error != 0) {
+      throw std::runtime_error(std::string("Cannot pin the thread: ") +
+                               strerror(error));
+    }
+  }
+
+  if (configuration.priority > 0) {
+    sched_param parameters = {};
+    parameters.sched_priority = configuration.priority;
+    const int error = pthread_setschedparam(thread.native_handle(), SCHED_FIFO,
+                                            &parameters);
+    if (error != 0) {
+      throw std::runtime_error(std::string("Cannot set SCHED_FIFO: ") +
+                               strerror(error));
+    }
+  }
+}
+
+/**
+ * @brief Wakes a thread periodically on absolute deadlines.
+ *
+ * The deadlines are multiples of the period from start(), so the wake up
+ * latency does not accumulate. When the loop misses a deadline it is counted
+ * as an overrun and the missed periods are skipped, instead of running a burst
+ * of late iterations.
+ *
+ */
+class PeriodicTimer {
+ public:
+  explicit PeriodicTimer(std::chrono::nanoseconds period)
+      : period_(period.count()),
+        deadline_(0),
+        lateness_(0),
+        overrunCount_(0) {
+    if (period.count() <= 0) {
+      throw std::runtime_error("PeriodicTimer: the period must be positive");
+    }
+  }
+
+ public:
+  /**
+   * @brief Start counting the periods from now.
+   *
+   */
+  void start() { this->deadline_ = now(); }
+
+  /**
+   * @brief Sleep until the end of the current period.
+   *
+   * @return false if the deadline was already missed
+   */
+  bool waitNextPeriod() {
+    this->deadline_ += this->period_;
+
+    const int64_t current = now();
+    if (current >= this->deadline_) {
+      this->lateness_ = current - this->deadline_;
+      this->overrunCount_.fetch_add(1, std::memory_order_relaxed);
+      // The next call adds one period, the next deadline is then the first
+      // boundary after now.
+      const int64_t skipped = (current - this->deadline_) / this->period_;
+      this->deadline_ += skipped * this->period_;
+      return false;
+    }
+
+    timespec deadline;
+    deadline.tv_sec = this->deadline_ / 1000000000;
+    deadline.tv_nsec = this->deadline_ % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline,
+                           nullptr) == EINTR)
+      ;
+    this->lateness_ = now() - this->deadline_;
+    return true;
+  }
+
+  /**
+   * @brief How late the last waitNextPeriod() returned after its deadline, or
+   * by how much the deadline was missed.
+   *
+   * @return std::chrono::nanoseconds
+   */
+  std::chrono::nanoseconds getLastLateness() const {
+    return std::chrono::nanoseconds(this->lateness_);
+  }
+
+  /**
+   * @brief Number of periods whose deadline was missed. Thread safe.
+   *
+   * @return uint64_t
+   */
+  uint64_t getOverrunCount() const {
+    return this->overrunCount_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static int64_t now() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return int64_t(time.tv_sec) * 1000000000 + time.tv_nsec;
+  }
+
+ private:
+  const int64_t period_;  // in nanoseconds
+  int64_t deadline_;      // on CLOCK_MONOTONIC, in nanoseconds
+  int64_t lateness_;      // in nanoseconds
+  std::atomic<uint64_t> overrunCount_;
+};
+
+}  // namespace utils
+}  // namespace motor_controllers
@@ -0,0 +1,96 @@
+/**
+ * @file semaphore.h
+ * @author Pierre Venet
+ * @brief Counting semaphore whose post never blocks.
+ * @version 0.1
+ * @date 2021-05-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <errno.h>      // errno, EINTR
+#include <semaphore.h>  // sem_t, sem_clockwait
+#include <time.h>       // clock_gettime, CLOCK_MONOTONIC
+
+#include <chrono>  // std::chrono
+
+namespace motor_controllers {
+namespace utils {
+
+/**
+ * @brief Thin wrapper around a POSIX semaphore.
+ *
+ * Unlike a condition variable, notifying does not require to take a mutex:
+ * post() never blocks and is async-signal-safe. This makes it suitable to wake
+ * a consumer from a callback that must not be delayed, such as the pigpio
+ * alert thread.
+ *
+ */
+class Semaphore {
+ public:
+  Semaphore() { sem_init(&this->semaphore_, 0, 0); }
+
+  ~Semaphore() { sem_destroy(&this->semaphore_); }
+
+  Semaphore(const Semaphore&) = delete;
+
+  Semaphore& operator=(const Semaphore&) = delete;
+
+ public:
+  /**
+   * @brief Increment the count and wake a waiter. Never blocks.
+   *
+   */
+  void post() noexcept { sem_post(&this->semaphore_); }
+
+  /**
+   * @brief Block until the count is positive and decrement it.
+   *
+   */
+  void wait() noexcept {
+    while (sem_wait(&this->semaphore_) == -1 && errno == EINTR)
+      ;
+  }
+
+  /**
+   * @brief Same as wait() but gives up after timeout.
+   *
+   * The deadline is on the monotonic clock, a step of the system time does
+   * not lengthen or shorten the wait.
+   *
+   * @param timeout
+   * @return true if the count was decremented
+   * @return false on timeout
+   */
+  bool waitFor(std::chrono::nanoseconds timeout) noexcept {
+    if (timeout.count() <= 0) return this->tryWait();
+
+    timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    const auto ns = deadline.tv_nsec + timeout.count();
+    deadline.tv_sec += ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+
+    int res;
+    while ((res = sem_clockwait(&this->semaphore_, CLOCK_MONOTONIC,
+                                &deadline)) == -1 &&
+           errno == EINTR)
+      ;
+    return res == 0;
+  }
+
+  /**
+   * @brief Decrement the count if positive, without blocking.
+   *
+   * @return true if the count was decremented
+   */
+  bool tryWait() noexcept { return sem_trywait(&this->semaphore_) == 0; }
+
+ private:
+  sem_t semaphore_;
+};
+
+}  // namespace utils
+}  // namespace motor_controllers
@@ -0,0 +1,106 @@
+/**
+ * @file seqlock.h
+ * @author Pierre Venet
+ * @brief Single writer, multiple readers sequence lock.
+ * @version 0.1
+ * @date 2021-05-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <stdint.h>  // uintptr_t
+
+#include <array>        // std::array
+#include <atomic>       // std::atomic, std::atomic_thread_fence
+#include <cstring>      // std::memcpy
+#include <type_traits>  // std::is_trivially_copyable
+
+namespace motor_controllers {
+namespace utils {
+
+/**
+ * @brief Publish a trivially copyable value from one writer to many readers.
+ *
+ * The writer never waits: store() bumps a sequence counter to an odd value,
+ * writes the payload and bumps the counter again. Readers copy the payload and
+ * retry only if the counter was odd or changed during the copy, so a reader
+ * always gets a consistent snapshot and never delays the writer.
+ *
+ * The payload is stored as an array of pointer-sized atomic words accessed
+ * with relaxed ordering. This keeps the concurrent copy free of data races and
+ * stays lock-free on 32 bits targets.
+ *
+ * Only one thread may call store() at a time.
+ *
+ * @tparam T a trivially copyable type
+ */
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock requires a trivially copyable type");
+
+ public:
+  SeqLock() : sequence_(0) { this->store(T()); }
+
+  explicit SeqLock(const T& value) : sequence_(0) { this->store(value); }
+
+  SeqLock(const SeqLock&) = delete;
+
+  SeqLock& operator=(const SeqLock&) = delete;
+
+ public:
+  /**
+   * @brief Publish a new value. Wait-free, single writer only.
+   *
+   * @param value
+   */
+  void store(const T& value) noexcept {
+    uintptr_t buffer[kWords] = {};
+    std::memcpy(buffer, &value, sizeof(T));
+
+    const uint32_t sequence = this->sequence_.load(std::memory_order_relaxed);
+    this->sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < kWords; ++i) {
+      this->data_[i].store(buffer[i], std::memory_order_relaxed);
+    }
+
+    this->sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  /**
+   * @brief Read a consistent snapshot of the last published value.
+   *
+   * @return T
+   */
+  T load() const noexcept {
+    uintptr_t buffer[kWords];
+    uint32_t before, after;
+
+    do {
+      before = this->sequence_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < kWords; ++i) {
+        buffer[i] = this->data_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = this->sequence_.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    T value;
+    std::memcpy(&value, buffer, sizeof(T));
+    return value;
+  }
+
+ private:
+  static constexpr size_t kWords =
+      (sizeof(T) + sizeof(uintptr_t) - 1) / sizeof(uintptr_t);
+
+  alignas(64) std::atomic<uint32_t> sequence_;
+  std::array<std::atomic<uintptr_t>, kWords> data_;
+};
+
+}  // namespace utils
+}  // namespace motor_controllers
@@ -0,0 +1,107 @@
+/**
+ * @file spsc_ring_buffer.h
+ * @author Pierre Venet
+ * @brief Bounded lock-free single producer single consumer queue.
+ * @version 0.1
+ * @date 2021-05-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <array>    // std::array
+#include <atomic>   // std::atomic
+#include <cstddef>  // size_t
+
+namespace motor_controllers {
+namespace utils {
+
+/**
+ * @brief Bounded lock-free queue between exactly one producer thread and one
+ * consumer thread.
+ *
+ * Neither side ever blocks: push() fails when the queue is full and pop()
+ * fails when it is empty, the caller decides what to do. The storage is
+ * allocated inline, nothing is allocated after construction.
+ *
+ * @tparam T the element type, copied in and out
+ * @tparam Capacity a power of 2
+ */
+template <typename T, size_t Capacity>
+class SpscRingBuffer {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "SpscRingBuffer capacity must be a power of 2");
+
+ public:
+  SpscRingBuffer() : head_(0), tailCache_(0), tail_(0), headCache_(0) {}
+
+  SpscRingBuffer(const SpscRingBuffer&) = delete;
+
+  SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+ public:
+  /**
+   * @brief Append a value. Producer side only.
+   *
+   * @param value
+   * @return true if the value was queued
+   * @return false if the queue was full, the value is dropped
+   */
+  bool push(const T& value) noexcept {
+    const size_t head = this->head_.load(std::memory_order_relaxed);
+    if (head - this->tailCache_ == Capacity) {
+      this->tailCache_ = this->tail_.load(std::memory_order_acquire);
+      if (head - this->tailCache_ == Capacity) return false;
+    }
+    this->buffer_[head & kMask] = value;
+    this->head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Take the oldest value. Consumer side only.
+   *
+   * @param value set if the queue was not empty
+   * @return true if a value was popped
+   * @return false if the queue was empty
+   */
+  bool pop(T& value) noexcept {
+    const size_t tail = this->tail_.load(std::memory_order_relaxed);
+    if (tail == this->headCache_) {
+      this->headCache_ = this->head_.load(std::memory_order_acquire);
+      if (tail == this->headCache_) return false;
+    }
+    value = this->buffer_[tail & kMask];
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Approximate number of queued values.
+   *
+   * @return size_t
+   */
+  size_t size() const noexcept {
+    return this->head_.load(std::memory_order_acquire) -
+           this->tail_.load(std::memory_order_acquire);
+  }
+
+  bool empty() const noexcept { return this->size() == 0; }
+
+  static constexpr size_t capacity() noexcept { return Capacity; }
+
+ private:
+  static constexpr size_t kMask = Capacity - 1;
+
+  // Producer and consumer indices on their own cache lines to avoid false
+  // sharing. Each side caches the other's index to touch it only when needed.
+  alignas(64) std::atomic<size_t> head_;
+  size_t tailCache_;
+  alignas(64) std::atomic<size_t> tail_;
+  size_t headCache_;
+  alignas(64) std::array<T, Capacity> buffer_;
+};
+
+}  // namespace utils
+}  // namespace motor_controllers
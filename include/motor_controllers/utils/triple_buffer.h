@@ -0,0 +1,82 @@
+/**
+ * @file triple_buffer.h
+ * @author Pierre Venet
+ * @brief Lock-free mailbox holding the latest value written.
+ * @version 0.1
+ * @date 2021-06-09
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+#include <array>    // std::array
+#include <atomic>   // std::atomic
+#include <cstdint>  // uint8_t
+
+namespace motor_controllers {
+namespace utils {
+
+/**
+ * @brief Mailbox between one writer thread and one reader thread, where the
+ * reader only cares about the latest value.
+ *
+ * The writer fills its own buffer and swaps it with the middle one, the reader
+ * swaps the middle buffer with its own when it was written since the last
+ * read. Both sides are a copy and an atomic exchange: neither ever waits for
+ * the other, and intermediate values are overwritten rather than queued.
+ *
+ * @tparam T the value type, copied in and out
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() : back_(0), middle_(1), front_(2) {}
+
+  TripleBuffer(const TripleBuffer&) = delete;
+
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+ public:
+  /**
+   * @brief Publish a value, to be called by the writer thread only.
+   *
+   * @param value
+   */
+  void write(const T& value) noexcept {
+    this->buffers_[this->back_] = value;
+    const uint8_t previous = this->middle_.exchange(
+        this->back_ | kDirty, std::memory_order_acq_rel);
+    this->back_ = previous & kIndex;
+  }
+
+  /**
+   * @brief Take the latest value, to be called by the reader thread only.
+   *
+   * @param value set when a value was written since the last read
+   * @return true if there was a new value
+   */
+  bool read(T& value) noexcept {
+    if (!(this->middle_.load(std::memory_order_relaxed) & kDirty)) {
+      return false;
+    }
+    const uint8_t previous =
+        this->middle_.exchange(this->front_, std::memory_order_acq_rel);
+    this->front_ = previous & kIndex;
+    value = this->buffers_[this->front_];
+    return true;
+  }
+
+ private:
+  static constexpr uint8_t kIndex = 0x3;
+  static constexpr uint8_t kDirty = 0x4;
+
+ private:
+  std::array<T, 3> buffers_;
+  uint8_t back_;                 // owned by the writer
+  std::atomic<uint8_t> middle_;  // index of the shared buffer and dirty flag
+  uint8_t front_;                // owned by the reader
+};
+
+}  // namespace utils
+}  // namespace motor_controllers
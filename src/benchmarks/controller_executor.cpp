@@ -0,0 +1,187 @@
+/**
+ * @file controller_executor.cpp
+ * @author Pierre Venet
+ * @brief Compare controlling N motors with one thread each and with a
+ * ControllerExecutor, the controllers behind IController or inlined.
+ * @version 0.1
+ * @date 2021-06-05
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <motor_controllers/communication/simulated/simulated_interface.h>
+#include <motor_controllers/motor/controller_executor.h>
+#include <motor_controllers/motor/dc_motor.h>
+#include <sys/resource.h>  // getrusage
+
+#include <chrono>       // std::chrono
+#include <iostream>     // std::cout, std::endl
+#include <memory>       // std::make_unique
+#include <string>       // std::stoi
+#include <thread>       // std::this_thread::sleep_for
+#include <type_traits>  // std::is_same_v
+#include <vector>       // std::vector
+
+using namespace motor_controllers::communication;
+using motor_controllers::controller::ControllerParameters;
+using motor_controllers::controller::PIController;
+using motor_controllers::encoder::DecodingMode;
+using motor_controllers::encoder::Encoder;
+using motor_controllers::motor::BasicControllerExecutor;
+using motor_controllers::motor::BasicDCMotor;
+using motor_controllers::motor::ControllerExecutor;
+using motor_controllers::motor::DCMotor;
+
+struct Usage {
+  double cpu;
+  long contextSwitches;
+};
+
+static Usage usage() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return {usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+              (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6,
+          usage.ru_nvcsw + usage.ru_nivcsw};
+}
+
+/**
+ * @brief Motors on the channels of a simulated interface which is not started:
+ * the writes only store the duty cycles and the encoders see no edge.
+ *
+ */
+template <class Motor>
+static std::vector<std::unique_ptr<Motor>> makeMotors(
+    SimulatedInterface& interface, int n, std::chrono::microseconds dt) {
+  std::vector<std::unique_ptr<Motor>> motors;
+  for (int i = 0; i < n; ++i) {
+    const uint8_t pin = static_cast<uint8_t>(5 * i);
+
+    typename Motor::Configuration conf;
+    conf.pwmChannel = interface.configureChannel(
+        SimulatedPWMChannel::Configuration{.pinNumber = pin});
+    for (uint8_t j = 1; j <= 2; ++j) {
+      conf.directionControl.emplace_back(interface.configureChannel(
+          SimulatedBinaryChannel::Configuration{
+              .pinNumber = static_cast<uint8_t>(pin + j),
+              .channelMode = ChannelMode::OUTPUT}));
+    }
+    conf.forwardConfiguration = {BinarySignal::BINARY_HIGH,
+                                 BinarySignal::BINARY_LOW};
+    conf.backwardConfiguration = {BinarySignal::BINARY_LOW,
+                                  BinarySignal::BINARY_HIGH};
+    conf.stopConfiguration = {BinarySignal::BINARY_LOW,
+                              BinarySignal::BINARY_LOW};
+
+    SimulatedBinaryChannel::Configuration encoderConf = {
+        .pinNumber = static_cast<uint8_t>(pin + 3),
+        .channelMode = ChannelMode::EVENT_DETECT,
+        .eventDetectValue = EventDetectType::EVENT_BOTH_EDGES};
+    auto channelA = interface.configureChannel(encoderConf);
+    encoderConf.pinNumber = static_cast<uint8_t>(pin + 4);
+    auto channelB = interface.configureChannel(encoderConf);
+    conf.encoder = std::make_unique<Encoder>(std::move(channelA),
+                                             std::move(channelB), 13);
+    conf.encoder->setDecodingMode(DecodingMode::BLOCKING);
+    conf.encoderSamplingFrequency = 100;
+
+    conf.minDutyCycle = 0.1;
+    conf.maxSpeed = 8000.0 / 60.0;
+    conf.dt = dt;
+
+    ControllerParameters parameters;
+    parameters.Kp = 1.0;
+    parameters.Ki = 0.5;
+    parameters.outputMin = -conf.maxSpeed;
+    parameters.outputMax = conf.maxSpeed;
+    if constexpr (std::is_same_v<Motor, DCMotor>) {
+      conf.Kp = parameters.Kp;
+      conf.Ki = parameters.Ki;
+      motors.push_back(std::make_unique<Motor>(conf));
+    } else {
+      motors.push_back(std::make_unique<Motor>(
+          conf, PIController(parameters)));
+    }
+    motors.back()->setSpeed(10.0);
+  }
+  return motors;
+}
+
+template <class Motor, class Start, class Stop>
+void run(const std::string& name, int numMotors, std::chrono::microseconds dt,
+         std::chrono::seconds duration, Start start, Stop stop) {
+  SimulatedInterface interface;
+  std::vector<std::unique_ptr<Motor>> motors =
+      makeMotors<Motor>(interface, numMotors, dt);
+
+  start(motors);
+  const Usage begin = usage();
+  std::this_thread::sleep_for(duration);
+  const Usage end = usage();
+  const DCMotor::Statistics statistics = stop(motors);
+
+  const double seconds = std::chrono::duration<double>(duration).count();
+  std::cout << name << ": " << (end.cpu - begin.cpu) / seconds * 100.0
+            << " % CPU, "
+            << (end.contextSwitches - begin.contextSwitches) / seconds
+            << " context switches/s, wake up lateness median "
+            << statistics.wakeUpLateness.percentile(50).count() << " ns, 99% "
+            << statistics.wakeUpLateness.percentile(99).count()
+            << " ns, compute median "
+            << statistics.computeTime.percentile(50).count() << " ns"
+            << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  int numMotors = 6;
+  std::chrono::microseconds dt(1000);
+  std::chrono::seconds duration(3);
+  if (argc > 1) numMotors = std::stoi(argv[1]);
+  if (argc > 2) dt = std::chrono::microseconds(std::stoi(argv[2]));
+  if (argc > 3) duration = std::chrono::seconds(std::stoi(argv[3]));
+
+  std::cout << numMotors << " motors, dt = " << dt.count() << " us"
+            << std::endl;
+
+  run<DCMotor>(
+      "  one thread per motor    ", numMotors, dt, duration,
+      [](std::vector<DCMotor::Ref>& motors) {
+        for (auto& motor : motors) motor->start();
+      },
+      [](std::vector<DCMotor::Ref>& motors) {
+        for (auto& motor : motors) motor->stop();
+        // Lateness of the first one, they all look alike
+        return motors.front()->getStatistics();
+      });
+
+  ControllerExecutor executor(dt);
+  run<DCMotor>("  ControllerExecutor      ", numMotors, dt, duration,
+               [&executor](std::vector<DCMotor::Ref>& motors) {
+                 for (auto& motor : motors) executor.add(*motor);
+                 executor.start();
+               },
+               [&executor](std::vector<DCMotor::Ref>&) {
+                 executor.stop();
+                 return executor.getStatistics();
+               });
+
+  // Same motors, with the PI controller and the channels known at compile
+  // time: the tick inlines the updates over the array of controllers.
+  typedef BasicDCMotor<PIController, SimulatedPWMChannelRef,
+                       SimulatedBinaryChannelRef>
+      StaticMotor;
+  BasicControllerExecutor<PIController, SimulatedPWMChannelRef,
+                          SimulatedBinaryChannelRef>
+      staticExecutor(dt);
+  run<StaticMotor>("  BasicControllerExecutor ", numMotors, dt, duration,
+                   [&](std::vector<std::unique_ptr<StaticMotor>>& motors) {
+                     for (auto& motor : motors) staticExecutor.add(*motor);
+                     staticExecutor.start();
+                   },
+                   [&](std::vector<std::unique_ptr<StaticMotor>>&) {
+                     staticExecutor.stop();
+                     return staticExecutor.getStatistics();
+                   });
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file controller_step.cpp
+ * @author Pierre Venet
+ * @brief Cost of a controller update, as a compile-time policy and behind the
+ * IController interface.
+ * @version 0.1
+ * @date 2021-06-07
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <motor_controllers/controller/i_controller.h>
+#include <motor_controllers/controller/pid_controller.h>
+
+#include <chrono>    // std::chrono
+#include <cmath>     // std::sin
+#include <iostream>  // std::cout, std::endl
+#include <memory>    // std::make_unique
+#include <string>    // std::stoi
+#include <vector>    // std::vector
+
+using namespace motor_controllers::controller;
+typedef std::chrono::steady_clock clock_;
+
+static ControllerParameters parameters() {
+  ControllerParameters parameters;
+  parameters.Kp = 1.0;
+  parameters.Ki = 0.5;
+  parameters.Kd = 0.01;
+  parameters.derivativeTimeConstant = 0.005;
+  parameters.outputMin = -100.0;
+  parameters.outputMax = 100.0;
+  return parameters;
+}
+
+template <class Update>
+void run(const std::string& name, const std::vector<double>& measurements,
+         Update update) {
+  double sum = 0.0;  // keeps the updates from being optimized out
+  const auto begin = clock_::now();
+  for (double measurement : measurements) {
+    sum += update(50.0, measurement);
+  }
+  const double seconds =
+      std::chrono::duration<double>(clock_::now() - begin).count();
+  std::cout << name << ": " << seconds / measurements.size() * 1e9
+            << " ns/update (" << sum << ")" << std::endl;
+}
+
+template <class Policy>
+void runPolicy(const std::string& name,
+               const std::vector<double>& measurements) {
+  Policy policy(parameters());
+  policy.reset(std::chrono::microseconds(1000));
+  run(name + ", policy     ", measurements,
+      [&policy](double target, double measurement) {
+        return policy.update(target, measurement);
+      });
+
+  IController::Ref controller =
+      std::make_unique<PolicyController<Policy>>(Policy(parameters()));
+  controller->reset(std::chrono::microseconds(1000));
+  run(name + ", IController", measurements,
+      [&controller](double target, double measurement) {
+        return controller->update(target, measurement);
+      });
+}
+
+int main(int argc, char* argv[]) {
+  int updates = 10000000;
+  if (argc > 1) updates = std::stoi(argv[1]);
+
+  std::vector<double> measurements(updates);
+  for (int i = 0; i < updates; ++i) {
+    measurements[i] = 50.0 + 10.0 * std::sin(i * 1e-3);
+  }
+
+  runPolicy<PController>("P  ", measurements);
+  runPolicy<PIController>("PI ", measurements);
+  runPolicy<PIDController>("PID", measurements);
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file edge_event_stream.cpp
+ * @author Pierre Venet
+ * @brief Compare reading edges with one std::async per edge and with a long
+ * lived EdgeEventStream.
+ * @version 0.1
+ * @date 2021-05-25
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <motor_controllers/communication/queued_edge_event_stream.h>
+#include <sys/resource.h>  // getrusage
+
+#include <chrono>    // std::chrono
+#include <future>    // std::async
+#include <iostream>  // std::cout, std::endl
+#include <string>    // std::stoi
+#include <thread>    // std::thread
+
+using motor_controllers::communication::BinarySignal;
+using motor_controllers::communication::EdgeEvent;
+using motor_controllers::communication::QueuedEdgeEventStream;
+typedef std::chrono::steady_clock clock_;
+
+static double cpuSeconds() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+/**
+ * @brief Feed edges at the given rate, as a backend would.
+ *
+ */
+static std::thread produce(QueuedEdgeEventStream& stream, int edges,
+                           std::chrono::nanoseconds period) {
+  return std::thread([&stream, edges, period]() {
+    auto next = clock_::now();
+    for (int i = 0; i < edges; ++i) {
+      next += period;
+      std::this_thread::sleep_until(next);
+      while (!stream.publish({static_cast<BinarySignal>(i & 1), next}))
+        ;  // never drop in the benchmark
+    }
+  });
+}
+
+template <class Reader>
+void run(const std::string& name, int edges, std::chrono::nanoseconds period,
+         Reader read) {
+  QueuedEdgeEventStream stream;
+  const double cpuStart = cpuSeconds();
+  const auto start = clock_::now();
+
+  std::thread producer = produce(stream, edges, period);
+  std::chrono::nanoseconds totalLatency(0);
+  for (int i = 0; i < edges; ++i) {
+    const EdgeEvent event = read(stream);
+    totalLatency += clock_::now() - event.timestamp;
+  }
+  producer.join();
+
+  const double seconds =
+      std::chrono::duration<double>(clock_::now() - start).count();
+  std::cout << name << ": " << edges / seconds << " edges/s, "
+            << (cpuSeconds() - cpuStart) / edges * 1e9 << " ns CPU/edge, "
+            << totalLatency.count() / edges << " ns mean latency" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  int edges = 20000;
+  // 13 CPR x 4 edges at 8000 rpm is ~7000 edges/s
+  std::chrono::nanoseconds period(140000);
+  if (argc > 1) edges = std::stoi(argv[1]);
+  if (argc > 2) period = std::chrono::nanoseconds(std::stoi(argv[2]));
+
+  run("std::async per edge", edges, period, [](QueuedEdgeEventStream& stream) {
+    // What the encoder used to do: one future, hence one thread, per edge.
+    return std::async(std::launch::async, [&stream]() {
+             EdgeEvent event;
+             while (!stream.waitNext(event, std::chrono::milliseconds(100)))
+               ;
+             return event;
+           })
+        .get();
+  });
+
+  run("EdgeEventStream    ", edges, period, [](QueuedEdgeEventStream& stream) {
+    EdgeEvent event;
+    while (!stream.waitNext(event, std::chrono::milliseconds(100)))
+      ;
+    return event;
+  });
+
+  return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file encoder_service.cpp
+ * @author Pierre Venet
+ * @brief Compare decoding N quadrature encoders with one thread each and with
+ * an EncoderService.
+ * @version 0.1
+ * @date 2021-05-27
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <motor_controllers/communication/queued_edge_event_stream.h>
+#include <motor_controllers/encoder/encoder.h>
+#include <motor_controllers/encoder/encoder_service.h>
+#include <sys/resource.h>  // getrusage
+#include <time.h>          // clock_gettime
+
+#include <chrono>     // std::chrono
+#include <iostream>   // std::cout, std::endl
+#include <memory>     // std::unique_ptr
+#include <stdexcept>  // std::runtime_error
+#include <string>     // std::stoi
+#include <thread>     // std::thread
+#include <vector>     // std::vector
+
+using namespace motor_controllers::communication;
+using motor_controllers::encoder::DecodingMode;
+using motor_controllers::encoder::Encoder;
+using motor_controllers::encoder::EncoderService;
+typedef std::chrono::steady_clock clock_;
+
+static double cpuSeconds() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+static double threadCpuSeconds() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Channel fed by the benchmark instead of a backend.
+ *
+ */
+class FeedChannel : public IBinarySignalChannel {
+ public:
+  FeedChannel() : IBinarySignalChannel(ChannelMode::EVENT_DETECT) {}
+
+  void set(const BinarySignal&) override {}
+
+  BinarySignal get() override { return BinarySignal::BINARY_LOW; }
+
+  std::future<BinarySignal> asyncDetectEvent() override {
+    throw std::runtime_error("Not supported");
+  }
+
+  std::future<EdgeEvent> asyncDetectEdgeEvent() override {
+    throw std::runtime_error("Not supported");
+  }
+
+  EdgeEventStream::Ref subscribeEdgeEvents() override {
+    this->stream_ = new QueuedEdgeEventStream();
+    return EdgeEventStream::Ref(this->stream_);
+  }
+
+  void onDetectEvent(const std::function<void(BinarySignal)>&) override {
+    throw std::runtime_error("Not supported");
+  }
+
+  void interuptEventDetection() override {}
+
+  void publish(const EdgeEvent& event) {
+    while (!this->stream_->publish(event)) std::this_thread::yield();
+  }
+
+ private:
+  QueuedEdgeEventStream* stream_ = nullptr;  // owned by the subscriber
+};
+
+struct Wheel {
+  FeedChannel *a, *b;
+  Encoder::Ref encoder;
+};
+
+static std::vector<Wheel> makeWheels(int n) {
+  std::vector<Wheel> wheels;
+  for (int i = 0; i < n; ++i) {
+    Wheel wheel;
+    wheel.a = new FeedChannel();
+    wheel.b = new FeedChannel();
+    wheel.encoder.reset(new Encoder(
+        IBinarySignalChannel::Ref(wheel.a, [](IBinarySignalChannel* c) {
+          delete c;
+        }),
+        IBinarySignalChannel::Ref(wheel.b,
+                                  [](IBinarySignalChannel* c) { delete c; }),
+        13));
+    wheel.encoder->setDecodingMode(DecodingMode::BLOCKING);
+    wheels.push_back(std::move(wheel));
+  }
+  return wheels;
+}
+
+/**
+ * @brief Feed forward quadrature edges to every wheel, as a single backend
+ * thread would. A period of 0 produces as fast as possible.
+ *
+ * @return the CPU time of the producer
+ */
+static double produce(std::vector<Wheel>& wheels, int edges,
+                      std::chrono::nanoseconds period) {
+  const double cpuStart = threadCpuSeconds();
+  auto next = clock_::now();
+  for (int i = 0; i < edges; ++i) {
+    if (period.count() > 0) {
+      next += period;
+      std::this_thread::sleep_until(next);
+    } else {
+      next = clock_::now();
+    }
+    // A and B toggle in turn: 00, 10, 11, 01, ...
+    const BinarySignal level = static_cast<BinarySignal>(((i + 1) / 2) & 1);
+    for (auto& wheel : wheels) {
+      ((i & 1) ? wheel.b : wheel.a)->publish({level, next});
+    }
+  }
+  return threadCpuSeconds() - cpuStart;
+}
+
+template <class Start, class Stop>
+void run(const std::string& name, int numEncoders, int edges,
+         std::chrono::nanoseconds period, Start start, Stop stop) {
+  std::vector<Wheel> wheels = makeWheels(numEncoders);
+  start(wheels);
+
+  const double cpuStart = cpuSeconds();
+  const auto begin = clock_::now();
+  const double producerCpu = produce(wheels, edges, period);
+
+  // Wait for the decoders to catch up
+  for (auto& wheel : wheels) {
+    while (wheel.encoder->getCount() < static_cast<ulong>(edges)) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+  const double seconds =
+      std::chrono::duration<double>(clock_::now() - begin).count();
+  const double decodingCpu = cpuSeconds() - cpuStart - producerCpu;
+  stop(wheels);
+
+  const double total = static_cast<double>(edges) * numEncoders;
+  std::cout << name << ": " << total / seconds << " edges/s, "
+            << decodingCpu / seconds * 100.0 << " % CPU, "
+            << decodingCpu / total * 1e9 << " ns CPU/edge" << std::endl;
+}
+
+static void runAll(const std::string& title, int numEncoders, int edges,
+                   std::chrono::nanoseconds period) {
+  std::cout << title << std::endl;
+
+  run("  one thread per encoder ", numEncoders, edges, period,
+      [](std::vector<Wheel>& wheels) {
+        for (auto& wheel : wheels) wheel.encoder->start(100);
+      },
+      [](std::vector<Wheel>& wheels) {
+        for (auto& wheel : wheels) wheel.encoder->stop();
+      });
+
+  for (unsigned int threads : {1u, 2u}) {
+    EncoderService service(threads);
+    run("  EncoderService, " + std::to_string(threads) + " thread(s)",
+        numEncoders, edges, period,
+        [&service](std::vector<Wheel>& wheels) {
+          for (auto& wheel : wheels) service.add(*wheel.encoder);
+          service.start(100);
+        },
+        [&service](std::vector<Wheel>&) { service.stop(); });
+  }
+}
+
+int main(int argc, char* argv[]) {
+  int numEncoders = 4;
+  int edges = 20000;
+  // 13 CPR x 4 edges at 8000 rpm is ~7000 edges/s per encoder
+  std::chrono::nanoseconds period(140000);
+  if (argc > 1) numEncoders = std::stoi(argv[1]);
+  if (argc > 2) edges = std::stoi(argv[2]);
+  if (argc > 3) period = std::chrono::nanoseconds(std::stoi(argv[3]));
+
+  runAll("Paced edges, decoding CPU usage:", numEncoders, edges, period);
+  runAll("Saturated, max edge rate:", numEncoders, edges,
+         std::chrono::nanoseconds(0));
+
+  return 0;
+}
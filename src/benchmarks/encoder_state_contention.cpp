@@ -0,0 +1,127 @@
+/**
+ * @file encoder_state_contention.cpp
+ * @author Pierre Venet
+ * @brief Compare the mutex and the seqlock publication of the encoder state
+ * when several readers poll it.
+ * @version 0.1
+ * @date 2021-05-23
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <motor_controllers/encoder/encoder.h>
+#include <motor_controllers/utils/seqlock.h>
+
+#include <algorithm>  // std::max
+#include <atomic>     // std::atomic
+#include <chrono>     // std::chrono
+#include <iostream>   // std::cout, std::endl
+#include <mutex>      // std::mutex, std::lock_guard
+#include <string>     // std::stoi
+#include <thread>     // std::thread
+#include <vector>     // std::vector
+
+using motor_controllers::encoder::Direction;
+using motor_controllers::encoder::EncoderState;
+typedef std::chrono::steady_clock clock_;
+
+/**
+ * @brief The state publication as it was done before: one mutex for all.
+ *
+ */
+class MutexState {
+ public:
+  void store(const EncoderState& state) {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    this->state_ = state;
+  }
+
+  EncoderState load() const {
+    std::lock_guard<std::mutex> lock(this->mtx_);
+    return this->state_;
+  }
+
+ private:
+  mutable std::mutex mtx_;
+  EncoderState state_;
+};
+
+struct Result {
+  double writesPerSecond;
+  double worstWriteNs;
+  double readsPerSecond;
+  unsigned long tornReads;
+};
+
+template <class Publisher>
+Result run(int readers, std::chrono::milliseconds duration) {
+  Publisher publisher;
+  std::atomic<bool> running(true);
+  std::atomic<unsigned long> reads(0), torn(0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < readers; ++i) {
+    threads.emplace_back([&]() {
+      unsigned long localReads = 0, localTorn = 0;
+      while (running.load(std::memory_order_relaxed)) {
+        const EncoderState state = publisher.load();
+        // The writer keeps speed == count, anything else is a torn read.
+        if (static_cast<ulong>(state.speed) != state.count) ++localTorn;
+        ++localReads;
+      }
+      reads += localReads;
+      torn += localTorn;
+    });
+  }
+
+  // The writer plays the role of the estimation thread.
+  unsigned long writes = 0;
+  clock_::duration worst(0);
+  EncoderState state;
+  const auto start = clock_::now();
+  auto now = start;
+  while (now - start < duration) {
+    ++state.count;
+    state.speed = static_cast<float>(state.count % (1 << 20));
+    state.count = static_cast<ulong>(state.speed);
+    state.direction = (state.count & 1) ? Direction::FORWARD
+                                        : Direction::BACKWARD;
+    publisher.store(state);
+    const auto after = clock_::now();
+    worst = std::max(worst, after - now);
+    now = after;
+    ++writes;
+  }
+  running = false;
+  for (auto& thread : threads) thread.join();
+
+  const double seconds = std::chrono::duration<double>(now - start).count();
+  return {writes / seconds,
+          static_cast<double>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(worst)
+                  .count()),
+          reads / seconds, torn.load()};
+}
+
+void print(const std::string& name, const Result& result) {
+  std::cout << name << ": " << result.writesPerSecond << " writes/s, worst "
+            << result.worstWriteNs << " ns, " << result.readsPerSecond
+            << " reads/s, " << result.tornReads << " torn reads" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  int maxReaders = 4;
+  std::chrono::milliseconds duration(1000);
+  if (argc > 1) maxReaders = std::stoi(argv[1]);
+  if (argc > 2) duration = std::chrono::milliseconds(std::stoi(argv[2]));
+
+  for (int readers = 1; readers <= maxReaders; readers *= 2) {
+    std::cout << "--- " << readers << " reader(s)" << std::endl;
+    print("mutex  ", run<MutexState>(readers, duration));
+    print("seqlock",
+          run<motor_controllers::utils::SeqLock<EncoderState>>(readers,
+                                                                duration));
+  }
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file fixed_point.cpp
+ * @author Pierre Venet
+ * @brief Cost and error of the fixed-point speed estimation and control,
+ * compared with the floating-point ones.
+ * @version 0.1
+ * @date 2021-06-15
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <motor_controllers/controller/fixed_pid_controller.h>
+#include <motor_controllers/controller/pid_controller.h>
+#include <motor_controllers/encoder/estimators/fixed_point_window_estimator.h>
+#include <motor_controllers/encoder/estimators/fixed_window_estimator.h>
+#include <motor_controllers/utils/fixed_point.h>
+
+#include <algorithm>  // std::max, std::min
+#include <chrono>     // std::chrono
+#include <cmath>      // std::abs, std::sin, std::floor, std::lround
+#include <cstdint>    // int32_t, int64_t
+#include <iostream>   // std::cout, std::endl
+#include <string>     // std::stoi
+#include <vector>     // std::vector
+
+using namespace motor_controllers;
+typedef std::chrono::steady_clock clock_;
+
+// 13 CPR quadrature encoder, 4096 counts PWM, as a PCA9685
+static constexpr float kEdgesPerRevolution = 13 * 4;
+static constexpr int32_t kFullScale = 4096;
+static constexpr double kMaxSpeed = 100.0;  // rotations per second
+static constexpr double kMinDutyCycle = 0.1;
+static constexpr double kPeriod = 1e-3;  // s
+
+static controller::ControllerParameters parameters() {
+  controller::ControllerParameters parameters;
+  parameters.Kp = 0.8;
+  parameters.Ki = 20.0;
+  parameters.outputMin = -kMaxSpeed;
+  parameters.outputMax = kMaxSpeed;
+  return parameters;
+}
+
+static double speedAt(int i) { return 50.0 + 40.0 * std::sin(i * 1e-3); }
+
+static double nsPer(clock_::duration duration, int count) {
+  return std::chrono::duration<double, std::nano>(duration).count() / count;
+}
+
+/**
+ * @brief One window of edges per period, at the speed of speedAt.
+ *
+ */
+static void compareEstimators(int windows) {
+  std::vector<std::vector<clock_::time_point>> edges(windows);
+  std::vector<clock_::time_point> ends(windows);
+  const clock_::time_point start;
+  double position = 0.0;  // in edges
+  for (int i = 0; i < windows; ++i) {
+    const double rate = speedAt(i) * kEdgesPerRevolution;
+    const double end = (i + 1) * kPeriod;
+    double t = i * kPeriod + (std::floor(position) + 1 - position) / rate;
+    for (; t < end; t += 1.0 / rate) {
+      edges[i].push_back(start +
+                         std::chrono::nanoseconds(std::lround(t * 1e9)));
+    }
+    position += rate * kPeriod;
+    ends[i] = start + std::chrono::nanoseconds(std::lround(end * 1e9));
+  }
+
+  std::vector<float> floating(windows), fixed(windows);
+  auto run = [&](encoder::IVelocityEstimator& estimator,
+                 std::vector<float>& speeds) {
+    estimator.reset(start, kEdgesPerRevolution);
+    clock_::duration total(0);
+    for (int i = 0; i < windows; ++i) {
+      // Only the estimate is timed, onEdge is the same store for both.
+      for (const auto& edge : edges[i]) estimator.onEdge(edge);
+      const auto begin = clock_::now();
+      speeds[i] = estimator.estimate(ends[i]);
+      total += clock_::now() - begin;
+    }
+    return nsPer(total, windows);
+  };
+
+  encoder::FixedWindowEstimator floatingEstimator;
+  encoder::FixedPointWindowEstimator fixedEstimator;
+  const double floatingNs = run(floatingEstimator, floating);
+  const double fixedNs = run(fixedEstimator, fixed);
+
+  double maxError = 0.0;
+  for (int i = 0; i < windows; ++i) {
+    maxError = std::max(maxError, double(std::abs(floating[i] - fixed[i])));
+  }
+  std::cout << "estimate, float: " << floatingNs << " ns/window" << std::endl;
+  std::cout << "estimate, Q16  : " << fixedNs << " ns/window" << std::endl;
+  std::cout << "  max difference: " << maxError << " rotations/s" << std::endl;
+}
+
+/**
+ * @brief PI update and mapping to PWM counts, as done by BasicDCMotor.
+ *
+ */
+static void compareControllers(int updates) {
+  std::vector<double> targets(updates), measurements(updates);
+  for (int i = 0; i < updates; ++i) {
+    targets[i] = speedAt(i);
+    measurements[i] = targets[i] - 1.0 + 2.0 * std::sin(i * 0.1);
+  }
+  const std::chrono::microseconds dt(1000);
+
+  std::vector<int32_t> floating(updates), fixed(updates);
+
+  controller::PIController floatingController(parameters());
+  floatingController.reset(dt);
+  const double coef = (1.0 - kMinDutyCycle) / kMaxSpeed;
+  auto begin = clock_::now();
+  for (int i = 0; i < updates; ++i) {
+    const double speed = floatingController.update(targets[i], measurements[i]);
+    const double dutyCycle = (speed < 0) ? speed * coef - kMinDutyCycle
+                                         : speed * coef + kMinDutyCycle;
+    floating[i] = static_cast<int32_t>(
+        std::min(std::max(dutyCycle, -1.0), 1.0) * kFullScale);
+  }
+  const double floatingNs = nsPer(clock_::now() - begin, updates);
+
+  // The motor reads its target and speed as doubles and converts both every
+  // period, so the conversions are timed too.
+  typedef controller::FixedPIController::Value Value;
+  controller::FixedPIController fixedController(parameters());
+  fixedController.reset(dt);
+  const int64_t countsPerSpeed =
+      std::llround(coef * kFullScale * utils::Q16::kOne);
+  const int64_t minCounts = std::lround(kMinDutyCycle * kFullScale);
+  begin = clock_::now();
+  for (int i = 0; i < updates; ++i) {
+    const Value speed = fixedController.update(
+        Value::fromDouble(targets[i]), Value::fromDouble(measurements[i]));
+    const int64_t scaled = static_cast<int64_t>(speed.raw()) * countsPerSpeed >>
+                           (2 * utils::Q16::kFractionBitCount);
+    fixed[i] = static_cast<int32_t>(std::min<int64_t>(
+        std::max<int64_t>(
+            speed.raw() < 0 ? scaled - minCounts : scaled + minCounts,
+            -kFullScale),
+        kFullScale));
+  }
+  const double fixedNs = nsPer(clock_::now() - begin, updates);
+
+  int32_t maxError = 0;
+  int64_t sum = 0;  // keeps the updates from being optimized out
+  for (int i = 0; i < updates; ++i) {
+    maxError = std::max(maxError, std::abs(floating[i] - fixed[i]));
+    sum += floating[i] + fixed[i];
+  }
+  std::cout << "PI to counts, float: " << floatingNs << " ns/update"
+            << std::endl;
+  std::cout << "PI to counts, Q16  : " << fixedNs << " ns/update" << std::endl;
+  std::cout << "  max difference: " << maxError << " counts (" << sum << ")"
+            << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  int count = 1000000;
+  if (argc > 1) count = std::stoi(argv[1]);
+
+  compareEstimators(count / 10);
+  compareControllers(count);
+
+  return 0;
+}
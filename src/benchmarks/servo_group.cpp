@@ -0,0 +1,150 @@
+/**
+ * @file servo_group.cpp
+ * @author Pierre Venet
+ * @brief Cost of a frame of N servos: computing each pulse, looking it up in
+ * the table of each servo, and interpolating the whole ServoGroup.
+ * @version 0.1
+ * @date 2021-06-17
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <motor_controllers/communication/i_batch_writer.h>
+#include <motor_controllers/communication/simulated/simulated_interface.h>
+#include <motor_controllers/motor/servo_group.h>
+#include <motor_controllers/motor/servo_motor.h>
+
+#include <chrono>    // std::chrono
+#include <cmath>     // std::cos
+#include <cstdint>   // uint64_t
+#include <iostream>  // std::cout, std::endl
+#include <string>    // std::stoi
+#include <vector>    // std::vector
+
+using namespace motor_controllers;
+using namespace motor_controllers::communication;
+typedef std::chrono::steady_clock clock_;
+
+// Servo of 0 to 180 degrees, 500 to 2500 us, on a 50 Hz, 4096 counts channel
+static constexpr double kFrequency = 50.0;
+static constexpr double kMinPulse = 500.0, kMaxPulse = 2500.0;  // us
+static constexpr double kMaxAngle = 180.0;
+
+/**
+ * @brief Counts the batches, the channels being written right away.
+ *
+ */
+class CountingBatchWriter : public IBatchWriter {
+ public:
+  void beginBatch() override {}
+  size_t flush() override {
+    ++this->flushCount;
+    return 1;
+  }
+
+  uint64_t flushCount = 0;
+};
+
+static double nsPer(clock_::duration duration, int count) {
+  return std::chrono::duration<double, std::nano>(duration).count() / count;
+}
+
+static double targetOf(size_t servo, int move) {
+  return (servo * 37 + move * 53) % 181;
+}
+
+static void compare(size_t servoCount, int frames) {
+  SimulatedInterface interface(0.0);
+  std::vector<SimulatedPWMChannel*> channels;
+  std::vector<motor::ServoMotor::Ref> servos;
+  for (size_t i = 0; i < servoCount; ++i) {
+    motor::ServoMotor::Configuration conf;
+    conf.pwmChannel = interface.configureChannel(
+        SimulatedPWMChannel::Configuration{.pinNumber = uint8_t(i)});
+    channels.push_back(
+        static_cast<SimulatedPWMChannel*>(conf.pwmChannel.get()));
+    conf.pwmFrequency = kFrequency;
+    conf.calibration = {{0.0, kMinPulse}, {kMaxAngle, kMaxPulse}};
+    servos.emplace_back(new motor::ServoMotor(conf));
+  }
+
+  // A move of 50 frames from one target to the next, smoothstep eased
+  const int framesPerMove = 50;
+  auto progressOf = [&](int frame) {
+    const float t = float(frame % framesPerMove) / (framesPerMove - 1);
+    return t * t * (3.0f - 2.0f * t);
+  };
+  auto angleOf = [&](size_t servo, int frame) {
+    const int move = frame / framesPerMove;
+    const double start = targetOf(servo, move), end = targetOf(servo, move + 1);
+    return start + (end - start) * progressOf(frame);
+  };
+
+  // Pulse computed from the calibration, for every servo and frame
+  auto begin = clock_::now();
+  for (int frame = 0; frame < frames; ++frame) {
+    for (size_t i = 0; i < servoCount; ++i) {
+      const double pulse =
+          kMinPulse + angleOf(i, frame) * (kMaxPulse - kMinPulse) / kMaxAngle;
+      channels[i]->setDutyCycle(static_cast<float>(pulse * 1e-6 * kFrequency));
+    }
+  }
+  const double computedNs = nsPer(clock_::now() - begin, frames);
+
+  // Counts looked up in the table of each servo
+  begin = clock_::now();
+  for (int frame = 0; frame < frames; ++frame) {
+    for (size_t i = 0; i < servoCount; ++i) {
+      servos[i]->setAngle(angleOf(i, frame));
+    }
+  }
+  const double tableNs = nsPer(clock_::now() - begin, frames);
+
+  // Whole group, the time of each frame given
+  CountingBatchWriter writer;
+  motor::ServoGroup group({&writer});
+  for (auto& servo : servos) group.add(*servo);
+  std::vector<double> targets(servoCount);
+  const std::chrono::microseconds moveDuration(20000 * (framesPerMove - 1));
+  const clock_::time_point start;
+  clock_::duration groupTime(0);
+  for (int frame = 0; frame < frames; ++frame) {
+    const int move = frame / framesPerMove;
+    const clock_::time_point moveStart =
+        start + move * (moveDuration + std::chrono::microseconds(20000));
+    if (frame % framesPerMove == 0) {
+      for (size_t i = 0; i < servoCount; ++i) {
+        targets[i] = targetOf(i, move + 1);
+      }
+      const auto moveBegin = clock_::now();
+      group.moveTo(targets, moveDuration, motor::ServoEasing::SMOOTH,
+                   moveStart);
+      groupTime += clock_::now() - moveBegin;
+    }
+    const clock_::time_point now =
+        moveStart +
+        std::chrono::microseconds(20000 * (frame % framesPerMove));
+    const auto frameBegin = clock_::now();
+    group.update(now);
+    groupTime += clock_::now() - frameBegin;
+  }
+  const double groupNs = nsPer(groupTime, frames);
+
+  std::cout << servoCount << " servos" << std::endl;
+  std::cout << "  computed pulses: " << computedNs << " ns/frame" << std::endl;
+  std::cout << "  servo tables   : " << tableNs << " ns/frame" << std::endl;
+  std::cout << "  servo group    : " << groupNs << " ns/frame, "
+            << double(writer.flushCount) / frames << " flush/frame"
+            << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  int frames = 100000;
+  if (argc > 1) frames = std::stoi(argv[1]);
+
+  for (size_t servoCount : {16, 64}) {
+    compare(servoCount, frames);
+  }
+
+  return 0;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file telemetry_recorder.cpp
+ * @author Pierre Venet
+ * @brief Cost of recording a control period in the memory-mapped telemetry.
+ * @version 0.1
+ * @date 2021-06-14
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <motor_controllers/motor/telemetry_recorder.h>
+
+#include <chrono>    // std::chrono
+#include <cstdio>    // std::remove
+#include <iostream>  // std::cout, std::endl
+#include <string>    // std::stoi
+
+using namespace motor_controllers::motor;
+typedef std::chrono::steady_clock clock_;
+
+int main(int argc, char* argv[]) {
+  int records = 10000000;
+  if (argc > 1) records = std::stoi(argv[1]);
+  const std::string path = (argc > 2) ? argv[2] : "/tmp/telemetry.bin";
+
+  {
+    // One minute at 1 kHz
+    TelemetryRecorder recorder(path, 60000);
+
+    const auto begin = clock_::now();
+    for (int i = 0; i < records; ++i) {
+      recorder.record(TelemetryRecord{i, 50.0, 49.0 + i * 1e-6, 1.0 - i * 1e-6,
+                                      0.1, 0.5});
+    }
+    const double seconds =
+        std::chrono::duration<double>(clock_::now() - begin).count();
+    std::cout << "record: " << seconds / records * 1e9 << " ns ("
+              << recorder.getWriteIndex() << " records)" << std::endl;
+  }
+
+  std::remove(path.c_str());
+  return 0;
+}
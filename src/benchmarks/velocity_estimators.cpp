@@ -0,0 +1,130 @@
+/**
+ * @file velocity_estimators.cpp
+ * @author Pierre Venet
+ * @brief Compare the cost per edge and the tracking error of the velocity
+ * estimators on a synthetic speed profile.
+ * @version 0.1
+ * @date 2021-05-28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#include <motor_controllers/encoder/estimators/edge_period_estimator.h>
+#include <motor_controllers/encoder/estimators/fixed_window_estimator.h>
+#include <motor_controllers/encoder/estimators/kalman_estimator.h>
+#include <motor_controllers/encoder/estimators/pll_estimator.h>
+
+#include <chrono>    // std::chrono
+#include <cmath>     // std::sin, std::sqrt, std::floor
+#include <iostream>  // std::cout, std::endl
+#include <random>    // std::mt19937, std::normal_distribution
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+using namespace motor_controllers::encoder;
+typedef std::chrono::steady_clock clock_;
+
+// 13 CPR quadrature encoder
+static constexpr float kEdgesPerRevolution = 13 * 4;
+static constexpr double kDuration = 5.0;        // s
+static constexpr double kSamplingPeriod = 0.01;  // s
+
+/**
+ * @brief Speed of the shaft in rotations per second.
+ *
+ * Stopped, ramp up, constant, slow sine, ramp down, stopped.
+ *
+ */
+static double trueSpeed(double t) {
+  if (t < 0.5) return 0.0;
+  if (t < 1.0) return (t - 0.5) / 0.5 * 50.0;
+  if (t < 2.0) return 50.0;
+  if (t < 2.5) return 50.0 - (t - 2.0) / 0.5 * 48.0;
+  if (t < 4.0) return 2.0 + 1.5 * std::sin(2.0 * M_PI * (t - 2.5));
+  if (t < 4.5) return 2.0 * (4.5 - t) / 0.5;
+  return 0.0;
+}
+
+/**
+ * @brief Timestamps of the edges, with some timestamping jitter.
+ *
+ */
+static std::vector<clock_::time_point> makeEdges(clock_::time_point start) {
+  std::mt19937 gen(42);
+  std::normal_distribution<double> jitter(0.0, 5e-6);  // s
+
+  std::vector<clock_::time_point> edges;
+  const double dt = 1e-6;
+  double position = 0.0;  // in edges
+  for (double t = 0.0; t < kDuration; t += dt) {
+    const double next = position + trueSpeed(t) * kEdgesPerRevolution * dt;
+    if (std::floor(next) > std::floor(position)) {
+      edges.push_back(start + std::chrono::duration_cast<clock_::duration>(
+                                  std::chrono::duration<double>(
+                                      std::max(t + jitter(gen), 0.0))));
+    }
+    position = next;
+  }
+  return edges;
+}
+
+static void run(const std::string& name, IVelocityEstimator& estimator,
+                const std::vector<clock_::time_point>& edges,
+                clock_::time_point start) {
+  // Tracking error, estimated at every sampling window
+  estimator.reset(start, kEdgesPerRevolution);
+  double sumSquares = 0.0, sumSquaresSlow = 0.0;
+  int samples = 0, samplesSlow = 0;
+  size_t edge = 0;
+  for (double t = kSamplingPeriod; t < kDuration; t += kSamplingPeriod) {
+    const auto now =
+        start + std::chrono::duration_cast<clock_::duration>(
+                    std::chrono::duration<double>(t));
+    while (edge < edges.size() && edges[edge] <= now) {
+      estimator.onEdge(edges[edge++]);
+    }
+    const double error = estimator.estimate(now) - trueSpeed(t);
+    sumSquares += error * error;
+    ++samples;
+    if (t >= 2.5 && t < 4.0) {
+      sumSquaresSlow += error * error;
+      ++samplesSlow;
+    }
+  }
+
+  // Cost per edge, replaying all the edges many times
+  const int repeats = 50;
+  const auto begin = clock_::now();
+  for (int i = 0; i < repeats; ++i) {
+    estimator.reset(start, kEdgesPerRevolution);
+    for (const auto& timestamp : edges) estimator.onEdge(timestamp);
+  }
+  const double ns =
+      std::chrono::duration<double, std::nano>(clock_::now() - begin).count() /
+      (static_cast<double>(repeats) * edges.size());
+
+  std::cout << name << ": " << ns << " ns/edge, RMS error "
+            << std::sqrt(sumSquares / samples) << " rps, at low speed "
+            << std::sqrt(sumSquaresSlow / samplesSlow) << " rps" << std::endl;
+}
+
+int main() {
+  const auto start = clock_::now();
+  const auto edges = makeEdges(start);
+  std::cout << edges.size() << " edges over " << kDuration << " s, sampled at "
+            << 1.0 / kSamplingPeriod << " Hz" << std::endl;
+
+  FixedWindowEstimator fixedWindow;
+  run("fixed window", fixedWindow, edges, start);
+
+  EdgePeriodEstimator edgePeriod;
+  run("edge period ", edgePeriod, edges, start);
+
+  PLLEstimator pll;
+  run("PLL         ", pll, edges, start);
+
+  KalmanEstimator kalman;
+  run("Kalman      ", kalman, edges, start);
+
+  return 0;
+}
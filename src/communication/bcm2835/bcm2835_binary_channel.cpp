@@ -1,18 +1,63 @@
 #include <bcm2835.h>
 #include <motor_controllers/communication/bcm2835/bcm2835_binary_channel.h>
+#include <motor_controllers/communication/queued_edge_event_stream.h>
 
+#include <chrono>  // std::chrono::steady_clock
 #include <stdexcept>
 
 namespace motor_controllers {
 
 namespace communication {
 
+/**
+ * @brief Stream fed by one polling thread for the whole subscription.
+ *
+ */
+class BCM2835EdgeEventStream : public QueuedEdgeEventStream {
+ public:
+  BCM2835EdgeEventStream(uint8_t pinNumber, std::atomic<bool>& subscribed)
+      : QueuedEdgeEventStream(),
+        pinNumber_(pinNumber),
+        subscribed_(subscribed),
+        thread_([this]() { this->poll(); }) {}
+
+  ~BCM2835EdgeEventStream() { this->cancel(); }
+
+  void cancel() override {
+    QueuedEdgeEventStream::cancel();
+    if (this->thread_.joinable()) {
+      this->thread_.join();
+      this->subscribed_ = false;
+    }
+  }
+
+ private:
+  void poll() {
+    bcm2835_gpio_set_eds(this->pinNumber_);
+    while (!this->isCancelled()) {
+      if (bcm2835_gpio_eds(this->pinNumber_)) {
+        const auto timestamp = std::chrono::steady_clock::now();
+        bcm2835_gpio_set_eds(this->pinNumber_);  // clear the flag
+        this->publish(
+            {static_cast<BinarySignal>(bcm2835_gpio_lev(this->pinNumber_)),
+             timestamp});
+      }
+    }
+  }
+
+ private:
+  const uint8_t pinNumber_;
+  std::atomic<bool>& subscribed_;
+  std::thread thread_;
+};
+
 BCM2835BinaryChannel::BCM2835BinaryChannel(const Configuration& builder)
     : IBinarySignalChannel(builder.channelMode),
       pinNumber_(builder.pinNumber),
       eventDetectValue_(builder.eventDetectValue),
       detectEventThreadAlive_(false),
-      detectEventAsyncAlive_(false) {}
+      detectEventAsyncAlive_(false),
+      subscribed_(false) {}
 
 BCM2835BinaryChannel::~BCM2835BinaryChannel() {
   if (!this->isCommunicationClosed()) {
@@ -30,7 +75,9 @@ void BCM2835BinaryChannel::set(const BinarySignal& value) {
         "BCM2835BinaryChannel: communication is closed, cannot set value");
   }
   if (this->getChannelMode() == ChannelMode::OUTPUT) {
-    this->setInternal(value);
+    if (this->commitLevel(value)) {
+      this->setInternal(value);
+    }
   } else {
     throw std::runtime_error("Cannot write on a INPUT channel");
   }
@@ -54,15 +101,31 @@ std::future<BinarySignal> BCM2835BinaryChannel::asyncDetectEvent() {
 
   this->detectEventAsyncAlive_ = true;
 
-  return std::async([this]() {
-    bcm2835_gpio_set_eds(this->pinNumber_);
-    // TODO check communication not closed in loop
-    // This makes a segfault if still opened after communication is destroyed.
-    while (!bcm2835_gpio_eds(this->pinNumber_) && this->detectEventAsyncAlive_)
-      ;
-    this->detectEventAsyncAlive_ = false;
-    return static_cast<BinarySignal>(bcm2835_gpio_lev(this->pinNumber_));
-  });
+  return std::async([this]() { return this->pollEdgeEvent().level; });
+}
+
+std::future<EdgeEvent> BCM2835BinaryChannel::asyncDetectEdgeEvent() {
+  this->detectEventAsyncAlive_ = true;
+
+  return std::async([this]() { return this->pollEdgeEvent(); });
+}
+
+EdgeEventStream::Ref BCM2835BinaryChannel::subscribeEdgeEvents() {
+  if (this->isCommunicationClosed()) {
+    throw std::runtime_error(
+        "BCM2835BinaryChannel: communication is closed, cannot detect events");
+  }
+
+  if (this->getChannelMode() != ChannelMode::EVENT_DETECT) {
+    throw std::runtime_error("Cannot subscribe to a non EVENT_DETECT channel");
+  }
+
+  if (this->detectEventThreadAlive_ || this->subscribed_.exchange(true)) {
+    throw std::runtime_error("Event detection already running on the channel");
+  }
+
+  return std::make_unique<BCM2835EdgeEventStream>(this->pinNumber_,
+                                                  this->subscribed_);
 }
 
 void BCM2835BinaryChannel::onDetectEvent(
@@ -72,8 +135,9 @@ void BCM2835BinaryChannel::onDetectEvent(
         "BCM2835BinaryChannel: communication is closed, cannot detect events");
   }
 
-  if (this->detectEventAsyncAlive_) {
-    throw std::runtime_error("Cannot run thread and async simultaneously");
+  if (this->detectEventAsyncAlive_ || this->subscribed_) {
+    throw std::runtime_error(
+        "Cannot run thread and async or subscription simultaneously");
   }
 
   if (this->detectEventThreadAlive_) {  // thread already running
@@ -93,8 +157,23 @@ void BCM2835BinaryChannel::onDetectEvent(
   });
 }
 
+EdgeEvent BCM2835BinaryChannel::pollEdgeEvent() {
+  bcm2835_gpio_set_eds(this->pinNumber_);
+  // TODO check communication not closed in loop
+  // This makes a segfault if still opened after communication is destroyed.
+  while (!bcm2835_gpio_eds(this->pinNumber_) && this->detectEventAsyncAlive_)
+    ;
+  // The chip does not timestamp the events, take the time as soon as the
+  // polling loop sees it, before the level read and the thread handoff.
+  const auto timestamp = std::chrono::steady_clock::now();
+  this->detectEventAsyncAlive_ = false;
+  return {static_cast<BinarySignal>(bcm2835_gpio_lev(this->pinNumber_)),
+          timestamp};
+}
+
 void BCM2835BinaryChannel::initialize() {
   this->clean();
+  this->invalidateLevel();
 
   if (this->getChannelMode() == ChannelMode::INPUT) {
     this->setupInput();
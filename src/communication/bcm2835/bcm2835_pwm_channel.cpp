@@ -33,13 +33,20 @@ void BCM2835PWMChannel::setPWM(float, float) {
 }
 
 void BCM2835PWMChannel::setDutyCycle(float dutyCycle) {
+  dutyCycle = std::max(std::min(dutyCycle, 1.0f), 0.0f);
+  this->setRawDutyCycle(static_cast<uint32_t>(dutyCycle * this->range_));
+}
+
+void BCM2835PWMChannel::setRawDutyCycle(uint32_t counts) {
   if (this->isCommunicationClosed()) {
     throw std::runtime_error(
         "BCM2835PWMChannel: communication is closed, cannot set duty cycle");
   }
 
-  dutyCycle = std::max(std::min(dutyCycle, 1.0f), 0.0f);
-  bcm2835_pwm_set_data(this->pinNumber_, dutyCycle * this->range_);
+  const uint32_t data = std::min(counts, this->range_);
+  if (!this->commitValue(data)) return;
+
+  bcm2835_pwm_set_data(this->pinNumber_, data);
 }
 
 float BCM2835PWMChannel::getMinValue() const { return 0; }
@@ -50,6 +57,7 @@ void BCM2835PWMChannel::initialize() {
   bcm2835_gpio_fsel(this->pinNumber_, BCM2835_GPIO_FSEL_ALT5);
   bcm2835_pwm_set_mode(this->pwmChannel_, 1, true);
   bcm2835_pwm_set_range(this->pwmChannel_, this->range_);
+  this->invalidateValue();
 }
 
 }  // namespace communication
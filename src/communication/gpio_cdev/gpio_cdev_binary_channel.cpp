@@ -0,0 +1,149 @@
+#include <motor_controllers/communication/gpio_cdev/gpio_cdev_binary_channel.h>
+#include <linux/gpio.h>
+#include <sys/ioctl.h>
+
+#include <cerrno>    // errno
+#include <chrono>    // std::chrono
+#include <cstring>   // std::strerror
+#include <stdexcept>
+#include <string>  // std::string
+
+namespace motor_controllers {
+
+namespace communication {
+
+GpioCdevBinaryChannel::GpioCdevBinaryChannel(const Configuration& builder)
+    : QueuedBinarySignalChannel(builder.channelMode),
+      lineOffset_(builder.lineOffset),
+      eventDetectValue_(builder.eventDetectValue),
+      bias_(builder.bias),
+      requestFd_(-1),
+      mask_(0) {
+  // Fail at configuration rather than when the interface starts.
+  this->getLineFlags();
+}
+
+GpioCdevBinaryChannel::~GpioCdevBinaryChannel() {
+  if (!this->isCommunicationClosed()) {
+    if (this->getChannelMode() == ChannelMode::OUTPUT &&
+        this->requestFd_ >= 0) {
+      this->setInternal(BinarySignal::BINARY_LOW);
+    }
+    this->interuptEventDetection();
+  }
+}
+
+void GpioCdevBinaryChannel::set(const BinarySignal& value) {
+  if (this->isCommunicationClosed()) {
+    throw std::runtime_error(
+        "GpioCdevBinaryChannel: communication is closed, cannot set value");
+  }
+  if (this->getChannelMode() == ChannelMode::OUTPUT) {
+    if (this->commitLevel(value)) {
+      this->setInternal(value);
+    }
+  } else {
+    throw std::runtime_error("Cannot write on a INPUT channel");
+  }
+}
+
+BinarySignal GpioCdevBinaryChannel::get() {
+  if (this->isCommunicationClosed()) {
+    throw std::runtime_error(
+        "GpioCdevBinaryChannel: communication is closed, cannot get value");
+  }
+  if (this->requestFd_ < 0) {
+    throw std::runtime_error("GpioCdevBinaryChannel: interface not started");
+  }
+
+  // Can read whether line is input or output
+  gpio_v2_line_values values = {};
+  values.mask = this->mask_;
+  if (ioctl(this->requestFd_, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) {
+    throw std::runtime_error(std::string("Failed to read line: ") +
+                             std::strerror(errno));
+  }
+  return static_cast<BinarySignal>((values.bits & this->mask_) != 0);
+}
+
+void GpioCdevBinaryChannel::initialize(int requestFd, unsigned int index) {
+  this->requestFd_ = requestFd;
+  this->mask_ = 1ULL << index;
+  this->invalidateLevel();
+  if (this->getChannelMode() == ChannelMode::EVENT_DETECT) {
+    this->lastEvent_ = {this->get(), std::chrono::steady_clock::now()};
+  }
+}
+
+void GpioCdevBinaryChannel::clean() {
+  this->requestFd_ = -1;
+  this->mask_ = 0;
+}
+
+void GpioCdevBinaryChannel::onEdgeEvent(const EdgeEvent& event) {
+  // This runs on the interface's reader thread: never block here.
+  this->publishEdgeEvent(event);
+}
+
+uint32_t GpioCdevBinaryChannel::getLineOffset() const {
+  return this->lineOffset_;
+}
+
+uint64_t GpioCdevBinaryChannel::getLineFlags() const {
+  if (this->getChannelMode() == ChannelMode::OUTPUT) {
+    return GPIO_V2_LINE_FLAG_OUTPUT;
+  }
+
+  uint64_t flags = GPIO_V2_LINE_FLAG_INPUT;
+  switch (this->bias_) {
+    case GpioCdevBias::DISABLED:
+      flags |= GPIO_V2_LINE_FLAG_BIAS_DISABLED;
+      break;
+    case GpioCdevBias::PULL_UP:
+      flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+      break;
+    case GpioCdevBias::PULL_DOWN:
+      flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN;
+      break;
+    case GpioCdevBias::AS_IS:
+    default:
+      break;
+  }
+
+  if (this->getChannelMode() == ChannelMode::EVENT_DETECT) {
+    // The kernel only detects edges: levels are detected on the edge leading
+    // to them. The default event clock is CLOCK_MONOTONIC, the steady clock.
+    switch (this->eventDetectValue_) {
+      case EventDetectType::EVENT_HIGH:
+      case EventDetectType::EVENT_RISING_EDGE:
+        flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+        break;
+      case EventDetectType::EVENT_LOW:
+      case EventDetectType::EVENT_FALING_EDGE:
+        flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+        break;
+      case EventDetectType::EVENT_BOTH_EDGES:
+        flags |= GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+        break;
+      default:
+        throw std::runtime_error("Not supported event detect type");
+    }
+  }
+  return flags;
+}
+
+void GpioCdevBinaryChannel::setInternal(const BinarySignal& value) {
+  if (this->requestFd_ < 0) {
+    throw std::runtime_error("GpioCdevBinaryChannel: interface not started");
+  }
+  gpio_v2_line_values values = {};
+  values.mask = this->mask_;
+  values.bits = (value == BinarySignal::BINARY_HIGH) ? this->mask_ : 0;
+  if (ioctl(this->requestFd_, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) < 0) {
+    throw std::runtime_error(std::string("Failed to write line: ") +
+                             std::strerror(errno));
+  }
+}
+
+}  // namespace communication
+}  // namespace motor_controllers
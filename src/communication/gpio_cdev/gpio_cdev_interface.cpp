@@ -0,0 +1,260 @@
+#include <motor_controllers/communication/gpio_cdev/gpio_cdev_interface.h>
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>  // std::max
+#include <cerrno>     // errno
+#include <cstring>    // std::strerror, std::strncpy
+#include <stdexcept>
+
+namespace motor_controllers {
+
+namespace communication {
+
+static std::runtime_error systemError(const std::string& what) {
+  return std::runtime_error("GpioCdevInterface: " + what + ": " +
+                            std::strerror(errno));
+}
+
+GpioCdevInterface::GpioCdevInterface(const std::string& chipPath,
+                                     bool readerThread)
+    : chipPath_(chipPath),
+      useReaderThread_(readerThread),
+      running_(false),
+      requestFd_(-1),
+      epollFd_(-1),
+      stopFd_(-1) {}
+
+GpioCdevInterface::~GpioCdevInterface() { this->stop(); }
+
+void GpioCdevInterface::start() {
+  if (this->running_) return;
+
+  if (this->channels_.size() > GPIO_V2_LINES_MAX) {
+    throw std::runtime_error("GpioCdevInterface: too many lines");
+  }
+
+  if (!this->channels_.empty()) {
+    // One request for all the lines, each group of lines sharing the same
+    // flags is configured with an attribute.
+    gpio_v2_line_request request = {};
+    std::strncpy(request.consumer, "motor_controllers",
+                 GPIO_MAX_NAME_SIZE - 1);
+    request.num_lines = this->channels_.size();
+
+    uint64_t outputMask = 0;
+    bool detectsEvents = false;
+    uint32_t maxOffset = 0;
+    for (size_t i = 0; i < this->channels_.size(); ++i) {
+      const GpioCdevBinaryChannel* channel = this->channels_[i];
+      const uint64_t flags = channel->getLineFlags();
+      request.offsets[i] = channel->getLineOffset();
+      maxOffset = std::max(maxOffset, channel->getLineOffset());
+
+      if (flags & GPIO_V2_LINE_FLAG_OUTPUT) outputMask |= 1ULL << i;
+      if (flags & (GPIO_V2_LINE_FLAG_EDGE_RISING |
+                   GPIO_V2_LINE_FLAG_EDGE_FALLING)) {
+        detectsEvents = true;
+      }
+
+      uint32_t attr = 0;
+      while (attr < request.config.num_attrs &&
+             request.config.attrs[attr].attr.flags != flags) {
+        ++attr;
+      }
+      if (attr == request.config.num_attrs) {
+        // Keep the last attribute for the output values
+        if (attr >= GPIO_V2_LINE_NUM_ATTRS_MAX - 1) {
+          throw std::runtime_error(
+              "GpioCdevInterface: too many different line configurations");
+        }
+        request.config.attrs[attr].attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+        request.config.attrs[attr].attr.flags = flags;
+        ++request.config.num_attrs;
+      }
+      request.config.attrs[attr].mask |= 1ULL << i;
+    }
+
+    if (outputMask) {
+      // Outputs start LOW
+      const uint32_t attr = request.config.num_attrs++;
+      request.config.attrs[attr].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+      request.config.attrs[attr].attr.values = 0;
+      request.config.attrs[attr].mask = outputMask;
+    }
+
+    // Let the kernel buffer as many events as it allows, the reader may be
+    // late.
+    if (detectsEvents) request.event_buffer_size = GPIO_V2_LINES_MAX * 16;
+
+    const int chipFd = open(this->chipPath_.c_str(), O_RDWR | O_CLOEXEC);
+    if (chipFd < 0) throw systemError("cannot open " + this->chipPath_);
+    const int res = ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &request);
+    close(chipFd);
+    if (res < 0) throw systemError("cannot request the lines");
+
+    this->requestFd_ = request.fd;
+    fcntl(this->requestFd_, F_SETFL,
+          fcntl(this->requestFd_, F_GETFL) | O_NONBLOCK);
+
+    this->channelsByOffset_.assign(maxOffset + 1, nullptr);
+    for (size_t i = 0; i < this->channels_.size(); ++i) {
+      GpioCdevBinaryChannel* channel = this->channels_[i];
+      channel->initialize(this->requestFd_, i);
+      if (channel->getChannelMode() == ChannelMode::EVENT_DETECT) {
+        this->channelsByOffset_[channel->getLineOffset()] = channel;
+      }
+    }
+
+    if (detectsEvents && this->useReaderThread_) {
+      this->epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+      this->stopFd_ = eventfd(0, EFD_CLOEXEC);
+      if (this->epollFd_ < 0 || this->stopFd_ < 0) {
+        const std::runtime_error error = systemError("cannot create epoll");
+        this->running_ = true;
+        this->stop();
+        throw error;
+      }
+
+      epoll_event event = {};
+      event.events = EPOLLIN;
+      event.data.fd = this->requestFd_;
+      epoll_ctl(this->epollFd_, EPOLL_CTL_ADD, this->requestFd_, &event);
+      event.data.fd = this->stopFd_;
+      epoll_ctl(this->epollFd_, EPOLL_CTL_ADD, this->stopFd_, &event);
+
+      this->readerThread_ = std::thread(&GpioCdevInterface::readEvents, this);
+    }
+  }
+
+  this->running_ = true;
+}
+
+void GpioCdevInterface::stop() {
+  if (!this->running_) return;
+
+  if (this->readerThread_.joinable()) {
+    // Cannot fail: the eventfd counter is far from overflowing.
+    const uint64_t one = 1;
+    const ssize_t res = write(this->stopFd_, &one, sizeof(one));
+    (void)res;
+    this->readerThread_.join();
+  }
+  if (this->stopFd_ >= 0) close(this->stopFd_);
+  if (this->epollFd_ >= 0) close(this->epollFd_);
+  this->stopFd_ = this->epollFd_ = -1;
+
+  for (auto& channel : this->channels_) {
+    if (channel->getChannelMode() == ChannelMode::OUTPUT) {
+      channel->set(BinarySignal::BINARY_LOW);
+    } else if (channel->getChannelMode() == ChannelMode::EVENT_DETECT) {
+      channel->interuptEventDetection();
+    }
+    channel->clean();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->dispatchMutex_);
+    this->channelsByOffset_.clear();
+  }
+  if (this->requestFd_ >= 0) close(this->requestFd_);
+  this->requestFd_ = -1;
+  this->running_ = false;
+}
+
+int GpioCdevInterface::getEventFileDescriptor() const {
+  return this->requestFd_;
+}
+
+size_t GpioCdevInterface::processEvents() {
+  if (this->requestFd_ < 0) return 0;
+
+  gpio_v2_line_event events[kEventBatchSize];
+  size_t total = 0;
+  while (true) {
+    const ssize_t bytes = read(this->requestFd_, events, sizeof(events));
+    if (bytes < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+      throw systemError("cannot read the events");
+    }
+
+    const size_t count = bytes / sizeof(gpio_v2_line_event);
+    {
+      std::lock_guard<std::mutex> lock(this->dispatchMutex_);
+      for (size_t i = 0; i < count; ++i) {
+        const gpio_v2_line_event& event = events[i];
+        if (event.offset >= this->channelsByOffset_.size()) continue;
+        GpioCdevBinaryChannel* channel = this->channelsByOffset_[event.offset];
+        if (!channel) continue;
+
+        // The kernel timestamps on CLOCK_MONOTONIC, the steady clock.
+        channel->onEdgeEvent(
+            {(event.id == GPIO_V2_LINE_EVENT_RISING_EDGE)
+                 ? BinarySignal::BINARY_HIGH
+                 : BinarySignal::BINARY_LOW,
+             std::chrono::steady_clock::time_point(
+                 std::chrono::duration_cast<
+                     std::chrono::steady_clock::duration>(
+                     std::chrono::nanoseconds(event.timestamp_ns)))});
+      }
+    }
+    total += count;
+    if (count < kEventBatchSize) break;  // drained
+  }
+  return total;
+}
+
+GpioCdevBinaryChannel* GpioCdevInterface::createChannel(
+    const GpioCdevBinaryChannel::Configuration& builder) {
+  if (this->running_) {
+    throw std::runtime_error(
+        "GpioCdevInterface: channels must be configured before start");
+  }
+  return new GpioCdevBinaryChannel(builder);
+}
+
+void GpioCdevInterface::unregisterChannel(ISignalChannel* channel) {
+  // The line stays requested until stop, its events are ignored.
+  {
+    std::lock_guard<std::mutex> lock(this->dispatchMutex_);
+    for (auto& entry : this->channelsByOffset_) {
+      if (entry == channel) entry = nullptr;
+    }
+  }
+  ChannelBuilder<GpioCdevBinaryChannel,
+                 GpioCdevBinaryChannel::Configuration>::unregisterChannel(channel);
+}
+
+void GpioCdevInterface::readEvents() {
+  epoll_event ready[2];
+  while (true) {
+    const int count = epoll_wait(this->epollFd_, ready, 2, -1);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+
+    bool stopRequested = false;
+    for (int i = 0; i < count; ++i) {
+      if (ready[i].data.fd == this->stopFd_) {
+        stopRequested = true;
+      } else {
+        try {
+          this->processEvents();
+        } catch (const std::runtime_error&) {
+          // The request is unusable, the channels will not get events anymore.
+          return;
+        }
+      }
+    }
+    if (stopRequested) return;
+  }
+}
+
+}  // namespace communication
+}  // namespace motor_controllers
@@ -16,15 +16,68 @@ bool ISignalChannel::isCommunicationClosed() {
   return !this->isCommunicationOpen_;
 }
 
-IPWMSignalChannel::IPWMSignalChannel() : ISignalChannel() {}
+IPWMSignalChannel::IPWMSignalChannel()
+    : ISignalChannel(),
+      committedValue_(kUnknownValue),
+      writeCount_(0),
+      skippedWriteCount_(0) {}
+
+uint64_t IPWMSignalChannel::getWriteCount() const {
+  return this->writeCount_.load(std::memory_order_relaxed);
+}
+
+uint64_t IPWMSignalChannel::getSkippedWriteCount() const {
+  return this->skippedWriteCount_.load(std::memory_order_relaxed);
+}
+
+bool IPWMSignalChannel::commitValue(uint64_t value) {
+  if (this->committedValue_.load(std::memory_order_relaxed) == value) {
+    this->skippedWriteCount_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  this->committedValue_.store(value, std::memory_order_relaxed);
+  this->writeCount_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void IPWMSignalChannel::invalidateValue() {
+  this->committedValue_.store(kUnknownValue, std::memory_order_relaxed);
+}
 
 IBinarySignalChannel::IBinarySignalChannel(const ChannelMode& mode)
-    : ISignalChannel(), channelType_(mode) {}
+    : ISignalChannel(),
+      channelType_(mode),
+      committedLevel_(kUnknownLevel),
+      writeCount_(0),
+      skippedWriteCount_(0) {}
 
 const ChannelMode& IBinarySignalChannel::getChannelMode() const {
   return this->channelType_;
 }
 
+uint64_t IBinarySignalChannel::getWriteCount() const {
+  return this->writeCount_.load(std::memory_order_relaxed);
+}
+
+uint64_t IBinarySignalChannel::getSkippedWriteCount() const {
+  return this->skippedWriteCount_.load(std::memory_order_relaxed);
+}
+
+bool IBinarySignalChannel::commitLevel(BinarySignal level) {
+  const int8_t value = static_cast<int8_t>(level);
+  if (this->committedLevel_.load(std::memory_order_relaxed) == value) {
+    this->skippedWriteCount_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  this->committedLevel_.store(value, std::memory_order_relaxed);
+  this->writeCount_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void IBinarySignalChannel::invalidateLevel() {
+  this->committedLevel_.store(kUnknownLevel, std::memory_order_relaxed);
+}
+
 }  // namespace communication
 
 }  // namespace motor_controllers
\ No newline at end of file
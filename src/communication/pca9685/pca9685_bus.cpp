@@ -0,0 +1,233 @@
+#include <fcntl.h>
+#include <unistd.h>
+extern "C" {
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+}
+#include <motor_controllers/communication/pca9685/pca9685_bus.h>
+#include <motor_controllers/communication/pca9685/pca9685_interface.h>
+#include <sys/ioctl.h>
+
+#include <algorithm>  // std::min, std::max, std::find
+#include <cerrno>     // errno
+#include <chrono>     // std::chrono
+#include <cstring>    // std::strerror
+#include <stdexcept>  // std::runtime_error
+#include <thread>     // std::this_thread
+
+#include "pca9685_registers.h"
+
+namespace motor_controllers {
+
+namespace communication {
+
+PCA9685Bus::PCA9685Bus(const std::string& port)
+    : port_(port), frameThread_(), messageCount_(0), transferCount_(0) {
+  this->file_ = open(port.c_str(), O_RDWR);
+  if (this->file_ < 0) {
+    throw std::runtime_error("Cannot open " + port + ": " +
+                             std::strerror(errno));
+  }
+}
+
+PCA9685Bus::~PCA9685Bus() { close(this->file_); }
+
+void PCA9685Bus::beginFrame() {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  if (this->frameThread_ != std::thread::id() &&
+      this->frameThread_ != std::this_thread::get_id()) {
+    throw std::runtime_error("PCA9685Bus: a frame is open on another thread");
+  }
+  this->frameThread_ = std::this_thread::get_id();
+}
+
+size_t PCA9685Bus::flush() {
+  std::string error;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    if (this->frameThread_ == std::thread::id()) return 0;
+    if (this->frameThread_ != std::this_thread::get_id()) {
+      throw std::runtime_error(
+          "PCA9685Bus: the frame was open on another thread");
+    }
+    this->frameThread_ = std::thread::id();
+    if (this->messages_.empty()) return 0;
+
+    std::vector<struct i2c_msg> messages(this->messages_.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+      const Message& message = this->messages_[i];
+      messages[i].addr = message.address;
+      messages[i].flags = 0;
+      messages[i].len = static_cast<__u16>(message.size);
+      messages[i].buf = &this->buffer_[message.offset];
+    }
+
+    try {
+      const size_t transfers = this->transfer(messages.data(), messages.size());
+      this->messages_.clear();
+      this->buffer_.clear();
+      return transfers;
+    } catch (const std::runtime_error& exception) {
+      this->messages_.clear();
+      this->buffer_.clear();
+      error = exception.what();
+    }
+  }
+
+  // The boards believe the queued registers written: their next values must
+  // be sent. The mutex of the bus comes after the ones of the boards.
+  std::lock_guard<std::mutex> lock(this->boardsMutex_);
+  for (auto& board : this->boards_) {
+    std::lock_guard<std::mutex> boardLock(board->busMutex_);
+    board->invalidateChannels();
+  }
+  throw std::runtime_error(error);
+}
+
+void PCA9685Bus::stopAll() {
+  std::lock_guard<std::mutex> lock(this->boardsMutex_);
+  std::vector<std::unique_lock<std::mutex>> boardLocks;
+  for (auto& board : this->boards_) boardLocks.emplace_back(board->busMutex_);
+
+  const uint8_t bytes[5] = {CHANNEL_ALL, 0, 0, 0, 0};
+  {
+    std::lock_guard<std::mutex> busLock(this->mutex_);
+    // The values queued in a frame are dropped, not sent after the stop.
+    this->messages_.clear();
+    this->buffer_.clear();
+    this->send(ALLCALL_ADDRESS, bytes, sizeof(bytes));
+  }
+
+  for (auto& board : this->boards_) {
+    board->onAllChannelsWritten(0);
+  }
+}
+
+void PCA9685Bus::setPWMFrequency(float frequency, float oscillatorFrequency) {
+  std::lock_guard<std::mutex> lock(this->boardsMutex_);
+  std::vector<std::unique_lock<std::mutex>> boardLocks;
+  for (auto& board : this->boards_) {
+    if (board->externalClock_) {
+      throw std::runtime_error(
+          "PCA9685Bus: the boards with an external clock must set their "
+          "frequency themselves");
+    }
+    boardLocks.emplace_back(board->busMutex_);
+  }
+
+  // Every board answering ALLCALL goes through the same sequence, see
+  // PCA9685Interface::setInternalClockFrequency.
+  const uint8_t mode = MODE1_ALLCALL_VAL | MODE1_AI_VAL;
+  const uint8_t sleep[2] = {MODE1, mode | MODE1_SLEEP_VAL};
+  const uint8_t prescale[2] = {PRE_SCALE,
+                               prescaleOf(frequency, oscillatorFrequency)};
+  const uint8_t wake[2] = {MODE1, mode};
+  const uint8_t restart[2] = {MODE1, mode | MODE1_RESTART_VAL};
+  // Sent at once, even in a frame: the oscillator needs the delay.
+  {
+    std::lock_guard<std::mutex> busLock(this->mutex_);
+    this->send(ALLCALL_ADDRESS, sleep, 2);
+    this->send(ALLCALL_ADDRESS, prescale, 2);
+    this->send(ALLCALL_ADDRESS, wake, 2);
+    // wait for the oscillator to stabilize
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    this->send(ALLCALL_ADDRESS, restart, 2);
+  }
+
+  for (auto& board : this->boards_) {
+    board->registers_[MODE1] = mode;
+    board->registers_[PRE_SCALE] = prescale[1];
+    board->knownRegisters_[MODE1] = true;
+    board->knownRegisters_[PRE_SCALE] = true;
+    board->pwmFrequency_ = frequency;
+  }
+}
+
+uint64_t PCA9685Bus::getMessageCount() const {
+  return this->messageCount_.load(std::memory_order_relaxed);
+}
+
+uint64_t PCA9685Bus::getTransferCount() const {
+  return this->transferCount_.load(std::memory_order_relaxed);
+}
+
+uint8_t PCA9685Bus::prescaleOf(float frequency, float oscillatorFrequency) {
+  frequency = std::min(std::max(1.0f, frequency), 3500.0f);
+  float prescaleValue =
+      ((oscillatorFrequency / (frequency * 4096.0)) + 0.5) - 1;
+  prescaleValue = std::min(std::max(3.0f, prescaleValue), 255.0f);
+  return static_cast<uint8_t>(prescaleValue);
+}
+
+void PCA9685Bus::write(uint16_t address, const uint8_t* bytes, size_t size) {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+
+  if (this->frameThread_ == std::this_thread::get_id()) {
+    // The i2c_msg point in buffer_, which may still grow: built at flush().
+    this->messages_.push_back({address, this->buffer_.size(), size});
+    this->buffer_.insert(this->buffer_.end(), bytes, bytes + size);
+    return;
+  }
+
+  this->send(address, bytes, size);
+}
+
+void PCA9685Bus::send(uint16_t address, const uint8_t* bytes, size_t size) {
+  struct i2c_msg message;
+  message.addr = address;
+  message.flags = 0;
+  message.len = static_cast<__u16>(size);
+  message.buf = const_cast<uint8_t*>(bytes);  // not written by the kernel
+  this->transfer(&message, 1);
+}
+
+void PCA9685Bus::read(uint16_t address, uint8_t reg, uint8_t* values,
+                      size_t size) {
+  std::lock_guard<std::mutex> lock(this->mutex_);
+
+  // Register address, then the values after a repeated start.
+  struct i2c_msg messages[2];
+  messages[0].addr = address;
+  messages[0].flags = 0;
+  messages[0].len = 1;
+  messages[0].buf = &reg;
+  messages[1].addr = address;
+  messages[1].flags = I2C_M_RD;
+  messages[1].len = static_cast<__u16>(size);
+  messages[1].buf = values;
+  this->transfer(messages, 2);
+}
+
+size_t PCA9685Bus::transfer(struct i2c_msg* messages, size_t count) {
+  size_t transfers = 0;
+  for (size_t first = 0; first < count; first += I2C_RDWR_IOCTL_MAX_MSGS) {
+    struct i2c_rdwr_ioctl_data data;
+    data.msgs = messages + first;
+    data.nmsgs = static_cast<__u32>(
+        std::min<size_t>(count - first, I2C_RDWR_IOCTL_MAX_MSGS));
+
+    const int sent = ioctl(this->file_, I2C_RDWR, &data);
+    this->transferCount_.fetch_add(1, std::memory_order_relaxed);
+    if (sent != static_cast<int>(data.nmsgs)) {
+      throw std::runtime_error("PCA9685Bus: transfer on " + this->port_ +
+                               " failed: " + std::strerror(errno));
+    }
+    this->messageCount_.fetch_add(data.nmsgs, std::memory_order_relaxed);
+    ++transfers;
+  }
+  return transfers;
+}
+
+void PCA9685Bus::attach(PCA9685Interface* board) {
+  std::lock_guard<std::mutex> lock(this->boardsMutex_);
+  this->boards_.push_back(board);
+}
+
+void PCA9685Bus::detach(PCA9685Interface* board) {
+  std::lock_guard<std::mutex> lock(this->boardsMutex_);
+  this->boards_.erase(
+      std::find(this->boards_.begin(), this->boards_.end(), board));
+}
+
+}  // namespace communication
+}  // namespace motor_controllers
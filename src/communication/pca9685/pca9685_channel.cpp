@@ -32,13 +32,22 @@ void PCA9685Channel::setPWM(float start, float end) {
   uint16_t startVal = static_cast<uint16_t>(start);
   uint16_t endVal = static_cast<uint16_t>(end);
 
+  // Same on and off counts as in the registers: nothing to send on the bus.
+  if (!this->commitValue((uint64_t(startVal) << 16) | endVal)) return;
+
   uint8_t values[4];
   values[0] = startVal;
   values[1] = startVal >> 8;
   values[2] = endVal;
   values[3] = endVal >> 8;
 
-  this->setValue_(this->channel_, values);
+  try {
+    this->setValue_(this->channel_, values);
+  } catch (...) {
+    // Not on the chip: the next write of the value must be sent.
+    this->invalidateValue();
+    throw;
+  }
 }
 
 void PCA9685Channel::setDutyCycle(float dutyCycle) {
@@ -46,6 +55,10 @@ void PCA9685Channel::setDutyCycle(float dutyCycle) {
   this->setPWM(0, dutyCycle * this->range_);
 }
 
+void PCA9685Channel::setRawDutyCycle(uint32_t counts) {
+  this->setPWM(0, static_cast<float>(std::min<uint32_t>(counts, 0x0FFF)));
+}
+
 float PCA9685Channel::getMinValue() const { return static_cast<float>(0x0000); }
 
 float PCA9685Channel::getMaxValue() const { return static_cast<float>(0x0FFF); }
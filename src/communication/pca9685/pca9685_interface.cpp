@@ -1,137 +1,87 @@
 
-#include <fcntl.h>
-#include <unistd.h>
-extern "C" {
-#include <i2c/smbus.h>
-#include <linux/i2c-dev.h>
-}
 #include <motor_controllers/communication/pca9685/pca9685_interface.h>
-#include <sys/ioctl.h>
 
 #include <algorithm>
 #include <chrono>
+#include <cstring>  // std::memcpy
 #include <thread>
 
-/*
- * Register definitions
- * From https://www.nxp.com/docs/en/data-sheet/PCA9685.pdf
- * Ordered linearly
- */
-#define MODE1 0X00
-#define MODE2 0X01
-#define SUBADR1 0X02
-#define SUBADR2 0X03
-#define SUBADR3 0X04
-#define ALLCALLADR 0X05
-
-// Using LED for motor control. Each LED has 4 register adresses
-#define CHANNEL_0 0x06
-#define CHANNEL_1 0x0A
-#define CHANNEL_2 0x0E
-#define CHANNEL_3 0x12
-#define CHANNEL_4 0x16
-#define CHANNEL_5 0x1A
-#define CHANNEL_6 0x1E
-#define CHANNEL_7 0x22
-#define CHANNEL_8 0x26
-#define CHANNEL_9 0x2A
-#define CHANNEL_10 0x2E
-#define CHANNEL_11 0x32
-#define CHANNEL_12 0x36
-#define CHANNEL_13 0x3A
-#define CHANNEL_14 0x3E
-#define CHANNEL_15 0x42
-
-// Unused adresses
-// 0x45 -> 0xEF
-
-// Controll of all channels
-#define CHANNEL_ALL 0xFA
-
-// Prescaler for PWM output freq
-#define PRE_SCALE 0xFE
-
-// Enter test mode
-#define TESTMODE 0xFF
-
-// MODE1 bits
-#define MODE1_RESTART 7
-#define MODE1_RESTART_VAL 128
-#define MODE1_EXTCLK 6
-#define MODE1_EXTCLK_VAL 64
-#define MODE1_AI 5
-#define MODE1_AI_VAL 32
-#define MODE1_SLEEP 4
-#define MODE1_SLEEP_VAL 16
-#define MODE1_SUB1 3
-#define MODE1_SUB1_VAL 8
-#define MODE1_SUB2 2
-#define MODE1_SUB2_VAL 4
-#define MODE1_SUB3 1
-#define MODE1_SUB3_VAL 2
-#define MODE1_ALLCALL 0
-#define MODE1_ALLCALL_VAL 0
-
-// MODE2 bits
-// 7 -> 5 reserved
-#define MODE2_INVRT 4
-#define MODE2_INVRT_VAL 16
-#define MODE2_OCH 3
-#define MODE2_OCH_VAL 8
-#define MODE2_OUTDRV 2
-#define MODE2_OUTDRV_VAL 4
-#define MODE2_OUTNE1 1
-#define MODE2_OUTNE1_VAL 2
-#define MODE2_OUTNE0 0
-#define MODE2_OUTNE0_VAL 0
+#include "pca9685_registers.h"
 
 namespace motor_controllers {
 
 namespace communication {
 
-PCA9685Interface::PCA9685Interface(const std::string& port, int i2cAdress)
-    : oscillatorFrequency_(2.7 * 10e6),
+PCA9685Interface::PCA9685Interface(const std::string& port, int i2cAdress,
+                                   bool writerThread)
+    : PCA9685Interface(std::make_shared<PCA9685Bus>(port), i2cAdress,
+                       writerThread) {}
+
+PCA9685Interface::PCA9685Interface(PCA9685Bus::Ref bus, int i2cAdress,
+                                   bool writerThread)
+    : bus_(bus),
+      address_(static_cast<uint16_t>(i2cAdress)),
+      oscillatorFrequency_(2.7 * 10e6),
       pwmFrequency_(3600.f),
-      externalClock_(false) {
-  this->file_ = open(port.c_str(), O_RDWR);
-  if (ioctl(this->file_, I2C_SLAVE, i2cAdress) < 0) {
-    throw std::runtime_error("Cannot connect to " + port + " at " +
+      externalClock_(false),
+      registers_(),
+      batchThread_(),
+      stagedChannels_(0),
+      transactionCount_(0),
+      useWriterThread_(writerThread),
+      isWriterRunning_(false),
+      latestValues_(),
+      dirtyChannels_(0),
+      writeErrorCount_(0) {
+  if (i2cAdress < 0 || i2cAdress > 0x7F || i2cAdress == ALLCALL_ADDRESS) {
+    throw std::runtime_error("PCA9685Interface: invalid address " +
                              std::to_string(i2cAdress));
   }
+  this->bus_->attach(this);
 }
 
 PCA9685Interface::~PCA9685Interface() {
+  this->stopWriter();
   for (auto& channel : this->channels_) {
-    channel.second->closeCommunication();
+    channel->closeCommunication();
   }
-  close(this->file_);
+  this->bus_->detach(this);
 }
 
 void PCA9685Interface::start() {
+  this->stopWriter();
+  std::lock_guard<std::mutex> lock(this->busMutex_);
+
   this->setFrequency();
   //  set it upon start!
   this->restart();
 
   // Setup as totem pole structure
-  i2c_smbus_write_byte_data(this->file_, MODE2, MODE2_OUTDRV_VAL);
+  this->writeRegister(MODE2, MODE2_OUTDRV_VAL);
   std::this_thread::sleep_for(std::chrono::milliseconds(25));
 
-  i2c_smbus_write_byte_data(this->file_, MODE1, ~MODE1_SLEEP_VAL);
+  // Awake, and answering ALLCALL for the broadcasts of the bus
+  this->writeRegister(MODE1, (this->readRegister(MODE1) & ~MODE1_SLEEP_VAL) |
+                                 MODE1_ALLCALL_VAL);
   std::this_thread::sleep_for(std::chrono::milliseconds(25));
 
   // Set all channels to 0
-  i2c_smbus_write_byte_data(this->file_, CHANNEL_ALL, 0);
-  i2c_smbus_write_byte_data(this->file_, CHANNEL_ALL + 1, 0);
-  i2c_smbus_write_byte_data(this->file_, CHANNEL_ALL + 2, 0);
-  i2c_smbus_write_byte_data(this->file_, CHANNEL_ALL + 3, 0);
+  this->setAllChannelValues(0);
+
+  if (this->useWriterThread_) {
+    this->dirtyChannels_ = 0;  // overwritten by the line above
+    this->isWriterRunning_ = true;
+    this->writerThread_ = std::thread(&PCA9685Interface::writeChannels, this);
+  }
 }
 
 void PCA9685Interface::stop() {
+  // The values already set are sent first.
+  this->stopWriter();
+  std::lock_guard<std::mutex> lock(this->busMutex_);
+
   // Set all channels to 0
-  i2c_smbus_write_byte_data(this->file_, CHANNEL_ALL, 0);
-  i2c_smbus_write_byte_data(this->file_, CHANNEL_ALL + 1, 0);
-  i2c_smbus_write_byte_data(this->file_, CHANNEL_ALL + 2, 0);
-  i2c_smbus_write_byte_data(this->file_, CHANNEL_ALL + 3, 0);
+  this->setAllChannelValues(0);
 }
 
 void PCA9685Interface::setOscillatorFrequency(float frequency,
@@ -140,78 +90,317 @@ void PCA9685Interface::setOscillatorFrequency(float frequency,
   this->externalClock_ = externalClock;
 }
 
+void PCA9685Interface::resync() {
+  std::lock_guard<std::mutex> lock(this->busMutex_);
+
+  this->knownRegisters_.reset();
+  this->readRegister(MODE1);
+  this->readRegister(MODE2);
+  this->readRegister(PRE_SCALE);
+
+  if (this->registers_[MODE1] & MODE1_AI_VAL) {
+    // All the channels in one read
+    this->bus_->read(this->address_, CHANNEL_0, &this->registers_[CHANNEL_0],
+                     kChannelCount * 4);
+    this->transactionCount_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < kChannelCount * 4; ++i) {
+      this->knownRegisters_[CHANNEL_0 + i] = true;
+    }
+  } else {
+    // Without auto-increment, e.g. after a reset, one register at a time.
+    for (size_t i = 0; i < kChannelCount * 4; ++i) {
+      this->readRegister(CHANNEL_0 + i);
+    }
+  }
+
+  // The channels may remember values the chip lost, let them send again:
+  // what did not change is then skipped by the shadow.
+  for (auto& channel : this->channels_) {
+    channel->invalidateValue();
+  }
+}
+
 void PCA9685Interface::restart() {
-  __s32 data = i2c_smbus_read_byte_data(this->file_, MODE1);
+  const uint8_t data = this->readRegister(MODE1);
   if ((data & MODE1_RESTART_VAL) >> MODE1_RESTART) {
     this->sleep();
   }
   // set RESTART bit of MODE1 up to complete restart.
-  i2c_smbus_write_byte_data(this->file_, MODE1, data | MODE1_RESTART_VAL);
+  this->writeRegister(MODE1, data | MODE1_RESTART_VAL);
 }
 
 void PCA9685Interface::sleep() {
-  // read current MODE1
-  __s32 sleepOrAwake = i2c_smbus_read_byte_data(this->file_, MODE1);
   // set SLEEP bit of the current model to 1
-  i2c_smbus_write_byte_data(this->file_, MODE1, sleepOrAwake | MODE1_SLEEP_VAL);
+  this->writeRegister(MODE1, this->readRegister(MODE1) | MODE1_SLEEP_VAL);
   // Sleep to wait for the oscillator to stabilize
   std::this_thread::sleep_for(std::chrono::milliseconds(1));
 }
 
 void PCA9685Interface::wake() {
-  // read current MODE1
-  __s32 sleepOrAwake = i2c_smbus_read_byte_data(this->file_, MODE1);
   // set SLEEP bit of the current model to 0
-  i2c_smbus_write_byte_data(this->file_, MODE1,
-                            sleepOrAwake & ~MODE1_SLEEP_VAL);
+  this->writeRegister(MODE1, this->readRegister(MODE1) & ~MODE1_SLEEP_VAL);
   // Sleep to wait for the oscillator to stabilize
   std::this_thread::sleep_for(std::chrono::milliseconds(1));
 }
 
 void PCA9685Interface::setInternalClockFrequency(uint8_t prescale) {
-  __s32 data = i2c_smbus_read_byte_data(this->file_, MODE1);
+  const uint8_t data = this->readRegister(MODE1) & ~MODE1_RESTART_VAL;
 
   // Set sleep without restart
-  __s32 dataSleepNoRestart = (data & ~MODE1_RESTART_VAL) | MODE1_SLEEP_VAL;
-  i2c_smbus_write_byte_data(this->file_, MODE1, dataSleepNoRestart);
+  this->writeRegister(MODE1, data | MODE1_SLEEP_VAL);
 
   // set prescale
-  i2c_smbus_write_byte_data(this->file_, PRE_SCALE, prescale);
+  this->writeRegister(PRE_SCALE, prescale);
 
   // write data back
-  i2c_smbus_write_byte_data(this->file_, MODE1, data);
+  this->writeRegister(MODE1, data);
   // wait for osciallator to stabilize
   std::this_thread::sleep_for(std::chrono::milliseconds(1));
   // Restart and set auto increment up
-  i2c_smbus_write_byte_data(this->file_, MODE1,
-                            data | MODE1_RESTART | MODE1_AI);
+  this->writeRegister(MODE1, data | MODE1_RESTART_VAL | MODE1_AI_VAL);
 }
 
 void PCA9685Interface::setExternalClockFrequency(uint8_t prescale) {
-  __s32 data = i2c_smbus_read_byte_data(this->file_, MODE1);
-
   // Set sleep without restart
-  __s32 dataSleepNoRestart = (data & ~MODE1_RESTART_VAL) | MODE1_SLEEP_VAL;
-  i2c_smbus_write_byte_data(this->file_, MODE1, dataSleepNoRestart);
+  uint8_t dataSleepNoRestart =
+      (this->readRegister(MODE1) & ~MODE1_RESTART_VAL) | MODE1_SLEEP_VAL;
+  this->writeRegister(MODE1, dataSleepNoRestart);
 
   // Set extclk bit
   dataSleepNoRestart = dataSleepNoRestart | MODE1_EXTCLK_VAL;
-  i2c_smbus_write_byte_data(this->file_, MODE1, dataSleepNoRestart);
+  this->writeRegister(MODE1, dataSleepNoRestart);
 
   // Set prescale
-  i2c_smbus_write_byte_data(this->file_, PRE_SCALE, prescale);
+  this->writeRegister(PRE_SCALE, prescale);
   // stabilize oscillator
   std::this_thread::sleep_for(std::chrono::milliseconds(1));
 
   // Unsleep, restart and autoincrement
-  i2c_smbus_write_byte_data(
-      this->file_, MODE1,
-      (dataSleepNoRestart & ~MODE1_SLEEP) | MODE1_RESTART | MODE1_AI);
+  this->writeRegister(MODE1, (dataSleepNoRestart & ~MODE1_SLEEP_VAL) |
+                                 MODE1_RESTART_VAL | MODE1_AI_VAL);
+}
+
+void PCA9685Interface::beginBatch() {
+  std::thread::id owner;
+  if (!this->batchThread_.compare_exchange_strong(
+          owner, std::this_thread::get_id()) &&
+      owner != std::this_thread::get_id()) {
+    throw std::runtime_error(
+        "PCA9685Interface: a batch is open on another thread");
+  }
+}
+
+size_t PCA9685Interface::flush() {
+  std::thread::id owner = std::this_thread::get_id();
+  if (!this->batchThread_.compare_exchange_strong(owner, std::thread::id()) &&
+      owner != std::thread::id()) {
+    throw std::runtime_error(
+        "PCA9685Interface: the batch was open on another thread");
+  }
+
+  if (this->isWriterRunning_) {
+    // Sent by the writer thread
+    if (this->dirtyChannels_.load(std::memory_order_relaxed) != 0) {
+      this->wakeWriter_.post();
+    }
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(this->busMutex_);
+  return this->sendStaged();
+}
+
+size_t PCA9685Interface::sendStaged() {
+  // Image of the channel registers: staged values, or the shadow copy.
+  uint8_t image[kChannelCount * 4];
+  bool known[kChannelCount * 4], changed[kChannelCount * 4];
+  for (size_t i = 0; i < kChannelCount * 4; ++i) {
+    const uint8_t address = CHANNEL_0 + i;
+    const bool isStaged = this->stagedChannels_ & (1u << (i / 4));
+    image[i] = isStaged ? this->staged_[i] : this->registers_[address];
+    known[i] = isStaged || this->knownRegisters_[address];
+    changed[i] = isStaged && (!this->knownRegisters_[address] ||
+                              this->staged_[i] != this->registers_[address]);
+  }
+  this->stagedChannels_ = 0;
+
+  size_t transactions = 0;
+  size_t first = 0;
+  while (first < kChannelCount * 4) {
+    if (!changed[first]) {
+      ++first;
+      continue;
+    }
+
+    // Extend the transaction over the unchanged bytes between two changes,
+    // when a new transaction would cost more than resending them.
+    size_t last = first;
+    for (size_t i = first + 1; i < kChannelCount * 4 && known[i]; ++i) {
+      if (i - last > kMaxResentBytes + 1) break;
+      if (changed[i]) last = i;
+    }
+
+    try {
+      this->writeRegisters(CHANNEL_0 + first, &image[first], last - first + 1);
+    } catch (...) {
+      this->invalidateChannels();
+      throw;
+    }
+    ++transactions;
+    first = last + 1;
+  }
+  return transactions;
+}
+
+uint64_t PCA9685Interface::getTransactionCount() const {
+  return this->transactionCount_.load(std::memory_order_relaxed);
+}
+
+uint64_t PCA9685Interface::getWriteErrorCount() const {
+  return this->writeErrorCount_.load(std::memory_order_relaxed);
 }
 
 void PCA9685Interface::setChannelValue(uint8_t channel, uint8_t* values) {
-  i2c_smbus_write_i2c_block_data(this->file_, CHANNEL_0 + (channel * 4), 4,
-                                 values);
+  if (this->isWriterRunning_.load(std::memory_order_relaxed)) {
+    uint32_t value;
+    std::memcpy(&value, values, 4);
+    this->latestValues_[channel].store(value, std::memory_order_relaxed);
+    // The thread takes all the dirty channels: woken for the first one only.
+    // While a batch is open, its channels are dirty without a wake up, the
+    // writes of the other threads always wake it.
+    const uint32_t dirty =
+        this->dirtyChannels_.fetch_or(1u << channel, std::memory_order_release);
+    if (this->isBatchOwner()) return;
+    const bool isBatchOpen =
+        this->batchThread_.load(std::memory_order_relaxed) != std::thread::id();
+    if (dirty == 0 || isBatchOpen) {
+      this->wakeWriter_.post();
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(this->busMutex_);
+  if (this->isBatchOwner()) {
+    std::memcpy(&this->staged_[channel * 4], values, 4);
+    this->stagedChannels_ |= 1u << channel;
+    return;
+  }
+
+  // Only the bytes which differ from the chip
+  const uint8_t address = CHANNEL_0 + (channel * 4);
+  size_t first = 4, last = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    if (!this->knownRegisters_[address + i] ||
+        this->registers_[address + i] != values[i]) {
+      first = std::min(first, i);
+      last = i;
+    }
+  }
+  if (first == 4) return;
+
+  // Called from the control loops: a failed write is counted, as in the
+  // writer thread, not thrown at them.
+  try {
+    if (first == last) {
+      this->writeRegister(address + first, values[first]);
+    } else {
+      this->writeRegisters(address + first, values + first, last - first + 1);
+    }
+  } catch (const std::runtime_error&) {
+    // The next values of the channels are sent again.
+    this->invalidateChannels();
+    this->writeErrorCount_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void PCA9685Interface::setAllChannelValues(uint8_t value) {
+  // Written through ALL_LED, they read back as 0: no shadow for them.
+  const uint8_t bytes[5] = {CHANNEL_ALL, value, value, value, value};
+  this->bus_->write(this->address_, bytes, sizeof(bytes));
+  this->transactionCount_.fetch_add(1, std::memory_order_relaxed);
+  this->onAllChannelsWritten(value);
+}
+
+void PCA9685Interface::onAllChannelsWritten(uint8_t value) {
+  // The chip copies them to the registers of every channel.
+  for (size_t i = 0; i < kChannelCount * 4; ++i) {
+    this->registers_[CHANNEL_0 + i] = value;
+    this->knownRegisters_[CHANNEL_0 + i] = true;
+  }
+  // Written behind the channels, their next value must be sent. The values
+  // set before are dropped, not sent after.
+  for (auto& channel : this->channels_) {
+    channel->invalidateValue();
+  }
+  this->dirtyChannels_.store(0, std::memory_order_relaxed);
+  this->stagedChannels_ = 0;
+}
+
+void PCA9685Interface::invalidateChannels() {
+  for (size_t i = 0; i < kChannelCount * 4; ++i) {
+    this->knownRegisters_[CHANNEL_0 + i] = false;
+  }
+  for (auto& channel : this->channels_) {
+    channel->invalidateValue();
+  }
+}
+
+uint8_t PCA9685Interface::readRegister(uint8_t address) {
+  if (!this->knownRegisters_[address]) {
+    this->bus_->read(this->address_, address, &this->registers_[address], 1);
+    this->transactionCount_.fetch_add(1, std::memory_order_relaxed);
+    this->knownRegisters_[address] = true;
+  }
+  return this->registers_[address];
+}
+
+void PCA9685Interface::writeRegister(uint8_t address, uint8_t value) {
+  const bool isKnown = this->knownRegisters_[address];
+  const uint8_t previous = isKnown ? this->registers_[address] : 0;
+  uint8_t stored = value;
+
+  if (address == MODE1) {
+    // Writing 0 does not clear RESTART, set by the chip when it sleeps with
+    // running outputs, nor EXTCLK, cleared by a reset only. Writing 1 to
+    // RESTART restarts the outputs: always sent.
+    const uint8_t sticky = previous & (MODE1_RESTART_VAL | MODE1_EXTCLK_VAL);
+    if (isKnown && !(value & MODE1_RESTART_VAL) &&
+        (value | sticky) == previous) {
+      return;
+    }
+
+    const bool goesToSleep =
+        (value & MODE1_SLEEP_VAL) && !(previous & MODE1_SLEEP_VAL);
+    stored = (value | sticky) & ~MODE1_RESTART_VAL;
+    if (!(value & MODE1_RESTART_VAL) &&
+        ((previous & MODE1_RESTART_VAL) || goesToSleep)) {
+      stored |= MODE1_RESTART_VAL;
+    }
+  } else if (isKnown && previous == value) {
+    return;
+  }
+
+  const uint8_t bytes[2] = {address, value};
+  this->bus_->write(this->address_, bytes, sizeof(bytes));
+  this->transactionCount_.fetch_add(1, std::memory_order_relaxed);
+  this->registers_[address] = stored;
+  this->knownRegisters_[address] = true;
+}
+
+void PCA9685Interface::writeRegisters(uint8_t address, const uint8_t* values,
+                                      size_t size) {
+  // A single I2C message: the register address then the values.
+  uint8_t buffer[1 + kChannelCount * 4];
+  buffer[0] = address;
+  std::memcpy(buffer + 1, values, size);
+
+  this->bus_->write(this->address_, buffer, size + 1);
+  this->transactionCount_.fetch_add(1, std::memory_order_relaxed);
+
+  for (size_t i = 0; i < size; ++i) {
+    this->registers_[address + i] = values[i];
+    this->knownRegisters_[address + i] = true;
+  }
 }
 
 void PCA9685Interface::setPWMFrequency(float pwmFrequency) {
@@ -219,11 +408,8 @@ void PCA9685Interface::setPWMFrequency(float pwmFrequency) {
 }
 
 void PCA9685Interface::setFrequency() {
-  float frequency = std::min(std::max(1.0f, this->pwmFrequency_), 3500.0f);
-  float prescaleValue =
-      ((this->oscillatorFrequency_ / (frequency * 4096.0)) + 0.5) - 1;
-  prescaleValue = std::min(std::max(3.0f, prescaleValue), 255.0f);
-  uint8_t prescale = static_cast<uint8_t>(prescaleValue);
+  const uint8_t prescale =
+      PCA9685Bus::prescaleOf(this->pwmFrequency_, this->oscillatorFrequency_);
 
   if (this->externalClock_) {
     this->setExternalClockFrequency(prescale);
@@ -232,6 +418,50 @@ void PCA9685Interface::setFrequency() {
   }
 }
 
+void PCA9685Interface::writeChannels() {
+  while (true) {
+    this->wakeWriter_.wait();
+    const bool isStopping = !this->isWriterRunning_.load();
+
+    // Taken under the mutex: the values set before a stop of all the
+    // channels are cleared by it, not sent after.
+    std::lock_guard<std::mutex> lock(this->busMutex_);
+    const uint32_t dirty =
+        this->dirtyChannels_.exchange(0, std::memory_order_acquire);
+    if (dirty != 0) {
+      for (size_t channel = 0; channel < kChannelCount; ++channel) {
+        if (!(dirty & (1u << channel))) continue;
+        const uint32_t value =
+            this->latestValues_[channel].load(std::memory_order_relaxed);
+        std::memcpy(&this->staged_[channel * 4], &value, 4);
+        this->stagedChannels_ |= 1u << channel;
+      }
+      try {
+        this->sendStaged();
+      } catch (const std::runtime_error&) {
+        // The channels were invalidated, their next values are sent.
+        this->writeErrorCount_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    if (isStopping) return;
+  }
+}
+
+void PCA9685Interface::stopWriter() {
+  if (!this->writerThread_.joinable()) return;
+
+  this->isWriterRunning_ = false;
+  this->wakeWriter_.post();
+  this->writerThread_.join();
+}
+
+void PCA9685Interface::unregisterChannel(ISignalChannel* channel) {
+  // The writer thread may be invalidating the channels.
+  std::lock_guard<std::mutex> lock(this->busMutex_);
+  ChannelBuilder::unregisterChannel(channel);
+}
+
 PCA9685Channel* PCA9685Interface::createChannel(
     const PCA9685Channel::Configuration& channelBuilder) {
   return new PCA9685Channel(
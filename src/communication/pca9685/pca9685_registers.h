@@ -0,0 +1,87 @@
+/**
+ * @file pca9685_registers.h
+ * @author Pierre Venet
+ * @brief Registers of the PCA9685, shared by the interface and the bus.
+ * @version 0.1
+ * @date 2021-06-16
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+#pragma once
+
+/*
+ * Register definitions
+ * From https://www.nxp.com/docs/en/data-sheet/PCA9685.pdf
+ * Ordered linearly
+ */
+#define MODE1 0X00
+#define MODE2 0X01
+#define SUBADR1 0X02
+#define SUBADR2 0X03
+#define SUBADR3 0X04
+#define ALLCALLADR 0X05
+
+// Using LED for motor control. Each LED has 4 register adresses
+#define CHANNEL_0 0x06
+#define CHANNEL_1 0x0A
+#define CHANNEL_2 0x0E
+#define CHANNEL_3 0x12
+#define CHANNEL_4 0x16
+#define CHANNEL_5 0x1A
+#define CHANNEL_6 0x1E
+#define CHANNEL_7 0x22
+#define CHANNEL_8 0x26
+#define CHANNEL_9 0x2A
+#define CHANNEL_10 0x2E
+#define CHANNEL_11 0x32
+#define CHANNEL_12 0x36
+#define CHANNEL_13 0x3A
+#define CHANNEL_14 0x3E
+#define CHANNEL_15 0x42
+
+// Unused adresses
+// 0x45 -> 0xEF
+
+// Controll of all channels
+#define CHANNEL_ALL 0xFA
+
+// Prescaler for PWM output freq
+#define PRE_SCALE 0xFE
+
+// Enter test mode
+#define TESTMODE 0xFF
+
+// MODE1 bits
+#define MODE1_RESTART 7
+#define MODE1_RESTART_VAL 128
+#define MODE1_EXTCLK 6
+#define MODE1_EXTCLK_VAL 64
+#define MODE1_AI 5
+#define MODE1_AI_VAL 32
+#define MODE1_SLEEP 4
+#define MODE1_SLEEP_VAL 16
+#define MODE1_SUB1 3
+#define MODE1_SUB1_VAL 8
+#define MODE1_SUB2 2
+#define MODE1_SUB2_VAL 4
+#define MODE1_SUB3 1
+#define MODE1_SUB3_VAL 2
+#define MODE1_ALLCALL 0
+#define MODE1_ALLCALL_VAL 1
+
+// MODE2 bits
+// 7 -> 5 reserved
+#define MODE2_INVRT 4
+#define MODE2_INVRT_VAL 16
+#define MODE2_OCH 3
+#define MODE2_OCH_VAL 8
+#define MODE2_OUTDRV 2
+#define MODE2_OUTDRV_VAL 4
+#define MODE2_OUTNE1 1
+#define MODE2_OUTNE1_VAL 2
+#define MODE2_OUTNE0 0
+#define MODE2_OUTNE0_VAL 1
+
+// Default 7 bits address answered by all the chips, if MODE1_ALLCALL is set
+#define ALLCALL_ADDRESS 0x70
@@ -1,20 +1,33 @@
 #include <motor_controllers/communication/pigpio/pigpio_binary_channel.h>
 #include <pigpio.h>
 
-#include <condition_variable>  // std::condition_variable
-#include <mutex>               // std::mutex, std::unique_lock
+#include <chrono>  // std::chrono
 #include <stdexcept>
 
 namespace motor_controllers {
 
 namespace communication {
 
+/**
+ * @brief Convert a pigpio tick to the steady clock.
+ *
+ * The tick is the number of microseconds since boot when pigpio sampled the
+ * level. It wraps every ~72 minutes, so instead of unwrapping it, the age of
+ * the event measured by pigpio itself is subtracted from the current time.
+ *
+ * @param tick as given to the alert function
+ * @return std::chrono::steady_clock::time_point
+ */
+static std::chrono::steady_clock::time_point tickToSteadyClock(uint32_t tick) {
+  const auto now = std::chrono::steady_clock::now();
+  const uint32_t age = gpioTick() - tick;  // unsigned arithmetic handles wrap
+  return now - std::chrono::microseconds(age);
+}
+
 PiGPIOBinaryChannel::PiGPIOBinaryChannel(const Configuration& builder)
-    : IBinarySignalChannel(builder.channelMode),
+    : QueuedBinarySignalChannel(builder.channelMode),
       pinNumber_(builder.pinNumber),
-      eventDetectValue_(builder.eventDetectValue),
-      detectEventThreadAlive_(false),
-      detectEventAsyncAlive_(false) {}
+      eventDetectValue_(builder.eventDetectValue) {}
 
 PiGPIOBinaryChannel::~PiGPIOBinaryChannel() {
   if (!this->isCommunicationClosed()) {
@@ -31,7 +44,9 @@ void PiGPIOBinaryChannel::set(const BinarySignal& value) {
         "PiGPIOBinaryChannel: communication is closed, cannot set value");
   }
   if (this->getChannelMode() == ChannelMode::OUTPUT) {
-    this->setInternal(value);
+    if (this->commitLevel(value)) {
+      this->setInternal(value);
+    }
   } else {
     throw std::runtime_error("Cannot write on a INPUT channel");
   }
@@ -47,63 +62,8 @@ BinarySignal PiGPIOBinaryChannel::get() {
   return static_cast<BinarySignal>(gpioRead(this->pinNumber_));
 }
 
-std::future<BinarySignal> PiGPIOBinaryChannel::asyncDetectEvent() {
-  this->detectEventAsyncAlive_ = true;
-
-  return std::async([this]() {
-    std::unique_lock<std::mutex> lck(this->eventDetectionMutex_);
-    this->eventDetectionCondVar_.wait(lck, [this] {
-      return this->eventDetectionReady_ || !this->detectEventAsyncAlive_;
-    });
-
-    this->eventDetectionReady_ = false;
-    const BinarySignal result = this->eventDetectCurrentValue_;
-
-    this->eventDetectionProcessed_ = true;
-    this->eventDetectionCondVar_.notify_one();
-
-    return result;
-  });
-}
-
-void PiGPIOBinaryChannel::onDetectEvent(
-    const std::function<void(BinarySignal)>& callback) {
-  if (this->isCommunicationClosed()) {
-    throw std::runtime_error(
-        "PiGPIOBinaryChannel: communication is closed, cannot detect events");
-  }
-
-  if (this->detectEventAsyncAlive_) {
-    throw std::runtime_error("Cannot run thread and async simultaneously");
-  }
-
-  if (this->detectEventThreadAlive_) {  // thread already running
-    this->detectEventThreadAlive_ = false;
-    this->detectEventThread_.join();
-  }
-
-  this->detectEventThreadAlive_ = true;
-
-  this->detectEventThread_ = std::thread([this, &callback]() {
-    while (this->detectEventThreadAlive_) {
-      std::unique_lock<std::mutex> lck(this->eventDetectionMutex_);
-
-      this->eventDetectionCondVar_.wait(lck, [this] {
-        return this->eventDetectionReady_ || !this->detectEventThreadAlive_;
-      });
-      this->eventDetectionReady_ = false;
-
-      if (this->detectEventThreadAlive_) {
-        callback(this->eventDetectCurrentValue_);
-      }
-
-      this->eventDetectionProcessed_ = true;
-      this->eventDetectionCondVar_.notify_one();
-    }
-  });
-}
-
 void PiGPIOBinaryChannel::initialize() {
+  this->invalidateLevel();
   if (this->getChannelMode() == ChannelMode::INPUT) {
     this->setupInput();
   } else if (this->getChannelMode() == ChannelMode::OUTPUT) {
@@ -128,19 +88,6 @@ void PiGPIOBinaryChannel::setInternal(const BinarySignal& value) {
   }
 }
 
-void PiGPIOBinaryChannel::interuptEventDetection() {
-  if (this->detectEventThreadAlive_) {
-    this->detectEventThreadAlive_ = false;
-    this->eventDetectionCondVar_.notify_one();
-    this->detectEventThread_.join();
-  }
-
-  if (this->detectEventAsyncAlive_) {
-    this->detectEventAsyncAlive_ = false;
-    this->eventDetectionCondVar_.notify_one();
-  }
-}
-
 void PiGPIOBinaryChannel::setupInput() {
   gpioSetMode(this->pinNumber_, PI_INPUT);
   gpioSetPullUpDown(this->pinNumber_, PI_PUD_UP);
@@ -197,30 +144,25 @@ void PiGPIOBinaryChannel::setupEventDetection() {
       throw std::runtime_error("Not supported event detect type");
   }
 
-  this->eventDetectCurrentValue_ = this->get();
-  this->eventDetectionReady_ = false;
+  this->lastEvent_ = {this->get(), std::chrono::steady_clock::now()};
 
   gpioSetAlertFuncEx(this->pinNumber_, fct, this);
 }
 
-void PiGPIOBinaryChannel::onGPIOChangeState(int gpio, int level, uint32_t) {
+void PiGPIOBinaryChannel::onGPIOChangeState(int gpio, int level,
+                                            uint32_t tick) {
   // pigpio calls this callback at the specified frequency.
   // This means that the state might have changed multiple times
   // between two callbacks.
+  //
+  // This runs on pigpio's alert thread: never block here.
 
-  if (gpio != this->pinNumber_) {
+  if (gpio != this->pinNumber_ || level == PI_TIMEOUT) {
     return;
   }
 
-  this->eventDetectCurrentValue_ = static_cast<BinarySignal>(level);
-  this->eventDetectionReady_ = true;
-  this->eventDetectionCondVar_.notify_one();
-
-  std::unique_lock<std::mutex> lck(this->eventDetectionMutex_);
-  this->eventDetectionCondVar_.wait(lck, [this] {
-    return this->eventDetectionProcessed_ || !this->detectEventAsyncAlive_;
-  });
-  this->eventDetectionProcessed_ = false;
+  this->publishEdgeEvent(
+      {static_cast<BinarySignal>(level), tickToSteadyClock(tick)});
 }
 
 }  // namespace communication
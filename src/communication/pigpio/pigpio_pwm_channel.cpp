@@ -68,30 +68,38 @@ void PiGPIOPWMChannel::setPWMFrequency(float frequency) {
   if (!this->isHardware_) {
     gpioSetPWMfrequency(this->pinNumber_, this->frequency_);
   }
+  // The hardware PWM takes the frequency with the duty cycle.
+  this->invalidateValue();
 }
 
 void PiGPIOPWMChannel::setPWM(float start, float end) {
-  const unsigned int dc = static_cast<unsigned int>(std::floor(end - start));
-  if (this->isHardware_) {
-    gpioHardwarePWM(this->pinNumber_, this->frequency_, dc);
-  } else {
-    gpioPWM(this->pinNumber_, dc);
-  }
+  this->writeDutyCycle(static_cast<unsigned int>(std::floor(end - start)));
 }
 
 void PiGPIOPWMChannel::setDutyCycle(float dutyCycle) {
+  dutyCycle = std::max(std::min(dutyCycle, 1.0f), 0.0f);
+  this->setRawDutyCycle(
+      static_cast<uint32_t>(std::floor(dutyCycle * this->range_)));
+}
+
+void PiGPIOPWMChannel::setRawDutyCycle(uint32_t counts) {
   if (this->isCommunicationClosed()) {
     throw std::runtime_error(
         "PiGPIOPWMChannel: communication is closed, cannot set duty cycle");
   }
 
-  dutyCycle = std::max(std::min(dutyCycle, 1.0f), 0.0f);
-  const unsigned int dc =
-      static_cast<unsigned int>(std::floor(dutyCycle * this->range_));
-  if (this->isHardware_) {
-    gpioHardwarePWM(this->pinNumber_, this->frequency_, dc);
-  } else {
-    gpioPWM(this->pinNumber_, dc);
+  this->writeDutyCycle(std::min(counts, this->range_));
+}
+
+void PiGPIOPWMChannel::writeDutyCycle(unsigned int dc) {
+  if (!this->commitValue(dc)) return;
+
+  const int error = this->isHardware_
+                        ? gpioHardwarePWM(this->pinNumber_, this->frequency_, dc)
+                        : gpioPWM(this->pinNumber_, dc);
+  if (error != 0) {
+    // Not on the pin: the next write of the value must be sent.
+    this->invalidateValue();
   }
 }
 
@@ -107,6 +115,7 @@ void PiGPIOPWMChannel::initialize() {
     gpioPWM(this->pinNumber_, 0);
     gpioSetPWMrange(this->pinNumber_, this->range_);
   }
+  this->invalidateValue();
 }
 
 }  // namespace communication
@@ -0,0 +1,167 @@
+#include <motor_controllers/communication/queued_binary_signal_channel.h>
+
+#include <chrono>     // std::chrono
+#include <stdexcept>  // std::runtime_error
+
+namespace motor_controllers {
+namespace communication {
+
+/**
+ * @brief Stream fed by the producer of a channel while attached to it.
+ *
+ */
+class QueuedBinarySignalChannel::Stream : public QueuedEdgeEventStream {
+ public:
+  explicit Stream(QueuedBinarySignalChannel& channel)
+      : QueuedEdgeEventStream(),
+        lastEvent(channel.lastEvent_),
+        channel_(channel) {}
+
+  ~Stream() { this->cancel(); }
+
+  void cancel() override {
+    // The detections are cancelled by the channel before it is destroyed, a
+    // future may release the last reference after.
+    if (this->isCancelled()) return;
+    this->channel_.detach(this);
+    QueuedEdgeEventStream::cancel();
+  }
+
+ public:
+  EdgeEvent lastEvent;  // read by the reader only
+
+ private:
+  QueuedBinarySignalChannel& channel_;
+};
+
+QueuedBinarySignalChannel::QueuedBinarySignalChannel(
+    const ChannelMode& channelMode)
+    : IBinarySignalChannel(channelMode),
+      lastEvent_({BinarySignal::BINARY_LOW, std::chrono::steady_clock::now()}),
+      stream_(nullptr),
+      publishing_(0),
+      overflowCount_(0) {}
+
+QueuedBinarySignalChannel::~QueuedBinarySignalChannel() {
+  this->interuptEventDetection();
+}
+
+std::future<BinarySignal> QueuedBinarySignalChannel::asyncDetectEvent() {
+  std::shared_ptr<Stream> stream = this->asyncDetection();
+
+  return std::async([stream]() { return waitEdgeEvent(*stream).level; });
+}
+
+std::future<EdgeEvent> QueuedBinarySignalChannel::asyncDetectEdgeEvent() {
+  std::shared_ptr<Stream> stream = this->asyncDetection();
+
+  return std::async([stream]() { return waitEdgeEvent(*stream); });
+}
+
+EdgeEventStream::Ref QueuedBinarySignalChannel::subscribeEdgeEvents() {
+  auto stream = std::make_unique<Stream>(*this);
+  this->attach(stream.get());
+  return stream;
+}
+
+void QueuedBinarySignalChannel::onDetectEvent(
+    const std::function<void(BinarySignal)>& callback) {
+  if (this->detectEventThread_.joinable()) {  // thread already running
+    this->interuptEventDetection();
+  }
+
+  auto stream = std::make_shared<Stream>(*this);
+  this->attach(stream.get());
+  this->detection_ = stream;
+
+  this->detectEventThread_ = std::thread([stream, callback]() {
+    while (!stream->isCancelled()) {
+      const EdgeEvent event = waitEdgeEvent(*stream);
+      if (!stream->isCancelled()) {
+        callback(event.level);
+      }
+    }
+  });
+}
+
+void QueuedBinarySignalChannel::interuptEventDetection() {
+  if (this->detection_) {
+    this->detection_->cancel();
+  }
+  if (this->detectEventThread_.joinable()) {
+    this->detectEventThread_.join();
+  }
+  this->detection_.reset();
+}
+
+uint64_t QueuedBinarySignalChannel::getOverflowCount() const {
+  return this->overflowCount_.load(std::memory_order_relaxed);
+}
+
+bool QueuedBinarySignalChannel::publishEdgeEvent(
+    const EdgeEvent& event) noexcept {
+  // Counted before the load: detach stores nullptr then waits for this
+  // publish to the previous stream to be done.
+  this->publishing_.fetch_add(1);
+  Stream* stream = this->stream_.load();
+  const bool published = stream && stream->publish(event);
+  this->publishing_.fetch_sub(1, std::memory_order_release);
+
+  if (stream && !published) {
+    this->overflowCount_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return published;
+}
+
+void QueuedBinarySignalChannel::attach(Stream* stream) {
+  if (this->isCommunicationClosed()) {
+    throw std::runtime_error("Communication is closed, cannot detect events");
+  }
+
+  if (this->getChannelMode() != ChannelMode::EVENT_DETECT) {
+    throw std::runtime_error(
+        "Cannot detect events on a non EVENT_DETECT channel");
+  }
+
+  Stream* none = nullptr;
+  if (!this->stream_.compare_exchange_strong(none, stream)) {
+    throw std::runtime_error("Event detection already running on the channel");
+  }
+}
+
+std::shared_ptr<QueuedBinarySignalChannel::Stream>
+QueuedBinarySignalChannel::asyncDetection() {
+  if (this->detectEventThread_.joinable()) {
+    throw std::runtime_error("Cannot run thread and async simultaneously");
+  }
+
+  // The stream stays attached between the calls, not to miss an edge.
+  if (!this->detection_) {
+    auto stream = std::make_shared<Stream>(*this);
+    this->attach(stream.get());
+    this->detection_ = stream;
+  }
+  return this->detection_;
+}
+
+void QueuedBinarySignalChannel::detach(Stream* stream) {
+  Stream* attached = stream;
+  if (this->stream_.compare_exchange_strong(attached, nullptr)) {
+    while (this->publishing_.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+EdgeEvent QueuedBinarySignalChannel::waitEdgeEvent(Stream& stream) {
+  while (!stream.isCancelled()) {
+    // Woken up by the cancellation, the timeout only bounds the wait.
+    if (stream.waitNext(stream.lastEvent, std::chrono::seconds(1))) {
+      break;
+    }
+  }
+  return stream.lastEvent;
+}
+
+}  // namespace communication
+}  // namespace motor_controllers
@@ -0,0 +1,96 @@
+#include <motor_controllers/communication/queued_edge_event_stream.h>
+
+#include <thread>  // std::this_thread::yield
+
+namespace motor_controllers {
+namespace communication {
+
+QueuedEdgeEventStream::QueuedEdgeEventStream()
+    : waiting_(false),
+      notifier_(nullptr),
+      publishing_(0),
+      cancelled_(false),
+      overflowCount_(0) {}
+
+bool QueuedEdgeEventStream::tryNext(EdgeEvent& event) {
+  return this->events_.pop(event);
+}
+
+bool QueuedEdgeEventStream::waitNext(EdgeEvent& event,
+                                     std::chrono::nanoseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+  while (!this->cancelled_) {
+    if (this->events_.pop(event)) return true;
+
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::nanoseconds(0)) return false;
+
+    // Tell the producer to post, then look again: an event pushed before it
+    // saw the flag would not be posted.
+    this->waiting_ = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->events_.pop(event)) {
+      this->waiting_ = false;
+      return true;
+    }
+    if (this->cancelled_) break;
+
+    // A post missed by the previous wait (timeout) may still be counted, at
+    // most one, hence the loop.
+    this->eventsAvailable_.waitFor(remaining);
+    this->waiting_ = false;
+  }
+  this->waiting_ = false;
+  return false;
+}
+
+void QueuedEdgeEventStream::setNotifier(utils::Semaphore* notifier) {
+  this->notifier_ = notifier;
+  this->waitPublishers();
+}
+
+void QueuedEdgeEventStream::cancel() {
+  if (!this->cancelled_.exchange(true)) {
+    this->notifier_ = nullptr;
+    this->waitPublishers();
+    this->eventsAvailable_.post();
+  }
+}
+
+bool QueuedEdgeEventStream::isCancelled() const { return this->cancelled_; }
+
+uint64_t QueuedEdgeEventStream::getOverflowCount() const {
+  return this->overflowCount_.load(std::memory_order_relaxed);
+}
+
+bool QueuedEdgeEventStream::publish(const EdgeEvent& event) noexcept {
+  if (!this->events_.push(event)) {
+    this->overflowCount_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Pairs with the fence of waitNext: either the reader sees the event, or
+  // this sees it waiting.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (this->waiting_.exchange(false)) {
+    this->eventsAvailable_.post();
+  }
+
+  // Counted before the load: setNotifier or cancel storing a new notifier
+  // then wait for this post to the previous one to be done.
+  this->publishing_.fetch_add(1);
+  utils::Semaphore* notifier = this->notifier_.load();
+  if (notifier) notifier->post();
+  this->publishing_.fetch_sub(1, std::memory_order_release);
+  return true;
+}
+
+void QueuedEdgeEventStream::waitPublishers() const {
+  while (this->publishing_.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+}
+
+}  // namespace communication
+}  // namespace motor_controllers
@@ -0,0 +1,79 @@
+#include <motor_controllers/communication/simulated/simulated_binary_channel.h>
+
+#include <chrono>  // std::chrono
+#include <stdexcept>
+
+namespace motor_controllers {
+
+namespace communication {
+
+SimulatedBinaryChannel::SimulatedBinaryChannel(const Configuration& builder)
+    : QueuedBinarySignalChannel(builder.channelMode),
+      pinNumber_(builder.pinNumber),
+      eventDetectValue_(builder.eventDetectValue),
+      level_(BinarySignal::BINARY_LOW) {}
+
+SimulatedBinaryChannel::~SimulatedBinaryChannel() {
+  if (!this->isCommunicationClosed()) {
+    this->interuptEventDetection();
+  }
+}
+
+void SimulatedBinaryChannel::set(const BinarySignal& value) {
+  if (this->isCommunicationClosed()) {
+    throw std::runtime_error(
+        "SimulatedBinaryChannel: communication is closed, cannot set value");
+  }
+  if (this->getChannelMode() == ChannelMode::OUTPUT) {
+    if (this->commitLevel(value)) {
+      this->level_.store(value, std::memory_order_relaxed);
+    }
+  } else {
+    throw std::runtime_error("Cannot write on a INPUT channel");
+  }
+}
+
+BinarySignal SimulatedBinaryChannel::get() {
+  if (this->isCommunicationClosed()) {
+    throw std::runtime_error(
+        "SimulatedBinaryChannel: communication is closed, cannot get value");
+  }
+  return this->level_.load(std::memory_order_relaxed);
+}
+
+uint8_t SimulatedBinaryChannel::getPinNumber() const {
+  return this->pinNumber_;
+}
+
+void SimulatedBinaryChannel::simulateLevel(
+    BinarySignal level, std::chrono::steady_clock::time_point timestamp) {
+  // This runs on the simulation thread: never block here.
+  const BinarySignal previous =
+      this->level_.exchange(level, std::memory_order_relaxed);
+  if (this->getChannelMode() != ChannelMode::EVENT_DETECT ||
+      !this->isDetected(previous, level)) {
+    return;
+  }
+
+  this->publishEdgeEvent({level, timestamp});
+}
+
+bool SimulatedBinaryChannel::isDetected(BinarySignal previous,
+                                        BinarySignal level) const {
+  // Levels are detected on the edge leading to them, like pigpio.
+  switch (this->eventDetectValue_) {
+    case EventDetectType::EVENT_HIGH:
+    case EventDetectType::EVENT_RISING_EDGE:
+      return previous != level && level == BinarySignal::BINARY_HIGH;
+    case EventDetectType::EVENT_LOW:
+    case EventDetectType::EVENT_FALING_EDGE:
+      return previous != level && level == BinarySignal::BINARY_LOW;
+    case EventDetectType::EVENT_BOTH_EDGES:
+      return previous != level;
+    default:
+      return false;
+  }
+}
+
+}  // namespace communication
+}  // namespace motor_controllers
@@ -0,0 +1,266 @@
+#include <motor_controllers/communication/simulated/simulated_interface.h>
+
+#include <algorithm>  // std::find_if
+#include <cmath>      // std::exp, std::floor
+#include <stdexcept>
+
+namespace motor_controllers {
+
+namespace communication {
+
+SimulatedInterface::SimulatedInterface(double timeScale,
+                                       std::chrono::microseconds step)
+    : timeScale_(timeScale), step_(step), running_(false), simulationTime_(0) {
+  if (timeScale < 0 || step.count() <= 0) {
+    throw std::runtime_error("SimulatedInterface: invalid time scale or step");
+  }
+}
+
+SimulatedInterface::~SimulatedInterface() { this->stop(); }
+
+size_t SimulatedInterface::addMotor(const SimulatedMotorModel& model) {
+  if (this->running_) {
+    throw std::runtime_error("Cannot add a motor while running");
+  }
+  if (model.forwardConfiguration.size() != model.directionPins.size() ||
+      model.backwardConfiguration.size() != model.directionPins.size()) {
+    throw std::runtime_error(
+        "SimulatedInterface: one direction level per direction pin expected");
+  }
+  if (model.timeConstant <= 0 || model.deadzone < 0 || model.deadzone >= 1) {
+    throw std::runtime_error("SimulatedInterface: invalid motor constants");
+  }
+
+  auto motor = std::make_unique<Motor>();
+  motor->model = model;
+  motor->edgesPerRevolution =
+      model.encoderResolution * (model.encoderPinB < 0 ? 2.0 : 4.0);
+  this->motors_.push_back(std::move(motor));
+  return this->motors_.size() - 1;
+}
+
+void SimulatedInterface::start() {
+  if (this->running_) return;
+
+  for (auto& motor : this->motors_) {
+    this->wire(*motor);
+  }
+
+  this->simulationTime_ = 0;
+  this->startTime_ = std::chrono::steady_clock::now();
+  this->running_ = true;
+  this->simulationThread_ =
+      std::thread(std::bind(&SimulatedInterface::simulate, this));
+}
+
+void SimulatedInterface::stop() {
+  if (!this->running_) return;
+
+  this->running_ = false;
+  this->simulationThread_.join();
+
+  for (auto& channel :
+       this->ChannelBuilder<SimulatedPWMChannel,
+                            SimulatedPWMChannel::Configuration>::channels_) {
+    channel->setDutyCycle(0.0);
+  }
+
+  for (auto& channel :
+       this->ChannelBuilder<SimulatedBinaryChannel,
+                            SimulatedBinaryChannel::Configuration>::channels_) {
+    if (channel->getChannelMode() == ChannelMode::OUTPUT) {
+      channel->set(BinarySignal::BINARY_LOW);
+    } else if (channel->getChannelMode() == ChannelMode::EVENT_DETECT) {
+      channel->interuptEventDetection();
+    }
+  }
+}
+
+double SimulatedInterface::getMotorSpeed(size_t motor) const {
+  return this->motors_.at(motor)->publishedSpeed.load(
+      std::memory_order_relaxed);
+}
+
+int64_t SimulatedInterface::getMotorPosition(size_t motor) const {
+  return this->motors_.at(motor)->publishedPosition.load(
+      std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds SimulatedInterface::getSimulationTime() const {
+  return std::chrono::nanoseconds(this->simulationTime_.load());
+}
+
+SimulatedPWMChannel* SimulatedInterface::createChannel(
+    const SimulatedPWMChannel::Configuration& builder) {
+  return new SimulatedPWMChannel(builder);
+}
+
+SimulatedBinaryChannel* SimulatedInterface::createChannel(
+    const SimulatedBinaryChannel::Configuration& builder) {
+  return new SimulatedBinaryChannel(builder);
+}
+
+void SimulatedInterface::unregisterChannel(ISignalChannel* channel) {
+  {
+    // The motor is disconnected from that pin.
+    std::lock_guard<std::mutex> lock(this->wiringMutex_);
+    for (auto& motor : this->motors_) {
+      if (motor->pwm == channel) motor->pwm = nullptr;
+      if (motor->encoderA == channel) motor->encoderA = nullptr;
+      if (motor->encoderB == channel) motor->encoderB = nullptr;
+      for (auto& direction : motor->direction) {
+        if (direction == channel) direction = nullptr;
+      }
+    }
+  }
+
+  if (dynamic_cast<SimulatedPWMChannel*>(channel)) {
+    ChannelBuilder<SimulatedPWMChannel, SimulatedPWMChannel::Configuration>::
+        unregisterChannel(channel);
+  } else {
+    ChannelBuilder<SimulatedBinaryChannel,
+                   SimulatedBinaryChannel::Configuration>::
+        unregisterChannel(channel);
+  }
+}
+
+void SimulatedInterface::wire(Motor& motor) {
+  const auto& pwmChannels =
+      this->ChannelBuilder<SimulatedPWMChannel,
+                           SimulatedPWMChannel::Configuration>::channels_;
+  const auto& binaryChannels =
+      this->ChannelBuilder<SimulatedBinaryChannel,
+                           SimulatedBinaryChannel::Configuration>::channels_;
+
+  auto findBinary = [&binaryChannels](int pin) -> SimulatedBinaryChannel* {
+    auto it = std::find_if(
+        binaryChannels.begin(), binaryChannels.end(),
+        [pin](const auto& channel) { return channel->getPinNumber() == pin; });
+    return (it != binaryChannels.end()) ? *it : nullptr;
+  };
+
+  auto pwm = std::find_if(pwmChannels.begin(), pwmChannels.end(),
+                          [&motor](const auto& channel) {
+                            return channel->getPinNumber() == motor.model.pwmPin;
+                          });
+  motor.pwm = (pwm != pwmChannels.end()) ? *pwm : nullptr;
+
+  motor.direction.clear();
+  for (auto pin : motor.model.directionPins) {
+    motor.direction.push_back(findBinary(pin));
+  }
+  motor.encoderA = findBinary(motor.model.encoderPinA);
+  motor.encoderB = (motor.model.encoderPinB < 0)
+                       ? nullptr
+                       : findBinary(motor.model.encoderPinB);
+}
+
+void SimulatedInterface::simulate() {
+  const double dt = std::chrono::duration<double>(this->step_).count();
+  const int64_t stepNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(this->step_)
+          .count();
+  int64_t simulationTime = 0;
+
+  while (this->running_) {
+    const auto stepStart =
+        this->startTime_ + std::chrono::nanoseconds(simulationTime);
+    {
+      std::lock_guard<std::mutex> lock(this->wiringMutex_);
+      for (auto& motor : this->motors_) {
+        this->stepMotor(*motor, dt, stepStart);
+      }
+    }
+    simulationTime += stepNs;
+    this->simulationTime_.store(simulationTime);
+
+    if (this->timeScale_ > 0) {
+      std::this_thread::sleep_until(
+          this->startTime_ +
+          std::chrono::nanoseconds(
+              static_cast<int64_t>(simulationTime / this->timeScale_)));
+    } else {
+      std::this_thread::yield();  // let the consumers keep up
+    }
+  }
+}
+
+void SimulatedInterface::stepMotor(
+    Motor& motor, double dt, std::chrono::steady_clock::time_point stepStart) {
+  const SimulatedMotorModel& model = motor.model;
+
+  // Driver: mean voltage from the duty cycle, sign from the direction pins.
+  double input = 0.0;
+  if (motor.pwm) {
+    const double duty = motor.pwm->getDutyCycle();
+    if (duty > model.deadzone) {
+      input = (duty - model.deadzone) / (1.0 - model.deadzone);
+    }
+  }
+
+  int direction = 1;
+  if (!motor.direction.empty()) {
+    bool forward = true, backward = true;
+    for (size_t i = 0; i < motor.direction.size(); ++i) {
+      const BinarySignal level = motor.direction[i]
+                                     ? motor.direction[i]->get()
+                                     : BinarySignal::BINARY_LOW;
+      forward = forward && level == model.forwardConfiguration[i];
+      backward = backward && level == model.backwardConfiguration[i];
+    }
+    direction = forward ? 1 : (backward ? -1 : 0);  // anything else brakes
+  }
+
+  // First order response, integrated exactly over the step.
+  const double target = direction * input * model.maxSpeed;
+  const double decay = std::exp(-dt / model.timeConstant);
+  const double distance =
+      target * dt + (motor.speed - target) * model.timeConstant * (1 - decay);
+  motor.speed = target + (motor.speed - target) * decay;
+
+  const double from = motor.position;
+  const double to = from + distance * motor.edgesPerRevolution;
+  motor.position = to;
+
+  // Edges crossed during the step, timestamped assuming a constant speed over
+  // the step.
+  const auto emit = [&motor, stepStart, dt, from, to](int64_t state,
+                                                      double crossing) {
+    const auto timestamp =
+        stepStart + std::chrono::nanoseconds(static_cast<int64_t>(
+                        (crossing - from) / (to - from) * dt * 1e9));
+    const int s = ((state % 4) + 4) % 4;
+    if (motor.encoderB || motor.model.encoderPinB >= 0) {
+      // Quadrature states 0, 1, 2, 3 are AB = 00, 10, 11, 01 when going
+      // forward.
+      if (motor.encoderA) {
+        motor.encoderA->simulateLevel(
+            static_cast<BinarySignal>(s == 1 || s == 2), timestamp);
+      }
+      if (motor.encoderB) {
+        motor.encoderB->simulateLevel(
+            static_cast<BinarySignal>(s == 2 || s == 3), timestamp);
+      }
+    } else if (motor.encoderA) {
+      motor.encoderA->simulateLevel(static_cast<BinarySignal>(s & 1),
+                                    timestamp);
+    }
+  };
+
+  if (to > from) {
+    for (int64_t k = std::floor(from) + 1; k <= std::floor(to); ++k) {
+      emit(k, k);
+    }
+  } else if (to < from) {
+    for (int64_t k = std::floor(from); k > std::floor(to); --k) {
+      emit(k - 1, k);
+    }
+  }
+
+  motor.publishedSpeed.store(motor.speed, std::memory_order_relaxed);
+  motor.publishedPosition.store(std::floor(motor.position),
+                                std::memory_order_relaxed);
+}
+
+}  // namespace communication
+}  // namespace motor_controllers
@@ -0,0 +1,61 @@
+#include <motor_controllers/communication/simulated/simulated_pwm_channel.h>
+
+#include <algorithm>  // std::clamp, std::min
+#include <cmath>      // std::round
+#include <stdexcept>
+
+namespace motor_controllers {
+
+namespace communication {
+
+SimulatedPWMChannel::SimulatedPWMChannel(const Configuration& builder)
+    : IPWMSignalChannel(),
+      pinNumber_(builder.pinNumber),
+      range_(builder.range),
+      dutyCycle_(0.0) {
+  if (builder.range == 0) {
+    throw std::runtime_error("SimulatedPWMChannel: invalid range");
+  }
+}
+
+void SimulatedPWMChannel::setPWMFrequency(float frequency) {
+  // The simulation works on the mean voltage, the frequency does not matter.
+  if (frequency <= 0) {
+    throw std::runtime_error("SimulatedPWMChannel: invalid frequency");
+  }
+}
+
+void SimulatedPWMChannel::setPWM(float start, float end) {
+  this->setDutyCycle(end - start);
+}
+
+void SimulatedPWMChannel::setDutyCycle(float dutyCycle) {
+  // Quantized like the register of a PWM generator
+  this->setRawDutyCycle(static_cast<uint32_t>(
+      std::round(std::clamp(dutyCycle, 0.0f, 1.0f) * this->range_)));
+}
+
+void SimulatedPWMChannel::setRawDutyCycle(uint32_t counts) {
+  if (this->isCommunicationClosed()) {
+    throw std::runtime_error(
+        "SimulatedPWMChannel: communication is closed, cannot set duty cycle");
+  }
+  counts = std::min(counts, this->range_);
+  if (!this->commitValue(counts)) return;
+
+  this->dutyCycle_.store(static_cast<float>(counts) / this->range_,
+                         std::memory_order_relaxed);
+}
+
+float SimulatedPWMChannel::getMinValue() const { return 0.0; }
+
+float SimulatedPWMChannel::getMaxValue() const { return this->range_; }
+
+uint8_t SimulatedPWMChannel::getPinNumber() const { return this->pinNumber_; }
+
+float SimulatedPWMChannel::getDutyCycle() const {
+  return this->dutyCycle_.load(std::memory_order_relaxed);
+}
+
+}  // namespace communication
+}  // namespace motor_controllers
@@ -1,193 +1,294 @@
 #include <motor_controllers/encoder/encoder.h>
+#include <motor_controllers/encoder/estimators/fixed_window_estimator.h>
 
 #include <array>       // std::array
-#include <bitset>      // std::bitset
 #include <chrono>      // std::chrono
 #include <cmath>       // std::round
 #include <functional>  // std::bind
+#include <stdexcept>   // std::runtime_error
 
 namespace motor_controllers {
 namespace encoder {
 
+// Quadrature Encoder Matrix
+//
 // https://cdn.sparkfun.com/datasheets/Robotics/How%20to%20use%20a%20quadrature%20encoder.pdf
-static const std::array<Direction, 16> QEM = {
-    Direction::STOP,    Direction::BACKWARD, Direction::FORWARD,
-    Direction::INVALID, Direction::FORWARD,  Direction::STOP,
-    Direction::INVALID, Direction::BACKWARD, Direction::BACKWARD,
-    Direction::INVALID, Direction::STOP,     Direction::FORWARD,
-    Direction::INVALID, Direction::FORWARD,  Direction::BACKWARD,
-    Direction::STOP};
+// The state of the channels is 2*A+B, either 0, 1, 2 or 3. The Quadrature
+// Encoder Matrix is a 2D 4x4 matrix that relates the previous and current
+// states to a direction and a move of the position. Index [i,j] in that matrix
+// is 4*i+j in a 1D array.
+struct Transition {
+  Direction direction;
+  int8_t step;
+};
+
+static const std::array<Transition, 16> QEM = {{{Direction::STOP, 0},
+                                                {Direction::BACKWARD, -1},
+                                                {Direction::FORWARD, 1},
+                                                {Direction::INVALID, 0},
+                                                {Direction::FORWARD, 1},
+                                                {Direction::STOP, 0},
+                                                {Direction::INVALID, 0},
+                                                {Direction::BACKWARD, -1},
+                                                {Direction::BACKWARD, -1},
+                                                {Direction::INVALID, 0},
+                                                {Direction::STOP, 0},
+                                                {Direction::FORWARD, 1},
+                                                {Direction::INVALID, 0},
+                                                {Direction::FORWARD, 1},
+                                                {Direction::BACKWARD, -1},
+                                                {Direction::STOP, 0}}};
 
 Encoder::Encoder(communication::IBinarySignalChannel::Ref channelA,
                  communication::IBinarySignalChannel::Ref channelB,
                  unsigned int resolution)
     : running_(false),
+      isServiced_(false),
+      mode_(DecodingMode::ADAPTIVE),
+      adaptiveEdgeRate_(2000.0),
+      estimator_(new FixedWindowEstimator()),
       channelA_(std::move(channelA)),
       channelB_(std::move(channelB)),
       resolution_(resolution),
-      count_(0),
-      speed_(0.0),
-      direction_(Direction::STOP) {}
+      state_(this->initialState()) {}
 
 Encoder::Encoder(communication::IBinarySignalChannel::Ref channel,
                  unsigned int resolution)
     : running_(false),
+      isServiced_(false),
+      mode_(DecodingMode::ADAPTIVE),
+      adaptiveEdgeRate_(2000.0),
+      estimator_(new FixedWindowEstimator()),
       channelA_(std::move(channel)),
       resolution_(resolution),
-      count_(0),
-      speed_(0.0),
-      direction_(Direction::FORWARD) {}
+      state_(this->initialState()) {}
 
 Encoder::~Encoder() { this->stop(); }
 
-float Encoder::getSpeed() const {
-  std::lock_guard<std::mutex> lock(this->mtx_);
-  return this->speed_;
-}
+float Encoder::getSpeed() const { return this->state_.load().speed; }
 
 Direction Encoder::getDirection() const {
-  std::lock_guard<std::mutex> lock(this->mtx_);
-  return this->direction_;
+  return this->state_.load().direction;
+}
+
+ulong Encoder::getCount() const { return this->state_.load().count; }
+
+int64_t Encoder::getPosition() const { return this->state_.load().position; }
+
+EncoderState Encoder::getState() const { return this->state_.load(); }
+
+double Encoder::getEdgesPerRevolution() const {
+  return this->resolution_ * (this->channelB_ ? 4.0 : 2.0);
 }
 
-ulong Encoder::getCount() const {
-  std::lock_guard<std::mutex> lock(this->mtx_);
-  return this->count_;
+void Encoder::setDecodingMode(DecodingMode mode, float adaptiveEdgeRate) {
+  if (this->running_) {
+    throw std::runtime_error("Cannot change the decoding mode while running");
+  }
+  this->mode_ = mode;
+  this->adaptiveEdgeRate_ = adaptiveEdgeRate;
+}
+
+void Encoder::setVelocityEstimator(IVelocityEstimator::Ref estimator) {
+  if (this->running_) {
+    throw std::runtime_error("Cannot change the estimator while running");
+  }
+  if (!estimator) throw std::runtime_error("Invalid estimator");
+  this->estimator_ = std::move(estimator);
 }
 
 void Encoder::start(float freq) {
   std::chrono::microseconds samplingPeriod(
       static_cast<unsigned int>(std::round(1.0 / freq * 1e6)));
-  this->running_ = true;
-  if (this->channelA_) {
-    if (this->channelB_) {
-      this->thread_ = std::thread(std::bind(
-          &Encoder::estimateVelocityQuadratureEncoder, this, samplingPeriod));
-    } else {
-      this->thread_ = std::thread(
-          std::bind(&Encoder::estimateVelocityEncoder, this, samplingPeriod));
-    }
-  }
+  // Decoded by an EncoderService, which starts it.
+  if (!this->channelA_ || this->isServiced_) return;
+
+  this->beginDecoding(samplingPeriod, &this->eventsAvailable_);
+  this->thread_ = std::thread(std::bind(&Encoder::decode, this));
 }
 
 void Encoder::stop() {
-  if (this->running_) {
-    this->running_ = false;
-    this->thread_.join();
-  }
-  this->count_ = 0;
-  this->speed_ = 0.0;
-  this->direction_ = (this->channelB_) ? Direction::STOP : Direction::FORWARD;
-}
-
-void Encoder::estimateVelocityQuadratureEncoder(
-    std::chrono::microseconds samplingPeriod) {
-  typedef std::chrono::high_resolution_clock clock_;
-
-  // Velocity estimation
-  //
-  // https://www.embeddedrelated.com/showarticle/158.php
-  // More efficient to have a fixed dt.
-  uint cpt = 0;
-  std::chrono::time_point<clock_> lastUpdate = clock_::now();
-  std::chrono::microseconds dt;  // time elapsed since last estimation
-  const float r = this->resolution_ * 4.0 * 1e-6;
-
-  // Quadrature Encoder Matrix
-  //
-  // Index of the current direction is: 4*((2*prevA+prevB))+(2*curA+curB)
-  // At any edge detection t, the value of both channel can be read to give
-  // either 0, 1, 2 or 3.
-  // The Quadrature Encoder Matrix is a 2D 4x4 matrix that relates the current
-  // and previous values to a direction.
-  // Index [i,j] in that matrix is 4*i+j in a 1D array.
-
-  // It is convinient to write the successive values of A and B in a bitset that
-  // we shift at each event to cheaply get the index in the QEM.
-  std::bitset<4> qemIndex;
-  qemIndex.reset();
-
-  auto eventA = this->channelA_->asyncDetectEvent();
-  auto eventB = this->channelB_->asyncDetectEvent();
-
-  bool lastA = false, lastB = false;
-  bool ready = false;  // used to ensure that B is read only once A is ready.
+  // Not started, or decoded by an EncoderService which stops it.
+  if (!this->thread_.joinable()) return;
+
+  this->running_ = false;
+  this->eventsAvailable_.post();  // wake it up if blocked
+  this->thread_.join();
+  // The estimation thread is joined, this is the only writer left.
+  this->endDecoding();
+}
+
+uint8_t Encoder::readLevel(
+    const communication::IBinarySignalChannel::Ref& channel) {
+  if (!channel) return 0;
+  return channel->get() == communication::BinarySignal::BINARY_HIGH;
+}
 
+EncoderState Encoder::initialState() const {
+  EncoderState state;
+  state.direction = (this->channelB_) ? Direction::STOP : Direction::FORWARD;
+  return state;
+}
+
+void Encoder::decode() {
   while (this->running_) {
-    if (!ready && eventA.wait_for(std::chrono::microseconds(0)) ==
-                      std::future_status::ready) {
-      qemIndex <<= 2;  // push previous data
-      // Wait for A to switch then start next detection immediatly
-      lastA = static_cast<bool>(eventA.get());
-      eventA = this->channelA_->asyncDetectEvent();
-      qemIndex.set(0, lastB);
-      qemIndex.set(1, lastA);
-
-      ++cpt;
-      ++this->count_;
-
-      ready = true;
+    if (!this->decodeNextEdge()) {
+      waitForEdges(this->eventsAvailable_, this->decoder_.busyPolling,
+                   this->getWindowDeadline());
     }
+    this->closeWindowIfDue(std::chrono::steady_clock::now());
+  }
+}
 
-    if (ready && eventB.wait_for(std::chrono::microseconds(0)) ==
-                     std::future_status::ready) {
-      qemIndex <<= 2;  // push previous data
-      // Wait for B to switch then start next detection immediately
-      lastB = static_cast<bool>(eventB.get());
-      eventB = this->channelB_->asyncDetectEvent();
-      qemIndex.set(0, lastB);
-      qemIndex.set(1, lastA);
-
-      ++cpt;
-      ++this->count_;
-      
-      ready = false;
-    }
+void Encoder::beginDecoding(std::chrono::microseconds samplingPeriod,
+                            utils::Semaphore* notifier) {
+  if (this->running_.exchange(true)) {
+    throw std::runtime_error("Encoder already running");
+  }
 
-    auto now = clock_::now();
-    if ((dt = std::chrono::duration_cast<std::chrono::microseconds>(
-             now - lastUpdate)) >= samplingPeriod) {
-      std::lock_guard<std::mutex> lock(this->mtx_);
-      this->direction_ = QEM[static_cast<size_t>(qemIndex.to_ulong())];
-      lastUpdate = now;
-      this->speed_ = cpt / (dt.count() * r);
-      cpt = 0;
+  Decoder& decoder = this->decoder_;
+  try {
+    // One subscription per channel for the whole run, reused for every edge.
+    // Both post the same notifier such that a single wait covers both.
+    decoder.streamA = this->channelA_->subscribeEdgeEvents();
+    decoder.streamA->setNotifier(notifier);
+    if (this->channelB_) {
+      decoder.streamB = this->channelB_->subscribeEdgeEvents();
+      decoder.streamB->setNotifier(notifier);
     }
+  } catch (...) {
+    decoder.streamA.reset();
+    decoder.streamB.reset();
+    this->running_ = false;
+    throw;
   }
 
-  // Wait for wrap up
-  this->channelA_->interuptEventDetection();
-  this->channelB_->interuptEventDetection();
-  eventA.get();
-  eventB.get();
+  decoder.samplingPeriod = samplingPeriod;
+  decoder.windowOpen = std::chrono::steady_clock::now();
+  decoder.cpt = 0;
+  this->estimator_->reset(decoder.windowOpen, this->getEdgesPerRevolution());
+
+  decoder.hasA = decoder.hasB = false;
+  // Start from the current levels, the streams only hold the next changes.
+  decoder.levels = static_cast<uint8_t>(
+      (this->readLevel(this->channelA_) << 1) | this->readLevel(this->channelB_));
+  decoder.busyPolling = this->shouldBusyPoll(false, 0.0);
+
+  // Local copy of the state, published to the readers on every change. The
+  // readers never hold a lock, so publishing cannot block the decoding.
+  decoder.state = this->initialState();
 }
 
-void Encoder::estimateVelocityEncoder(
-    std::chrono::microseconds samplingPeriod) {
-  typedef std::chrono::high_resolution_clock clock_;
+bool Encoder::decodeNextEdge() {
+  Decoder& decoder = this->decoder_;
+
+  decoder.hasA = decoder.hasA || decoder.streamA->tryNext(decoder.eventA);
+  if (decoder.streamB) {
+    decoder.hasB = decoder.hasB || decoder.streamB->tryNext(decoder.eventB);
+  }
+  if (!decoder.hasA && !decoder.hasB) return false;
 
-  // Velocity estimation
-  //
-  // https://www.embeddedrelated.com/showarticle/158.php
-  // More efficient to have a fixed dt.
-  uint cpt = 0;
-  std::chrono::time_point<clock_> lastUpdate = clock_::now();
-  std::chrono::microseconds dt;  // time elapsed since last estimation
-  const float r = this->resolution_ * 2.0 * 1e-6;
+  // Both channels are queued independently: process the oldest edge first to
+  // keep the A/B sequence of the shaft.
+  const bool isA = decoder.hasA && (!decoder.hasB || decoder.eventA.timestamp <=
+                                                         decoder.eventB.timestamp);
+  const communication::EdgeEvent& event = isA ? decoder.eventA : decoder.eventB;
 
-  while (this->running_) {
-    this->channelA_->asyncDetectEvent().get();
-
-    const auto now = clock_::now();
-    if ((dt = std::chrono::duration_cast<std::chrono::microseconds>(
-             now - lastUpdate)) >= samplingPeriod) {
-      std::lock_guard<std::mutex> lock(this->mtx_);
-      lastUpdate = now;
-      this->speed_ = cpt / (dt.count() * r);
-      cpt = 0;
+  const uint8_t previous = decoder.levels;
+  const uint8_t level = static_cast<bool>(event.level);
+  if (isA) {
+    decoder.levels = static_cast<uint8_t>((level << 1) | (previous & 1));
+    decoder.hasA = false;
+  } else {
+    decoder.levels = static_cast<uint8_t>((previous & 2) | level);
+    decoder.hasB = false;
+  }
+
+  EncoderState& state = decoder.state;
+  if (this->channelB_) {
+    const Transition& transition = QEM[(previous << 2) | decoder.levels];
+    switch (transition.direction) {
+      case Direction::STOP:
+        // Same level twice on a channel: the edge in between was missed and
+        // the shaft moved by 0 or 2 edges.
+        ++state.skippedEdges;
+        break;
+      case Direction::INVALID:
+        // Both channels changed: the direction of the move is unknown.
+        ++state.invalidTransitions;
+        state.direction = Direction::INVALID;
+        break;
+      default:
+        state.position += transition.step;
+        state.direction = transition.direction;
+        break;
     }
-    ++cpt;
-    ++this->count_;
+  } else {
+    if (previous == decoder.levels) ++state.skippedEdges;
+    ++state.position;
+  }
+
+  this->estimator_->onEdge(event.timestamp);
+  ++decoder.cpt;
+  ++state.count;
+  this->state_.store(state);
+  return true;
+}
+
+bool Encoder::closeWindowIfDue(std::chrono::steady_clock::time_point now) {
+  Decoder& decoder = this->decoder_;
+  if (now - decoder.windowOpen < decoder.samplingPeriod) return false;
+
+  decoder.state.speed = this->estimator_->estimate(now);
+  this->state_.store(decoder.state);
+
+  decoder.busyPolling = this->shouldBusyPoll(
+      decoder.busyPolling,
+      decoder.cpt /
+          std::chrono::duration<float>(now - decoder.windowOpen).count());
+  decoder.windowOpen = now;
+  decoder.cpt = 0;
+  return true;
+}
+
+std::chrono::steady_clock::time_point Encoder::getWindowDeadline() const {
+  return this->decoder_.windowOpen + this->decoder_.samplingPeriod;
+}
+
+bool Encoder::isBusyPolling() const { return this->decoder_.busyPolling; }
+
+void Encoder::endDecoding() {
+  // The streams are cancelled when destroyed.
+  this->decoder_.streamA.reset();
+  this->decoder_.streamB.reset();
+  this->state_.store(this->initialState());
+  this->running_ = false;
+}
+
+void Encoder::waitForEdges(utils::Semaphore& eventsAvailable, bool busyPolling,
+                           std::chrono::steady_clock::time_point deadline) {
+  if (!busyPolling) {
+    // Sleep until an edge or the end of the window. Bounded such that a stop
+    // is noticed and the speed decays when the shaft stops.
+    eventsAvailable.waitFor(deadline - std::chrono::steady_clock::now());
+  }
+  // Forget the other posts: any edge pushed before this point is visible to
+  // tryNext, any edge pushed after posts again.
+  while (eventsAvailable.tryWait())
+    ;
+}
+
+bool Encoder::shouldBusyPoll(bool busyPolling, float edgeRate) const {
+  switch (this->mode_) {
+    case DecodingMode::BUSY_POLL:
+      return true;
+    case DecodingMode::BLOCKING:
+      return false;
+    case DecodingMode::ADAPTIVE:
+    default:
+      // Hysteresis to avoid toggling around the threshold.
+      return busyPolling ? edgeRate > this->adaptiveEdgeRate_ * 0.5
+                         : edgeRate > this->adaptiveEdgeRate_;
   }
 }
 
@@ -0,0 +1,124 @@
+#include <motor_controllers/encoder/encoder_service.h>
+
+#include <algorithm>   // std::min
+#include <chrono>      // std::chrono
+#include <cmath>       // std::round
+#include <functional>  // std::bind
+#include <stdexcept>   // std::runtime_error
+
+namespace motor_controllers {
+namespace encoder {
+
+// Edges processed per encoder before looking at the next one, such that a fast
+// encoder does not starve the others of the same thread.
+static constexpr int kMaxEdgesPerRound = 64;
+
+EncoderService::EncoderService(unsigned int numThreads) : running_(false) {
+  if (numThreads == 0) {
+    throw std::runtime_error("EncoderService needs at least one thread");
+  }
+  for (unsigned int i = 0; i < numThreads; ++i) {
+    this->workers_.emplace_back(new Worker());
+  }
+}
+
+EncoderService::~EncoderService() {
+  this->stop();
+  for (auto encoder : this->encoders_) encoder->isServiced_ = false;
+}
+
+void EncoderService::add(Encoder& encoder) {
+  if (this->running_) {
+    throw std::runtime_error("Cannot add an encoder while running");
+  }
+  if (std::find(this->encoders_.begin(), this->encoders_.end(), &encoder) !=
+      this->encoders_.end()) {
+    throw std::runtime_error("Encoder already added");
+  }
+  if (encoder.running_) {
+    throw std::runtime_error("Cannot add an encoder started on its own");
+  }
+  encoder.isServiced_ = true;
+  this->encoders_.push_back(&encoder);
+}
+
+size_t EncoderService::size() const { return this->encoders_.size(); }
+
+void EncoderService::start(float freq) {
+  if (this->running_) {
+    throw std::runtime_error("EncoderService already running");
+  }
+  std::chrono::microseconds samplingPeriod(
+      static_cast<unsigned int>(std::round(1.0 / freq * 1e6)));
+
+  for (auto& worker : this->workers_) worker->encoders.clear();
+  for (size_t i = 0; i < this->encoders_.size(); ++i) {
+    Worker& worker = *this->workers_[i % this->workers_.size()];
+    Encoder* encoder = this->encoders_[i];
+    try {
+      encoder->beginDecoding(samplingPeriod, &worker.eventsAvailable);
+    } catch (...) {
+      // Release the subscriptions taken so far
+      for (auto& w : this->workers_) {
+        for (auto e : w->encoders) e->endDecoding();
+        w->encoders.clear();
+      }
+      throw;
+    }
+    worker.encoders.push_back(encoder);
+  }
+
+  this->running_ = true;
+  for (auto& worker : this->workers_) {
+    if (worker->encoders.empty()) continue;
+    worker->thread =
+        std::thread(std::bind(&EncoderService::decode, this, std::ref(*worker)));
+  }
+}
+
+void EncoderService::stop() {
+  if (!this->running_) return;
+
+  this->running_ = false;
+  for (auto& worker : this->workers_) {
+    if (!worker->thread.joinable()) continue;
+    worker->eventsAvailable.post();  // wake it up if blocked
+    worker->thread.join();
+  }
+  // The decoding threads are joined, this is the only writer left.
+  for (auto& worker : this->workers_) {
+    for (auto encoder : worker->encoders) encoder->endDecoding();
+    worker->encoders.clear();
+  }
+}
+
+void EncoderService::decode(Worker& worker) {
+  typedef std::chrono::steady_clock clock_;
+
+  while (this->running_) {
+    bool decoded = false;
+    for (auto encoder : worker.encoders) {
+      for (int i = 0; i < kMaxEdgesPerRound && encoder->decodeNextEdge(); ++i) {
+        decoded = true;
+      }
+    }
+
+    // Close the due windows and find when to wake up for the next one. The
+    // thread spins as long as one of its encoders asks for it.
+    const auto now = clock_::now();
+    auto deadline = clock_::time_point::max();
+    bool busyPolling = false;
+    for (auto encoder : worker.encoders) {
+      encoder->closeWindowIfDue(now);
+      deadline = std::min(deadline, encoder->getWindowDeadline());
+      busyPolling = busyPolling || encoder->isBusyPolling();
+    }
+
+    if (!decoded) {
+      Encoder::waitForEdges(worker.eventsAvailable, busyPolling, deadline);
+    }
+  }
+}
+
+}  // namespace encoder
+}  // namespace motor_controllers
@@ -0,0 +1,68 @@
+#include <motor_controllers/encoder/estimators/edge_period_estimator.h>
+
+#include <algorithm>  // std::min
+#include <stdexcept>  // std::runtime_error
+
+namespace motor_controllers {
+namespace encoder {
+
+EdgePeriodEstimator::EdgePeriodEstimator(unsigned int averagedEdges)
+    : averagedEdges_(averagedEdges),
+      edgesPerRevolution_(1.0),
+      next_(0),
+      filled_(0),
+      sum_(0),
+      hasEdge_(false) {
+  if (averagedEdges == 0 || averagedEdges > kMaxAveragedEdges) {
+    throw std::runtime_error("Invalid number of averaged edges");
+  }
+}
+
+void EdgePeriodEstimator::reset(std::chrono::steady_clock::time_point now,
+                                float edgesPerRevolution) {
+  this->edgesPerRevolution_ = edgesPerRevolution;
+  this->next_ = 0;
+  this->filled_ = 0;
+  this->sum_ = 0;
+  this->hasEdge_ = false;
+  this->lastEdge_ = now;
+}
+
+void EdgePeriodEstimator::onEdge(
+    std::chrono::steady_clock::time_point timestamp) {
+  if (this->hasEdge_) {
+    const int64_t period =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp -
+                                                             this->lastEdge_)
+            .count();
+    if (this->filled_ == this->averagedEdges_) {
+      this->sum_ -= this->periods_[this->next_];
+    } else {
+      ++this->filled_;
+    }
+    this->periods_[this->next_] = period;
+    this->sum_ += period;
+    this->next_ = (this->next_ + 1) % this->averagedEdges_;
+  }
+  this->hasEdge_ = true;
+  this->lastEdge_ = timestamp;
+}
+
+float EdgePeriodEstimator::estimate(std::chrono::steady_clock::time_point now) {
+  // At least two edges are needed to measure a period.
+  if (this->filled_ == 0 || this->sum_ <= 0) return 0.0;
+
+  float speed = this->filled_ / (this->sum_ * 1e-9f * this->edgesPerRevolution_);
+
+  // Once the next edge is late, the period is at least the time elapsed since
+  // the last one. This makes the speed decay to 0 when stopped.
+  const std::chrono::duration<float> sinceLastEdge = now - this->lastEdge_;
+  if (sinceLastEdge.count() > 0) {
+    speed = std::min(speed,
+                     1.0f / (sinceLastEdge.count() * this->edgesPerRevolution_));
+  }
+  return speed;
+}
+
+}  // namespace encoder
+}  // namespace motor_controllers
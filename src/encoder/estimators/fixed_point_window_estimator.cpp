@@ -0,0 +1,52 @@
+#include <motor_controllers/encoder/estimators/fixed_point_window_estimator.h>
+
+#include <algorithm>  // std::min
+#include <cmath>      // std::llround
+
+namespace motor_controllers {
+namespace encoder {
+
+static int64_t toNanoseconds(std::chrono::steady_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             time.time_since_epoch())
+      .count();
+}
+
+FixedPointWindowEstimator::FixedPointWindowEstimator()
+    : scale_(0), cpt_(0), windowStartEdge_(0), lastEdge_(0), speed_(0) {}
+
+void FixedPointWindowEstimator::reset(
+    std::chrono::steady_clock::time_point now, float edgesPerRevolution) {
+  this->scale_ = std::llround(1e9 * utils::Q16::kOne / edgesPerRevolution);
+  this->cpt_ = 0;
+  this->windowStartEdge_ = toNanoseconds(now);
+  this->lastEdge_ = this->windowStartEdge_;
+  this->speed_ = 0;
+}
+
+void FixedPointWindowEstimator::onEdge(
+    std::chrono::steady_clock::time_point timestamp) {
+  this->lastEdge_ = toNanoseconds(timestamp);
+  ++this->cpt_;
+}
+
+float FixedPointWindowEstimator::estimate(
+    std::chrono::steady_clock::time_point now) {
+  // Same estimate as FixedWindowEstimator.
+  if (this->cpt_ > 0 && this->lastEdge_ > this->windowStartEdge_) {
+    this->speed_ =
+        this->cpt_ * this->scale_ / (this->lastEdge_ - this->windowStartEdge_);
+  } else {
+    const int64_t sinceLastEdge = toNanoseconds(now) - this->windowStartEdge_;
+    if (sinceLastEdge > 0) {
+      this->speed_ = std::min(this->speed_, this->scale_ / sinceLastEdge);
+    }
+  }
+
+  if (this->cpt_ > 0) this->windowStartEdge_ = this->lastEdge_;
+  this->cpt_ = 0;
+  return static_cast<float>(this->speed_) / utils::Q16::kOne;
+}
+
+}  // namespace encoder
+}  // namespace motor_controllers
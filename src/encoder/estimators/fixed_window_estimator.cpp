@@ -0,0 +1,55 @@
+#include <motor_controllers/encoder/estimators/fixed_window_estimator.h>
+
+#include <algorithm>  // std::min
+
+namespace motor_controllers {
+namespace encoder {
+
+FixedWindowEstimator::FixedWindowEstimator()
+    : edgesPerRevolution_(1.0), cpt_(0), speed_(0.0) {}
+
+void FixedWindowEstimator::reset(std::chrono::steady_clock::time_point now,
+                                 float edgesPerRevolution) {
+  this->edgesPerRevolution_ = edgesPerRevolution;
+  this->cpt_ = 0;
+  this->windowStartEdge_ = now;
+  this->lastEdge_ = now;
+  this->speed_ = 0.0;
+}
+
+void FixedWindowEstimator::onEdge(
+    std::chrono::steady_clock::time_point timestamp) {
+  this->lastEdge_ = timestamp;
+  ++this->cpt_;
+}
+
+float FixedWindowEstimator::estimate(
+    std::chrono::steady_clock::time_point now) {
+  // https://www.embeddedrelated.com/showarticle/158.php
+  // cpt edges happened between the last edge of the previous window and the
+  // last edge of this one. Using the timestamps of the backend removes the
+  // scheduling jitter of the decoding thread from the estimate.
+  if (this->cpt_ > 0 && this->lastEdge_ > this->windowStartEdge_) {
+    const std::chrono::duration<float> dt =
+        this->lastEdge_ - this->windowStartEdge_;
+    this->speed_ = this->cpt_ / (dt.count() * this->edgesPerRevolution_);
+  } else {
+    // No edge in the window: the shaft is at most doing one edge in the time
+    // elapsed since the last one. This makes the speed decay to 0 when
+    // stopped.
+    const std::chrono::duration<float> sinceLastEdge =
+        now - this->windowStartEdge_;
+    if (sinceLastEdge.count() > 0) {
+      this->speed_ = std::min(
+          this->speed_,
+          1.0f / (sinceLastEdge.count() * this->edgesPerRevolution_));
+    }
+  }
+
+  if (this->cpt_ > 0) this->windowStartEdge_ = this->lastEdge_;
+  this->cpt_ = 0;
+  return this->speed_;
+}
+
+}  // namespace encoder
+}  // namespace motor_controllers
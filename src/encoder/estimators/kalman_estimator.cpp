@@ -0,0 +1,85 @@
+#include <motor_controllers/encoder/estimators/kalman_estimator.h>
+
+#include <algorithm>  // std::max
+
+namespace motor_controllers {
+namespace encoder {
+
+// Initial uncertainty of the speed, in (edges/s)^2
+static constexpr float kInitialVelocityVariance = 1e6;
+
+KalmanEstimator::KalmanEstimator(float accelerationNoise,
+                                 float measurementNoise)
+    : q_(accelerationNoise),
+      r_(measurementNoise),
+      edgesPerRevolution_(1.0),
+      position_(0.0),
+      velocity_(0.0),
+      p00_(0.0),
+      p01_(0.0),
+      p11_(0.0) {}
+
+void KalmanEstimator::reset(std::chrono::steady_clock::time_point now,
+                            float edgesPerRevolution) {
+  this->edgesPerRevolution_ = edgesPerRevolution;
+  this->position_ = 0.0;
+  this->velocity_ = 0.0;
+  this->p00_ = 1.0 / 12.0;  // somewhere between two edges
+  this->p01_ = 0.0;
+  this->p11_ = kInitialVelocityVariance;
+  this->lastUpdate_ = now;
+}
+
+void KalmanEstimator::predict(std::chrono::steady_clock::time_point t) {
+  const float dt = std::chrono::duration<float>(t - this->lastUpdate_).count();
+  if (dt <= 0) return;
+  this->lastUpdate_ = t;
+
+  // x = F x, P = F P F' + Q with F = [1 dt; 0 1] and
+  // Q = q [dt^3/3 dt^2/2; dt^2/2 dt]
+  const float dt2 = dt * dt;
+  this->position_ += this->velocity_ * dt;
+  this->p00_ += dt * (2.0f * this->p01_ + dt * this->p11_) +
+                this->q_ * dt2 * dt / 3.0f;
+  this->p01_ += dt * this->p11_ + this->q_ * dt2 / 2.0f;
+  this->p11_ += this->q_ * dt;
+}
+
+void KalmanEstimator::update(float measuredPosition) {
+  // H = [1 0]
+  const float innovation = measuredPosition - this->position_;
+  const float s = this->p00_ + this->r_;
+  const float k0 = this->p00_ / s;
+  const float k1 = this->p01_ / s;
+
+  this->position_ += k0 * innovation;
+  this->velocity_ += k1 * innovation;
+
+  this->p11_ -= k1 * this->p01_;
+  this->p01_ *= (1.0f - k0);
+  this->p00_ *= (1.0f - k0);
+}
+
+void KalmanEstimator::onEdge(std::chrono::steady_clock::time_point timestamp) {
+  this->predict(timestamp);
+  // The shaft is exactly on the new edge: the position relative to it is 0.
+  // If an estimate() went past the edge before it was seen, the state is at
+  // lastUpdate_: the shaft is measured past the edge by the estimated speed
+  // times the delay.
+  const float delay = std::max(
+      std::chrono::duration<float>(this->lastUpdate_ - timestamp).count(),
+      0.0f);
+  this->position_ -= 1.0;
+  this->update(this->velocity_ * delay);
+}
+
+float KalmanEstimator::estimate(std::chrono::steady_clock::time_point now) {
+  this->predict(now);
+  // Past the next edge without having seen it: the shaft is slower than
+  // estimated.
+  if (this->position_ > 1.0) this->update(1.0);
+  return std::max(this->velocity_, 0.0f) / this->edgesPerRevolution_;
+}
+
+}  // namespace encoder
+}  // namespace motor_controllers
@@ -0,0 +1,72 @@
+#include <motor_controllers/encoder/estimators/pll_estimator.h>
+
+#include <algorithm>  // std::min, std::max
+#include <cmath>      // M_PI
+
+namespace motor_controllers {
+namespace encoder {
+
+PLLEstimator::PLLEstimator(float bandwidth, float damping)
+    : kp_(2.0 * damping * 2.0 * M_PI * bandwidth),
+      ki_((2.0 * M_PI * bandwidth) * (2.0 * M_PI * bandwidth)),
+      edgesPerRevolution_(1.0),
+      phase_(0.0),
+      velocity_(0.0),
+      lastStep_(0.0) {}
+
+void PLLEstimator::reset(std::chrono::steady_clock::time_point now,
+                         float edgesPerRevolution) {
+  this->edgesPerRevolution_ = edgesPerRevolution;
+  this->phase_ = 0.0;
+  this->velocity_ = 0.0;
+  this->lastUpdate_ = now;
+  this->lastStep_ = 0.0;
+}
+
+float PLLEstimator::advance(std::chrono::steady_clock::time_point t) {
+  const std::chrono::duration<float> dt = t - this->lastUpdate_;
+  if (dt.count() <= 0) return 0.0;
+  this->lastUpdate_ = t;
+  this->lastStep_ = dt.count();
+  this->phase_ += this->velocity_ * dt.count();
+  return dt.count();
+}
+
+void PLLEstimator::correct(float error, float dt) {
+  if (dt <= 0) return;
+  // The loop is only corrected at the edges. When they are far apart compared
+  // to the bandwidth, the gains are capped to those of a deadbeat alpha-beta
+  // filter to stay stable: the loop cannot be faster than the edge rate.
+  const float alpha = std::min(this->kp_ * dt, 1.0f);
+  const float beta = std::min(this->ki_ * dt * dt, 1.0f);
+  this->phase_ += alpha * error;
+  this->velocity_ += beta / dt * error;
+}
+
+void PLLEstimator::onEdge(std::chrono::steady_clock::time_point timestamp) {
+  float dt = this->advance(timestamp);
+  // The shaft is exactly on the new edge: the position relative to it is 0.
+  // If an estimate() went past the edge before it was seen, the phase is at
+  // lastUpdate_: the shaft is measured past the edge by the estimated speed
+  // times the delay, and corrected with the gains of that last step.
+  float measured = 0.0;
+  if (dt <= 0) {
+    measured = this->velocity_ *
+               std::chrono::duration<float>(this->lastUpdate_ - timestamp)
+                   .count();
+    dt = this->lastStep_;
+  }
+  this->phase_ -= 1.0;
+  this->correct(measured - this->phase_, dt);
+}
+
+float PLLEstimator::estimate(std::chrono::steady_clock::time_point now) {
+  const float dt = this->advance(now);
+  // Past the next edge without having seen it: the shaft is slower than
+  // estimated.
+  if (this->phase_ > 1.0) this->correct(1.0 - this->phase_, dt);
+  return std::max(this->velocity_, 0.0f) / this->edgesPerRevolution_;
+}
+
+}  // namespace encoder
+}  // namespace motor_controllers
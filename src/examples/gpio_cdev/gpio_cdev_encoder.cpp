@@ -0,0 +1,79 @@
+#include <motor_controllers/communication/gpio_cdev/gpio_cdev_interface.h>
+#include <motor_controllers/encoder/encoder.h>
+#include <signal.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+bool isRunning;
+
+void onSignalReceived(int) { isRunning = false; }
+
+/**
+ * @brief Read a quadrature encoder on two lines of a GPIO chip.
+ *
+ * Usage: gpio_cdev_encoder [chip] [line A] [line B]
+ *
+ * Without a Raspberry Pi, the gpio-sim kernel module provides a chip whose
+ * lines can be driven from sysfs:
+ *   modprobe gpio-sim
+ *   mkdir -p /sys/kernel/config/gpio-sim/sim/gpio-bank0
+ *   echo 8 > /sys/kernel/config/gpio-sim/sim/gpio-bank0/num_lines
+ *   echo 1 > /sys/kernel/config/gpio-sim/sim/live
+ * then toggle the pulls of sim_gpio0 and sim_gpio1 in
+ * /sys/devices/platform/gpio-sim.0/gpiochipN/.
+ *
+ */
+int main(int argc, char* argv[]) {
+  using namespace motor_controllers::communication;
+  using namespace motor_controllers::encoder;
+
+  const std::string chip = (argc > 1) ? argv[1] : "/dev/gpiochip0";
+  const uint32_t lineA = (argc > 2) ? std::stoul(argv[2]) : 27;
+  const uint32_t lineB = (argc > 3) ? std::stoul(argv[3]) : 22;
+
+  std::cout << "Connecting to " << chip << std::endl;
+  GpioCdevInterface communication(chip);
+
+  GpioCdevBinaryChannel::Configuration aBuilder;
+  aBuilder.lineOffset = lineA;
+  aBuilder.channelMode = ChannelMode::EVENT_DETECT;
+  aBuilder.eventDetectValue = EventDetectType::EVENT_BOTH_EDGES;
+  IBinarySignalChannel::Ref a = communication.configureChannel(aBuilder);
+
+  GpioCdevBinaryChannel::Configuration bBuilder;
+  bBuilder.lineOffset = lineB;
+  bBuilder.channelMode = ChannelMode::EVENT_DETECT;
+  bBuilder.eventDetectValue = EventDetectType::EVENT_BOTH_EDGES;
+  IBinarySignalChannel::Ref b = communication.configureChannel(bBuilder);
+
+  // Create a quadrature encoder of resolution 13. The edges come from the
+  // kernel: the decoding thread can sleep between them.
+  Encoder encoder(std::move(a), std::move(b), 13);
+  encoder.setDecodingMode(DecodingMode::BLOCKING);
+
+  communication.start();
+  encoder.start(50);
+
+  isRunning = true;
+  signal(SIGINT, onSignalReceived);
+
+  while (isRunning) {
+    const EncoderState state = encoder.getState();
+    float speed = state.speed * 60.0;
+    if (state.direction == Direction::BACKWARD) speed = -speed;
+    std::cout << "Speed " << speed << " RPM, position " << state.position
+              << ", missed " << state.skippedEdges + state.invalidTransitions
+              << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  std::cout << "Stopping" << std::endl;
+
+  encoder.stop();
+  communication.stop();
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+#include <motor_controllers/communication/pca9685/pca9685_bus.h>
+#include <motor_controllers/communication/pca9685/pca9685_interface.h>
+#include <motor_controllers/utils/latency_histogram.h>
+#include <signal.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace motor_controllers;
+using namespace motor_controllers::communication;
+
+bool isRunning;
+
+void onSignalReceived(int) { isRunning = false; }
+
+static void print(const std::string& name,
+                  const utils::LatencyHistogram& histogram,
+                  uint64_t transfers) {
+  const auto snapshot = histogram.snapshot();
+  if (snapshot.count == 0) return;
+  std::cout << "  " << name << ": median "
+            << snapshot.percentile(50).count() / 1000 << " us, 99% "
+            << snapshot.percentile(99).count() / 1000 << " us, max "
+            << snapshot.max.count() / 1000 << " us, "
+            << double(transfers) / snapshot.count << " ioctl per frame"
+            << std::endl;
+}
+
+// Sweep the 16 servos of 1 to N boards, at 0x40 and the next addresses,
+// sending each frame board by board then in one frame of the bus, and print
+// the time a frame takes in both cases.
+int main(int argc, char* argv[]) {
+  std::string fileName = "/dev/i2c-1";
+  int boardCount = 4;
+  int frames = 500;
+
+  if (argc > 1) {
+    fileName = std::string(argv[1]);
+  }
+  if (argc > 2) {
+    boardCount = std::stoi(argv[2]);
+  }
+  if (argc > 3) {
+    frames = std::stoi(argv[3]);
+  }
+
+  isRunning = true;
+  signal(SIGINT, onSignalReceived);
+
+  PCA9685Bus::Ref bus = std::make_shared<PCA9685Bus>(fileName);
+
+  for (int boards = 1; boards <= boardCount && isRunning; ++boards) {
+    std::vector<std::unique_ptr<PCA9685Interface>> interfaces;
+    std::vector<PCA9685ChannelRef> channels;
+    for (int board = 0; board < boards; ++board) {
+      interfaces.emplace_back(new PCA9685Interface(bus, 0x40 + board));
+      interfaces.back()->setOscillatorFrequency(27000000);
+      for (uint8_t i = 0; i < 16; ++i) {
+        PCA9685Channel::Configuration builder = {.channelId = i,
+                                                 .range = 0x0FFF};
+        channels.push_back(interfaces.back()->configureChannel(builder));
+      }
+      interfaces.back()->start();
+    }
+    // Same frequency for every board, in one broadcast
+    bus->setPWMFrequency(50, 27000000);
+
+    utils::LatencyHistogram perBoard, combined;
+    uint64_t perBoardTransfers = 0, combinedTransfers = 0;
+    for (int frame = 0; frame < frames && isRunning; ++frame) {
+      const bool isCombined = frame % 2;
+
+      // Pulses of 150 to 600 counts, each servo with its own phase
+      const uint64_t transfersBefore = bus->getTransferCount();
+      const auto begin = std::chrono::steady_clock::now();
+      if (isCombined) bus->beginFrame();
+      for (int board = 0; board < boards; ++board) {
+        interfaces[board]->beginBatch();
+        for (size_t i = 0; i < 16; ++i) {
+          const double phase = frame * 0.02 + (board * 16 + i) * 0.4;
+          const uint32_t pulse =
+              static_cast<uint32_t>(375 + 225 * std::sin(phase));
+          channels[board * 16 + i]->setRawDutyCycle(pulse);
+        }
+        interfaces[board]->flush();
+      }
+      if (isCombined) bus->flush();
+      const auto duration = std::chrono::steady_clock::now() - begin;
+
+      const uint64_t transfers = bus->getTransferCount() - transfersBefore;
+      if (isCombined) {
+        combined.record(duration);
+        combinedTransfers += transfers;
+      } else {
+        perBoard.record(duration);
+        perBoardTransfers += transfers;
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    std::cout << boards << " boards" << std::endl;
+    print("board by board", perBoard, perBoardTransfers);
+    print("bus frame     ", combined, combinedTransfers);
+
+    // Every board at once
+    bus->stopAll();
+    channels.clear();
+  }
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include <motor_controllers/communication/pca9685/pca9685_interface.h>
+#include <signal.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+bool isRunning;
+
+void onSignalReceived(int) { isRunning = false; }
+
+// Sweep the 16 servos of a HAT together, one batch per frame, and print how
+// many frames per second the bus allows.
+int main(int argc, char* argv[]) {
+  std::string fileName = "/dev/i2c-1";
+  uint8_t i2cAdress = 0x40;
+  int frames = 500;
+
+  if (argc > 1) {
+    fileName = std::string(argv[1]);
+  }
+  if (argc > 2) {
+    i2cAdress = std::stoi(argv[2]);
+  }
+  if (argc > 3) {
+    frames = std::stoi(argv[3]);
+  }
+
+  using namespace motor_controllers::communication;
+
+  std::cout << "Connecting to " << fileName << " at " << i2cAdress << std::endl;
+  PCA9685Interface communication(fileName, i2cAdress);
+  communication.setOscillatorFrequency(27000000);
+
+  std::vector<PCA9685ChannelRef> channels;
+  for (uint8_t i = 0; i < 16; ++i) {
+    PCA9685Channel::Configuration builder = {.channelId = i, .range = 0x0FFF};
+    PCA9685ChannelRef channel = communication.configureChannel(builder);
+    channel->setPWMFrequency(50);  // Freq is shared with all channels.
+    channels.push_back(std::move(channel));
+  }
+
+  communication.start();
+
+  isRunning = true;
+  signal(SIGINT, onSignalReceived);
+
+  const uint64_t transactionsBefore = communication.getTransactionCount();
+  std::chrono::steady_clock::duration busTime(0);
+  int frame = 0;
+  for (; frame < frames && isRunning; ++frame) {
+    // Pulses of 150 to 600 counts, each servo with its own phase
+    const auto begin = std::chrono::steady_clock::now();
+    communication.beginBatch();
+    for (size_t i = 0; i < channels.size(); ++i) {
+      const double phase = frame * 0.02 + i * 0.4;
+      const uint32_t pulse =
+          static_cast<uint32_t>(375 + 225 * std::sin(phase));
+      channels[i]->setRawDutyCycle(pulse);
+    }
+    communication.flush();
+    busTime += std::chrono::steady_clock::now() - begin;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  const double seconds = std::chrono::duration<double>(busTime).count();
+  std::cout << frame << " frames, "
+            << double(communication.getTransactionCount() -
+                      transactionsBefore) /
+                   frame
+            << " transactions per frame, " << seconds / frame * 1e6
+            << " us per frame, at most " << frame / seconds
+            << " frames per second" << std::endl;
+
+  communication.stop();
+
+  return 0;
+}
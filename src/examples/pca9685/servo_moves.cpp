@@ -0,0 +1,77 @@
+#include <motor_controllers/communication/pca9685/pca9685_interface.h>
+#include <motor_controllers/motor/servo_group.h>
+#include <motor_controllers/motor/servo_motor.h>
+#include <signal.h>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+bool isRunning;
+
+void onSignalReceived(int) { isRunning = false; }
+
+// Move the 16 servos of a HAT together between poses, one frame every 20 ms:
+// each frame is a single write of the 16 channels.
+int main(int argc, char* argv[]) {
+  std::string fileName = "/dev/i2c-1";
+  uint8_t i2cAdress = 0x40;
+
+  if (argc > 1) {
+    fileName = std::string(argv[1]);
+  }
+  if (argc > 2) {
+    i2cAdress = std::stoi(argv[2]);
+  }
+
+  using namespace motor_controllers::communication;
+  using namespace motor_controllers::motor;
+
+  std::cout << "Connecting to " << fileName << " at " << i2cAdress << std::endl;
+  PCA9685Interface communication(fileName, i2cAdress);
+  communication.setOscillatorFrequency(27000000);
+
+  std::vector<ServoMotor::Ref> servos;
+  ServoGroup group({&communication});
+  for (uint8_t i = 0; i < 16; ++i) {
+    PCA9685Channel::Configuration builder = {.channelId = i, .range = 0x0FFF};
+    ServoMotor::Configuration conf;
+    conf.pwmChannel = communication.configureChannel(builder);
+    conf.pwmFrequency = 50;  // Freq is shared with all channels.
+    conf.calibration = {{0.0, 500.0}, {180.0, 2500.0}};
+    servos.emplace_back(new ServoMotor(conf));
+    group.add(*servos.back());
+  }
+
+  communication.start();
+
+  isRunning = true;
+  signal(SIGINT, onSignalReceived);
+
+  const std::vector<std::vector<double>> poses = {
+      std::vector<double>(16, 90.0), std::vector<double>(16, 30.0),
+      std::vector<double>(16, 150.0)};
+
+  const uint64_t transactionsBefore = communication.getTransactionCount();
+  int frames = 0;
+  for (size_t pose = 0; isRunning && pose < 2 * poses.size(); ++pose) {
+    group.moveTo(poses[pose % poses.size()], std::chrono::seconds(1));
+    bool isMoving = true;
+    while (isRunning && isMoving) {
+      isMoving = group.update();
+      ++frames;
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+  }
+
+  std::cout << frames << " frames, "
+            << double(communication.getTransactionCount() -
+                      transactionsBefore) /
+                   frames
+            << " transactions per frame" << std::endl;
+
+  communication.stop();
+
+  return 0;
+}
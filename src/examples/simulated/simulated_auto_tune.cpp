@@ -0,0 +1,129 @@
+#include <motor_controllers/communication/simulated/simulated_interface.h>
+#include <motor_controllers/motor/auto_tuner.h>
+#include <motor_controllers/motor/dc_motor_factory.h>
+
+#include <chrono>    // std::chrono::milliseconds
+#include <cmath>     // std::abs
+#include <iostream>  // std::cout, std::endl
+#include <optional>  // std::optional
+#include <thread>    // std::this_thread::sleep_for
+
+/**
+ * Identifies a simulated motor with the AutoTuner, starting from a
+ * configuration that knows nothing about it, and compares the result with the
+ * model. Then controls the motor with the proposed constants and gains.
+ *
+ * Usage: simulated_auto_tune
+ */
+int main() {
+  using namespace motor_controllers::communication;
+  using namespace motor_controllers::motor;
+
+  typedef DCMotorFactory<SimulatedInterface, SimulatedPWMChannel::Configuration,
+                         SimulatedBinaryChannel::Configuration>
+      SimulatedDCMotorFactory;
+
+  SimulatedMotorModel model;
+  model.pwmPin = 12;
+  model.directionPins = {6, 13};
+  model.forwardConfiguration = {BinarySignal::BINARY_HIGH,
+                                BinarySignal::BINARY_LOW};
+  model.backwardConfiguration = {BinarySignal::BINARY_LOW,
+                                 BinarySignal::BINARY_HIGH};
+  model.encoderPinA = 27;
+  model.encoderPinB = 22;
+  model.encoderResolution = 13;
+  model.maxSpeed = 8000.0 / 60.0;
+  model.timeConstant = 0.05;
+  model.deadzone = 0.3;
+
+  auto simulation = std::make_unique<SimulatedInterface>();
+  SimulatedInterface* simulationPtr = simulation.get();
+  const size_t motorIndex = simulation->addMotor(model);
+
+  SimulatedDCMotorFactory factory(std::move(simulation));
+
+  auto conf = SimulatedDCMotorFactory::Configuration();
+  {
+    conf.pwmChannelConfiguration.pinNumber = model.pwmPin;
+    for (auto pin : model.directionPins) {
+      SimulatedBinaryChannel::Configuration direction =
+          SimulatedBinaryChannel::Configuration();
+      direction.pinNumber = pin;
+      direction.channelMode = ChannelMode::OUTPUT;
+      conf.directionChannelsConfiguration.push_back(direction);
+    }
+
+    conf.encoderChannelAConfiguration = {
+        .pinNumber = model.encoderPinA,
+        .channelMode = ChannelMode::EVENT_DETECT,
+        .eventDetectValue = EventDetectType::EVENT_BOTH_EDGES};
+
+    SimulatedBinaryChannel::Configuration confB =
+        SimulatedBinaryChannel::Configuration();
+    confB.pinNumber = static_cast<uint8_t>(model.encoderPinB);
+    confB.channelMode = ChannelMode::EVENT_DETECT;
+    confB.eventDetectValue = EventDetectType::EVENT_BOTH_EDGES;
+    conf.encoderChannelBConfiguration =
+        std::optional<SimulatedBinaryChannel::Configuration>(confB);
+    conf.encoderResolution = model.encoderResolution;
+    conf.encoderSamplingFrequency = 200;
+
+    conf.forwardConfiguration = model.forwardConfiguration;
+    conf.backwardConfiguration = model.backwardConfiguration;
+    conf.stopConfiguration = {BinarySignal::BINARY_LOW,
+                              BinarySignal::BINARY_LOW};
+
+    // Unknown yet
+    conf.minDutyCycle = 0.0;
+    conf.maxSpeed = 1.0;
+
+    conf.dt = std::chrono::microseconds(1000);
+  }
+
+  // Identification
+  auto motor = factory.createMotor(conf);
+  factory.startCommunication();
+
+  std::cout << "Tuning..." << std::endl;
+  AutoTuner tuner;
+  const AutoTuner::Result result = tuner.tune(*motor);
+
+  std::cout << "Dead zone " << result.deadZone << " (model " << model.deadzone
+            << ")" << std::endl;
+  std::cout << "Max speed " << result.maxSpeed * 60.0 << " RPM (model "
+            << model.maxSpeed * 60.0 << " RPM)" << std::endl;
+  std::cout << "Time constant " << result.timeConstant << " s (model "
+            << model.timeConstant << " s), dead time " << result.deadTime
+            << " s" << std::endl;
+  std::cout << "Proposed Kp " << result.controller.Kp << ", Ki "
+            << result.controller.Ki << std::endl;
+
+  // Control with the proposed constants, on a new motor.
+  factory.stopCommunication();
+  motor.reset();
+
+  conf.minDutyCycle = result.minDutyCycle;
+  conf.maxSpeed = result.maxSpeed;
+  conf.Kp = result.controller.Kp;
+  conf.Ki = result.controller.Ki;
+  conf.Kd = result.controller.Kd;
+  motor = factory.createMotor(conf);
+  factory.startCommunication();
+  motor->start();
+
+  for (double target : {0.25, 0.75, 0.5}) {
+    motor->setSpeed(target * model.maxSpeed);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    const double speed = simulationPtr->getMotorSpeed(motorIndex);
+    std::cout << "Target " << target * model.maxSpeed * 60.0
+              << " RPM, simulated " << speed * 60.0 << " RPM, error "
+              << std::abs(speed / (target * model.maxSpeed) - 1.0) * 100.0
+              << "%" << std::endl;
+  }
+
+  motor->stop();
+  factory.stopCommunication();
+
+  return 0;
+}
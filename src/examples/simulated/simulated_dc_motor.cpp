@@ -0,0 +1,184 @@
+#include <motor_controllers/communication/simulated/simulated_interface.h>
+#include <motor_controllers/controller/pid_controller.h>
+#include <motor_controllers/motor/dc_motor_factory.h>
+#include <signal.h>
+
+#include <chrono>    // std::chrono::milliseconds
+#include <cstdlib>   // std::atof
+#include <iostream>  // std::cout, std::endl
+#include <optional>  // std::optional
+#include <string>    // std::string
+#include <thread>    // std::this_thread::sleep_for
+
+bool isRunning;
+
+void onSignalReceived(int) { isRunning = false; }
+
+void printTimings(const char* name,
+                  const motor_controllers::utils::LatencyHistogram::Snapshot&
+                      histogram) {
+  std::cout << name << ": " << histogram.count << " samples, median "
+            << histogram.percentile(50).count() << " ns, 99% "
+            << histogram.percentile(99).count() << " ns, max "
+            << histogram.max.count() << " ns" << std::endl;
+}
+
+/**
+ * Accelerates and brakes a simulated motor with S-curve ramps, one every 5
+ * seconds: prints the target speed, the speed measured by the encoder and the
+ * simulated speed of the motor. In position mode, moves it back and forth by 20
+ * revolutions instead.
+ *
+ * Every control period is recorded in the telemetry file when one is given,
+ * see swig-python/motor_controllers/telemetry.py to read it.
+ *
+ * Usage: simulated_dc_motor [duration in seconds, 0 until Ctrl+C]
+ *                           [speed|position] [telemetry file]
+ */
+int main(int argc, char* argv[]) {
+  using namespace motor_controllers::communication;
+  using namespace motor_controllers::motor;
+
+  typedef DCMotorFactory<SimulatedInterface, SimulatedPWMChannel::Configuration,
+                         SimulatedBinaryChannel::Configuration>
+      SimulatedDCMotorFactory;
+
+  const double duration = (argc > 1) ? std::atof(argv[1]) : 0.0;
+  const bool positionMode = (argc > 2) && std::string(argv[2]) == "position";
+  const std::string telemetryFile = (argc > 3) ? argv[3] : "";
+
+  // The simulated motor, wired like the motor 1 of the pigpio example
+  SimulatedMotorModel model;
+  model.pwmPin = 12;
+  model.directionPins = {6, 13};
+  model.forwardConfiguration = {BinarySignal::BINARY_HIGH,
+                                BinarySignal::BINARY_LOW};
+  model.backwardConfiguration = {BinarySignal::BINARY_LOW,
+                                 BinarySignal::BINARY_HIGH};
+  model.encoderPinA = 27;
+  model.encoderPinB = 22;
+  model.encoderResolution = 13;
+  model.maxSpeed = 8000.0 / 60.0;
+  model.timeConstant = 0.05;
+  model.deadzone = 0.5;
+
+  auto simulation = std::make_unique<SimulatedInterface>();
+  SimulatedInterface* simulationPtr = simulation.get();
+  const size_t motorIndex = simulation->addMotor(model);
+
+  SimulatedDCMotorFactory factory(std::move(simulation));
+
+  auto conf = SimulatedDCMotorFactory::Configuration();
+  {
+    conf.pwmChannelConfiguration.pinNumber = model.pwmPin;
+    for (auto pin : model.directionPins) {
+      SimulatedBinaryChannel::Configuration direction =
+          SimulatedBinaryChannel::Configuration();
+      direction.pinNumber = pin;
+      direction.channelMode = ChannelMode::OUTPUT;
+      conf.directionChannelsConfiguration.push_back(direction);
+    }
+
+    conf.encoderChannelAConfiguration = {
+        .pinNumber = model.encoderPinA,
+        .channelMode = ChannelMode::EVENT_DETECT,
+        .eventDetectValue = EventDetectType::EVENT_BOTH_EDGES};
+
+    SimulatedBinaryChannel::Configuration confB =
+        SimulatedBinaryChannel::Configuration();
+    confB.pinNumber = static_cast<uint8_t>(model.encoderPinB);
+    confB.channelMode = ChannelMode::EVENT_DETECT;
+    confB.eventDetectValue = EventDetectType::EVENT_BOTH_EDGES;
+    conf.encoderChannelBConfiguration =
+        std::optional<SimulatedBinaryChannel::Configuration>(confB);
+    conf.encoderResolution = model.encoderResolution;
+    conf.encoderSamplingFrequency = 100;
+
+    conf.forwardConfiguration = model.forwardConfiguration;
+    conf.backwardConfiguration = model.backwardConfiguration;
+    conf.stopConfiguration = {BinarySignal::BINARY_LOW,
+                              BinarySignal::BINARY_LOW};
+
+    conf.minDutyCycle = model.deadzone;
+    conf.maxSpeed = model.maxSpeed;
+
+    conf.dt = std::chrono::microseconds(1000);
+
+    // Position loop at 100 Hz
+    conf.positionController.Kp = 5.0;
+    conf.positionLoopRatio = 10;
+
+    // 1 minute of telemetry
+    conf.telemetryFile = telemetryFile;
+    conf.telemetryCapacity = 60000;
+  }
+  // PI controller inlined in the control loop, see BasicDCMotor
+  motor_controllers::controller::ControllerParameters parameters;
+  parameters.Kp = 1.0;
+  parameters.Ki = 5.0;
+  parameters.outputMin = -model.maxSpeed;
+  parameters.outputMax = model.maxSpeed;
+  auto motor = factory.createMotor(
+      conf, motor_controllers::controller::PIController(parameters));
+
+  factory.startCommunication();
+  motor->start();
+
+  isRunning = true;
+  signal(SIGINT, onSignalReceived);
+
+  std::cout << "Starting controller" << std::endl;
+
+  const auto startTime = std::chrono::steady_clock::now();
+  const double rampPeriod = 5.0;
+  int rampCount = 0;
+
+  while (isRunning) {
+    const double elapsed = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - startTime)
+                               .count();
+    if (duration > 0 && elapsed > duration) break;
+
+    // The control thread samples the ramp or the move at each period.
+    if (elapsed >= rampCount * rampPeriod) {
+      if (positionMode) {
+        const int64_t edgesPerRevolution = model.encoderResolution * 4;
+        const int64_t target =
+            (rampCount % 2 == 0) ? 20 * edgesPerRevolution : 0;
+        motor->moveTo(target, conf.maxSpeed / 2.0, conf.maxSpeed,
+                      ProfileShape::S_CURVE);
+      } else {
+        const double target = (rampCount % 2 == 0) ? conf.maxSpeed : 0.0;
+        motor->rampTo(target, conf.maxSpeed / 2.0, ProfileShape::S_CURVE);
+      }
+      ++rampCount;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    if (positionMode) {
+      std::cout << "Target position " << motor->getTargetPosition()
+                << ", position " << motor->getPosition() << ", ";
+    }
+    std::cout << "Target " << motor->getTargetSpeed() * 60.0 << " RPM, measured "
+              << motor->getSpeed() * 60.0 << " RPM, simulated "
+              << simulationPtr->getMotorSpeed(motorIndex) * 60.0 << " RPM"
+              << std::endl;
+  }
+
+  std::cout << "Stopping controller" << std::endl;
+  motor->stop();
+
+  std::cout << motor->getWriteCount() << " writes, "
+            << motor->getSkippedWriteCount() << " skipped" << std::endl;
+
+  const auto statistics = motor->getStatistics();
+  printTimings("Wake up lateness", statistics.wakeUpLateness);
+  printTimings("Period", statistics.period);
+  printTimings("Compute time", statistics.computeTime);
+  printTimings("Write latency", statistics.writeLatency);
+  printTimings("Deadline misses", statistics.deadlineMisses);
+  factory.stopCommunication();
+
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include <motor_controllers/motor/auto_tuner.h>
+#include <motor_controllers/utils/real_time.h>
+
+#include <algorithm>  // std::min, std::max
+#include <cmath>      // std::abs
+#include <stdexcept>  // std::runtime_error
+#include <thread>     // std::this_thread::sleep_for
+
+namespace motor_controllers {
+namespace motor {
+
+namespace {
+// Time at which a recorded speed first reaches a level, interpolated between
+// the samples. Negative when it never does.
+double riseTime(const std::vector<AutoTuner::Sample>& samples, double level) {
+  for (size_t i = 1; i < samples.size(); ++i) {
+    const AutoTuner::Sample& previous = samples[i - 1];
+    const AutoTuner::Sample& current = samples[i];
+    if (current.speed >= level && previous.speed < level) {
+      return previous.time + (level - previous.speed) /
+                                 (current.speed - previous.speed) *
+                                 (current.time - previous.time);
+    }
+  }
+  return -1.0;
+}
+}  // namespace
+
+AutoTuner::AutoTuner() : AutoTuner(Configuration()) {}
+
+AutoTuner::AutoTuner(const Configuration& configuration)
+    : configuration_(configuration) {
+  if (configuration.stepDutyCycle <= 0 || configuration.stepDutyCycle > 1 ||
+      configuration.deadZoneStep <= 0 ||
+      configuration.samplePeriod.count() <= 0) {
+    throw std::runtime_error("AutoTuner: invalid configuration");
+  }
+}
+
+AutoTuner::Result AutoTuner::tune(DCMotor& motor) {
+  const Configuration& conf = this->configuration_;
+
+  motor.beginControl();
+  double deadZone;
+  try {
+    deadZone = this->measureDeadZone(motor);
+    if (deadZone >= conf.stepDutyCycle) {
+      throw std::runtime_error(
+          "AutoTuner: the step duty cycle is within the dead zone");
+    }
+
+    motor.pwmChannel_->setDutyCycle(0.0);
+    std::this_thread::sleep_for(conf.settleDuration);
+
+    this->recordStepResponse(motor);
+    motor.pwmChannel_->setDutyCycle(0.0);
+  } catch (...) {
+    motor.pwmChannel_->setDutyCycle(0.0);
+    motor.endControl();
+    throw;
+  }
+  motor.endControl();
+
+  return identify(this->stepResponse_, conf.stepDutyCycle, deadZone,
+                  conf.closedLoopTimeConstant);
+}
+
+const std::vector<AutoTuner::Sample>& AutoTuner::getStepResponse() const {
+  return this->stepResponse_;
+}
+
+AutoTuner::Result AutoTuner::identify(const std::vector<Sample>& stepResponse,
+                                      double stepDutyCycle, double deadZone,
+                                      double closedLoopTimeConstant) {
+  if (stepResponse.size() < 10) {
+    throw std::runtime_error("AutoTuner: step response too short");
+  }
+
+  // Steady state: the average of the last fifth of the response.
+  const size_t tail = stepResponse.size() - stepResponse.size() / 5;
+  double finalSpeed = 0.0;
+  for (size_t i = tail; i < stepResponse.size(); ++i) {
+    finalSpeed += stepResponse[i].speed;
+  }
+  finalSpeed /= (stepResponse.size() - tail);
+  if (finalSpeed <= 0) {
+    throw std::runtime_error("AutoTuner: the motor did not move forward");
+  }
+
+  // First order with dead time, from the 28.3% and 63.2% rise times.
+  const double t28 = riseTime(stepResponse, 0.283 * finalSpeed);
+  const double t63 = riseTime(stepResponse, 0.632 * finalSpeed);
+  if (t28 < 0 || t63 <= t28) {
+    throw std::runtime_error("AutoTuner: cannot fit the step response");
+  }
+
+  Result result;
+  result.deadZone = deadZone;
+  result.gain = finalSpeed / (stepDutyCycle - deadZone);
+  result.timeConstant = 1.5 * (t63 - t28);
+  result.deadTime = std::max(0.0, t63 - result.timeConstant);
+
+  result.minDutyCycle = deadZone;
+  result.maxSpeed = result.gain * (1.0 - deadZone);
+
+  // SIMC PI on a unit gain: Kp = T / (Tc + L), Ti = min(T, 4 (Tc + L)).
+  const double tc = (closedLoopTimeConstant > 0)
+                        ? closedLoopTimeConstant
+                        : std::max(result.deadTime, result.timeConstant / 2);
+  const double Kp = result.timeConstant / (tc + result.deadTime);
+  const double Ti =
+      std::min(result.timeConstant, 4.0 * (tc + result.deadTime));
+  result.controller.Kp = Kp;
+  result.controller.Ki = Kp / Ti;
+  result.controller.Kd = 0.0;
+  result.controller.outputMin = -result.maxSpeed;
+  result.controller.outputMax = result.maxSpeed;
+  return result;
+}
+
+double AutoTuner::measureDeadZone(DCMotor& motor) {
+  const Configuration& conf = this->configuration_;
+
+  for (int i = 1; i * conf.deadZoneStep <= 1.0; ++i) {
+    const double dutyCycle = i * conf.deadZoneStep;
+    const int64_t start = motor.encoder_->getPosition();
+    motor.pwmChannel_->setDutyCycle(dutyCycle);
+    std::this_thread::sleep_for(conf.deadZoneStepDuration);
+
+    if (std::abs(motor.encoder_->getPosition() - start) >= conf.movingEdges) {
+      // The dead zone ends between the previous step and this one.
+      return dutyCycle - conf.deadZoneStep / 2;
+    }
+  }
+  throw std::runtime_error("AutoTuner: the motor does not move");
+}
+
+void AutoTuner::recordStepResponse(DCMotor& motor) {
+  const Configuration& conf = this->configuration_;
+  const size_t sampleCount =
+      std::chrono::duration_cast<std::chrono::microseconds>(conf.stepDuration) /
+          conf.samplePeriod +
+      1;
+
+  // Allocated beforehand, the recording only writes to it.
+  this->stepResponse_.clear();
+  this->stepResponse_.reserve(sampleCount);
+
+  utils::PeriodicTimer timer(conf.samplePeriod);
+  timer.start();
+  const auto stepTime = std::chrono::steady_clock::now();
+  motor.pwmChannel_->setDutyCycle(conf.stepDutyCycle);
+
+  for (size_t i = 0; i < sampleCount; ++i) {
+    const encoder::EncoderState state = motor.encoder_->getState();
+    const std::chrono::duration<double> time =
+        std::chrono::steady_clock::now() - stepTime;
+    this->stepResponse_.push_back(
+        Sample{time.count(), DCMotor::speedOf(state), state.position});
+    timer.waitNextPeriod();
+  }
+}
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -0,0 +1,122 @@
+#include <motor_controllers/motor/motion_profile.h>
+
+#include <algorithm>  // std::min
+#include <cmath>      // std::abs, std::sqrt, std::sin, std::cos
+#include <stdexcept>  // std::runtime_error
+
+namespace motor_controllers {
+namespace motor {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+// Length of a speed change at a maximal acceleration: the sin² acceleration
+// averages to half its peak.
+double rampDuration(double deltaSpeed, double maxAcceleration,
+                    ProfileShape shape) {
+  const double duration = std::abs(deltaSpeed) / maxAcceleration;
+  return (shape == ProfileShape::S_CURVE) ? 2.0 * duration : duration;
+}
+}  // namespace
+
+MotionProfile::MotionProfile(double speed)
+    : phases_(),
+      phaseCount_(0),
+      shape_(ProfileShape::TRAPEZOIDAL),
+      duration_(0.0),
+      distance_(0.0),
+      finalSpeed_(speed) {}
+
+MotionProfile MotionProfile::ramp(double startSpeed, double endSpeed,
+                                  double maxAcceleration, ProfileShape shape) {
+  if (maxAcceleration <= 0) {
+    throw std::runtime_error("The maximal acceleration must be positive");
+  }
+
+  MotionProfile profile(endSpeed);
+  profile.shape_ = shape;
+  profile.addPhase(rampDuration(endSpeed - startSpeed, maxAcceleration, shape),
+                   startSpeed, endSpeed);
+  return profile;
+}
+
+MotionProfile MotionProfile::move(double distance, double maxSpeed,
+                                  double maxAcceleration, ProfileShape shape) {
+  if (maxSpeed <= 0 || maxAcceleration <= 0) {
+    throw std::runtime_error(
+        "The maximal speed and acceleration must be positive");
+  }
+
+  // Each ramp to the speed v covers v·T/2 with T = k·v/A, k = 2 for S_CURVE.
+  const double k = (shape == ProfileShape::S_CURVE) ? 2.0 : 1.0;
+  const double length = std::abs(distance);
+  const double cruiseSpeed =
+      std::min(maxSpeed, std::sqrt(length * maxAcceleration / k));
+  const double speed = (distance < 0) ? -cruiseSpeed : cruiseSpeed;
+
+  MotionProfile profile(0.0);
+  profile.shape_ = shape;
+  if (cruiseSpeed <= 0) return profile;
+
+  const double rampTime = rampDuration(cruiseSpeed, maxAcceleration, shape);
+  const double cruiseTime = (length - cruiseSpeed * rampTime) / cruiseSpeed;
+  profile.addPhase(rampTime, 0.0, speed);
+  profile.addPhase(cruiseTime, speed, speed);
+  profile.addPhase(rampTime, speed, 0.0);
+  return profile;
+}
+
+ProfileSample MotionProfile::sample(double time) const {
+  if (time < 0) time = 0;
+
+  for (size_t i = 0; i < this->phaseCount_; ++i) {
+    const Phase& phase = this->phases_[i];
+    if (time < phase.duration) {
+      return this->samplePhase(phase, time);
+    }
+    time -= phase.duration;
+  }
+
+  return ProfileSample{this->distance_ + this->finalSpeed_ * time,
+                       this->finalSpeed_, 0.0};
+}
+
+double MotionProfile::getDuration() const { return this->duration_; }
+
+double MotionProfile::getDistance() const { return this->distance_; }
+
+double MotionProfile::getFinalSpeed() const { return this->finalSpeed_; }
+
+void MotionProfile::addPhase(double duration, double startSpeed,
+                             double endSpeed) {
+  if (duration <= 0) return;
+
+  this->phases_[this->phaseCount_++] =
+      Phase{duration, startSpeed, endSpeed, this->distance_};
+  this->duration_ += duration;
+  this->distance_ += 0.5 * (startSpeed + endSpeed) * duration;
+}
+
+ProfileSample MotionProfile::samplePhase(const Phase& phase,
+                                         double time) const {
+  const double deltaSpeed = phase.endSpeed - phase.startSpeed;
+  const double u = time / phase.duration;
+  const double position = phase.startPosition + phase.startSpeed * time;
+
+  if (this->shape_ == ProfileShape::S_CURVE) {
+    const double angle = 2.0 * kPi * u;
+    return ProfileSample{
+        position +
+            deltaSpeed * phase.duration *
+                (0.5 * u * u + (std::cos(angle) - 1.0) / (4.0 * kPi * kPi)),
+        phase.startSpeed + deltaSpeed * (u - std::sin(angle) / (2.0 * kPi)),
+        deltaSpeed / phase.duration * (1.0 - std::cos(angle))};
+  }
+
+  return ProfileSample{position + 0.5 * deltaSpeed * u * time,
+                       phase.startSpeed + deltaSpeed * u,
+                       deltaSpeed / phase.duration};
+}
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -0,0 +1,97 @@
+#include <motor_controllers/motor/servo_group.h>
+
+#include <algorithm>  // std::min, std::max
+#include <cmath>      // std::isnan
+#include <stdexcept>  // std::runtime_error
+
+namespace motor_controllers {
+namespace motor {
+
+ServoGroup::ServoGroup(std::vector<communication::IBatchWriter*> writers)
+    : writers_(writers),
+      duration_(0),
+      easing_(ServoEasing::LINEAR),
+      isMoving_(false) {}
+
+size_t ServoGroup::add(ServoMotor& servo) {
+  if (this->isMoving_) {
+    throw std::runtime_error("ServoGroup: cannot add a servo during a move");
+  }
+
+  // Until the next move, its current entry: the frames do not move it.
+  const float position = servo.index_ == ServoMotor::kNoIndex
+                             ? 0.0f
+                             : static_cast<float>(servo.index_);
+  this->servos_.push_back(&servo);
+  this->starts_.push_back(position);
+  this->distances_.push_back(0.0f);
+  this->indices_.push_back(static_cast<int32_t>(servo.index_));
+  return this->servos_.size() - 1;
+}
+
+size_t ServoGroup::size() const { return this->servos_.size(); }
+
+void ServoGroup::moveTo(const std::vector<double>& angles,
+                        std::chrono::microseconds duration, ServoEasing easing,
+                        clock::time_point start) {
+  if (angles.size() != this->servos_.size()) {
+    throw std::runtime_error("ServoGroup: one target per servo");
+  }
+
+  for (size_t i = 0; i < this->servos_.size(); ++i) {
+    const ServoMotor& servo = *this->servos_[i];
+    const double target = servo.positionOf(angles[i]);
+    const double current = std::isnan(servo.getAngle())
+                               ? target
+                               : static_cast<double>(servo.index_);
+    this->starts_[i] = static_cast<float>(current);
+    this->distances_[i] = static_cast<float>(target - current);
+  }
+
+  this->start_ = start;
+  this->duration_ = duration;
+  this->easing_ = easing;
+  this->isMoving_ = true;
+}
+
+bool ServoGroup::update(clock::time_point now) {
+  if (!this->isMoving_) return false;
+
+  // Progress of the move, the same for every servo
+  float progress = 1.0f;
+  if (this->duration_.count() > 0) {
+    progress = std::chrono::duration<float>(now - this->start_) /
+               std::chrono::duration<float>(this->duration_);
+    progress = std::min(std::max(progress, 0.0f), 1.0f);
+  }
+  if (this->easing_ == ServoEasing::SMOOTH) {
+    progress = progress * progress * (3.0f - 2.0f * progress);
+  }
+
+  // Positions are not negative: adding 0.5 and truncating rounds them.
+  const size_t count = this->servos_.size();
+  const float* starts = this->starts_.data();
+  const float* distances = this->distances_.data();
+  int32_t* indices = this->indices_.data();
+  for (size_t i = 0; i < count; ++i) {
+    indices[i] =
+        static_cast<int32_t>(starts[i] + distances[i] * progress + 0.5f);
+  }
+
+  for (auto& writer : this->writers_) writer->beginBatch();
+  // The channels skip the values the hardware already has.
+  for (size_t i = 0; i < count; ++i) {
+    this->servos_[i]->setIndex(static_cast<size_t>(indices[i]));
+  }
+  for (auto& writer : this->writers_) writer->flush();
+
+  if (now >= this->start_ + this->duration_) {
+    this->isMoving_ = false;
+  }
+  return this->isMoving_;
+}
+
+bool ServoGroup::isMoving() const { return this->isMoving_; }
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -0,0 +1,111 @@
+#include <motor_controllers/motor/servo_motor.h>
+
+#include <algorithm>  // std::min, std::max
+#include <cmath>      // std::ceil, std::lround, NAN
+#include <stdexcept>  // std::runtime_error
+#include <utility>    // std::move
+
+namespace motor_controllers {
+namespace motor {
+
+ServoMotor::ServoMotor(Configuration& conf)
+    : pwmChannel_(std::move(conf.pwmChannel)),
+      calibration_(conf.calibration),
+      resolution_(conf.resolution),
+      index_(kNoIndex) {
+  if (!this->pwmChannel_) {
+    throw std::runtime_error("ServoMotor: a PWM channel is required");
+  }
+  if (this->calibration_.size() < 2) {
+    throw std::runtime_error("ServoMotor: at least 2 calibration points");
+  }
+  for (size_t i = 1; i < this->calibration_.size(); ++i) {
+    if (this->calibration_[i].angle <= this->calibration_[i - 1].angle) {
+      throw std::runtime_error(
+          "ServoMotor: the calibration angles must increase");
+    }
+  }
+  if (this->resolution_ <= 0.0) {
+    throw std::runtime_error("ServoMotor: the resolution must be positive");
+  }
+
+  this->setPWMFrequency(conf.pwmFrequency);
+}
+
+ServoMotor::~ServoMotor() {}
+
+void ServoMotor::setPWMFrequency(double frequency) {
+  this->pwmChannel_->setPWMFrequency(static_cast<float>(frequency));
+
+  // Pulse width to duty cycle, then to counts, as setRawDutyCycle
+  const double countsPerMicrosecond =
+      frequency * 1e-6 * this->pwmChannel_->getMaxValue();
+  const double minCounts = this->pwmChannel_->getMinValue();
+  const double maxCounts = this->pwmChannel_->getMaxValue();
+
+  const size_t size = static_cast<size_t>(std::ceil(
+                          (this->getMaxAngle() - this->getMinAngle()) /
+                          this->resolution_)) +
+                      1;
+  this->table_.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    const double angle = std::min(
+        this->getMinAngle() + i * this->resolution_, this->getMaxAngle());
+    const double counts = this->pulseWidthOf(angle) * countsPerMicrosecond;
+    this->table_[i] = static_cast<uint32_t>(
+        std::lround(std::min(std::max(counts, minCounts), maxCounts)));
+  }
+
+  // Same angle, at the new frequency
+  if (this->index_ != kNoIndex) {
+    this->setIndex(this->index_);
+  }
+}
+
+void ServoMotor::setAngle(double angle) {
+  this->setIndex(this->indexOf(angle));
+}
+
+double ServoMotor::getAngle() const {
+  if (this->index_ == kNoIndex) return NAN;
+  return std::min(this->getMinAngle() + this->index_ * this->resolution_,
+                  this->getMaxAngle());
+}
+
+double ServoMotor::getMinAngle() const {
+  return this->calibration_.front().angle;
+}
+
+double ServoMotor::getMaxAngle() const {
+  return this->calibration_.back().angle;
+}
+
+uint32_t ServoMotor::getCounts(double angle) const {
+  return this->table_[this->indexOf(angle)];
+}
+
+size_t ServoMotor::indexOf(double angle) const {
+  return static_cast<size_t>(std::lround(this->positionOf(angle)));
+}
+
+double ServoMotor::positionOf(double angle) const {
+  angle = std::min(std::max(angle, this->getMinAngle()), this->getMaxAngle());
+  return std::min((angle - this->getMinAngle()) / this->resolution_,
+                  static_cast<double>(this->table_.size() - 1));
+}
+
+double ServoMotor::pulseWidthOf(double angle) const {
+  size_t i = 1;
+  while (i + 1 < this->calibration_.size() &&
+         this->calibration_[i].angle < angle) {
+    ++i;
+  }
+  const ServoCalibrationPoint& low = this->calibration_[i - 1];
+  const ServoCalibrationPoint& high = this->calibration_[i];
+  return low.pulseWidth + (angle - low.angle) *
+                              (high.pulseWidth - low.pulseWidth) /
+                              (high.angle - low.angle);
+}
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -0,0 +1,264 @@
+#include <motor_controllers/motor/setpoint_generator.h>
+
+#include <stdexcept>  // std::runtime_error
+
+namespace motor_controllers {
+namespace motor {
+
+SetpointGenerator::SetpointGenerator()
+    : lastMode_(Mode::SPEED),
+      lastStream_(0),
+      mode_(Mode::SPEED),
+      target_(0.0),
+      targetPosition_(0.0),
+      moveStart_(0.0),
+      stream_(0),
+      previous_(),
+      next_(),
+      hasNext_(false),
+      publishedTarget_(0.0),
+      publishedPosition_(0.0) {}
+
+void SetpointGenerator::setSpeed(double speed) {
+  Command command;
+  command.mode = Mode::SPEED;
+  command.speed = speed;
+
+  this->submit(command);
+}
+
+void SetpointGenerator::rampTo(double speed, double maxAcceleration,
+                               ProfileShape shape) {
+  if (maxAcceleration <= 0) {
+    throw std::runtime_error("The maximal acceleration must be positive");
+  }
+
+  Command command;
+  command.mode = Mode::RAMP;
+  command.speed = speed;
+  command.maxAcceleration = maxAcceleration;
+  command.shape = shape;
+  command.start = std::chrono::steady_clock::now();
+
+  this->submit(command);
+}
+
+void SetpointGenerator::followProfile(
+    const MotionProfile& profile, std::chrono::steady_clock::time_point start) {
+  Command command;
+  command.mode = Mode::PROFILE;
+  command.profile = profile;
+  command.start = start;
+
+  this->submit(command);
+}
+
+size_t SetpointGenerator::pushSetpoints(
+    const std::vector<Setpoint>& setpoints) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+
+  // The setpoints are tagged with their stream, so that the control thread
+  // drops what is left of a previous one.
+  const bool newStream = (this->lastMode_ != Mode::STREAM);
+  if (newStream) ++this->lastStream_;
+
+  size_t count = 0;
+  for (const Setpoint& setpoint : setpoints) {
+    if (!this->setpoints_.push(StreamedSetpoint{setpoint, this->lastStream_})) {
+      break;
+    }
+    ++count;
+  }
+
+  if (newStream) {
+    Command command;
+    command.mode = Mode::STREAM;
+    this->write(command);
+  }
+  return count;
+}
+
+void SetpointGenerator::moveTo(double position, double maxSpeed,
+                               double maxAcceleration, ProfileShape shape) {
+  if (maxSpeed <= 0 || maxAcceleration <= 0) {
+    throw std::runtime_error(
+        "The maximal speed and acceleration must be positive");
+  }
+
+  Command command;
+  command.mode = Mode::MOVE;
+  command.position = position;
+  command.speed = maxSpeed;
+  command.maxAcceleration = maxAcceleration;
+  command.shape = shape;
+  command.start = std::chrono::steady_clock::now();
+
+  this->submit(command);
+}
+
+void SetpointGenerator::hold() {
+  Command command;
+  command.mode = Mode::HOLD;
+
+  this->submit(command);
+}
+
+void SetpointGenerator::submit(Command& command) {
+  std::lock_guard<std::mutex> lock(this->mtx_);
+  this->write(command);
+}
+
+void SetpointGenerator::write(Command& command) {
+  command.stream = this->lastStream_;
+  this->lastMode_ = command.mode;
+  this->mailbox_.write(command);
+}
+
+double SetpointGenerator::getTarget() const {
+  return this->publishedTarget_.load(std::memory_order_relaxed);
+}
+
+double SetpointGenerator::getTargetPosition() const {
+  return this->publishedPosition_.load(std::memory_order_relaxed);
+}
+
+Reference SetpointGenerator::sample(std::chrono::steady_clock::time_point now,
+                                    double position) {
+  Command command;
+  if (this->mailbox_.read(command)) {
+    this->apply(command, now, position);
+  }
+
+  Reference reference;
+  switch (this->mode_) {
+    case Mode::PROFILE: {
+      const std::chrono::duration<double> time = now - this->profileStart_;
+      this->target_ = this->profile_.sample(time.count()).speed;
+      break;
+    }
+    case Mode::STREAM:
+      this->target_ = this->sampleStream(now);
+      break;
+    case Mode::MOVE: {
+      const std::chrono::duration<double> time = now - this->profileStart_;
+      const ProfileSample sample = this->profile_.sample(time.count());
+      this->target_ = sample.speed;
+      this->targetPosition_ = this->moveStart_ + sample.position;
+      reference.positionControl = true;
+      break;
+    }
+    case Mode::HOLD:
+      reference.positionControl = true;
+      break;
+    default:
+      break;
+  }
+
+  if (this->mode_ != Mode::STREAM) {
+    // Keep the queue free of the setpoints of abandoned streams.
+    while (this->peekSetpoint() && this->next_.stream <= this->stream_) {
+      this->hasNext_ = false;
+    }
+  }
+  if (!reference.positionControl) {
+    this->targetPosition_ = position;
+  }
+
+  reference.position = this->targetPosition_;
+  reference.speed = this->target_;
+  this->publishedTarget_.store(this->target_, std::memory_order_relaxed);
+  this->publishedPosition_.store(this->targetPosition_,
+                                 std::memory_order_relaxed);
+  return reference;
+}
+
+void SetpointGenerator::apply(const Command& command,
+                              std::chrono::steady_clock::time_point now,
+                              double position) {
+  // Position commands continue from the position target, if any.
+  const bool positionControl =
+      (this->mode_ == Mode::MOVE || this->mode_ == Mode::HOLD);
+  const double startPosition =
+      positionControl ? this->targetPosition_ : position;
+
+  // Setpoints up to this stream are either current or abandoned.
+  this->stream_ = command.stream;
+
+  switch (command.mode) {
+    case Mode::SPEED:
+      this->mode_ = Mode::SPEED;
+      this->target_ = command.speed;
+      break;
+    case Mode::RAMP:
+      this->mode_ = Mode::PROFILE;
+      this->profile_ = MotionProfile::ramp(this->target_, command.speed,
+                                           command.maxAcceleration,
+                                           command.shape);
+      this->profileStart_ = command.start;
+      break;
+    case Mode::PROFILE:
+      this->mode_ = Mode::PROFILE;
+      this->profile_ = command.profile;
+      this->profileStart_ = command.start;
+      break;
+    case Mode::STREAM:
+      // Start from the current target.
+      this->mode_ = Mode::STREAM;
+      this->previous_ = StreamedSetpoint{Setpoint{now, this->target_},
+                                         command.stream};
+      break;
+    case Mode::MOVE:
+      this->mode_ = Mode::MOVE;
+      this->profile_ = MotionProfile::move(
+          command.position - startPosition, command.speed,
+          command.maxAcceleration, command.shape);
+      this->profileStart_ = command.start;
+      this->moveStart_ = startPosition;
+      this->targetPosition_ = startPosition;
+      break;
+    case Mode::HOLD:
+      this->mode_ = Mode::HOLD;
+      this->target_ = 0.0;
+      this->targetPosition_ = startPosition;
+      break;
+  }
+}
+
+double SetpointGenerator::sampleStream(
+    std::chrono::steady_clock::time_point now) {
+  // Move past the setpoints that are due, dropping those of older streams.
+  // Setpoints of a newer stream wait for their command.
+  while (this->peekSetpoint()) {
+    if (this->next_.stream < this->stream_) {
+      this->hasNext_ = false;
+    } else if (this->next_.stream == this->stream_ &&
+               this->next_.setpoint.time <= now) {
+      this->previous_ = this->next_;
+      this->hasNext_ = false;
+    } else {
+      break;
+    }
+  }
+
+  const Setpoint& previous = this->previous_.setpoint;
+  if (!this->hasNext_ || this->next_.stream != this->stream_) {
+    return previous.speed;
+  }
+
+  const Setpoint& next = this->next_.setpoint;
+  const std::chrono::duration<double> span = next.time - previous.time;
+  const std::chrono::duration<double> elapsed = now - previous.time;
+  if (span.count() <= 0) return next.speed;
+  return previous.speed +
+         (next.speed - previous.speed) * elapsed.count() / span.count();
+}
+
+bool SetpointGenerator::peekSetpoint() {
+  if (!this->hasNext_) {
+    this->hasNext_ = this->setpoints_.pop(this->next_);
+  }
+  return this->hasNext_;
+}
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -0,0 +1,78 @@
+#include <motor_controllers/motor/telemetry_recorder.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>     // errno
+#include <cstddef>    // offsetof
+#include <cstring>    // std::strerror, std::memset, std::memcpy
+#include <stdexcept>  // std::runtime_error
+
+namespace motor_controllers {
+namespace motor {
+
+static_assert(sizeof(TelemetryRecord) == 48, "TelemetryRecord layout");
+static_assert(sizeof(TelemetryHeader) == 64, "TelemetryHeader layout");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) &&
+                  std::atomic<uint64_t>::is_always_lock_free,
+              "The write index is shared with other processes");
+
+TelemetryRecorder::TelemetryRecorder(const std::string& path, size_t capacity)
+    : path_(path),
+      capacity_(capacity),
+      size_(sizeof(TelemetryHeader) + capacity * sizeof(TelemetryRecord)),
+      mapping_(nullptr),
+      writeIndex_(nullptr),
+      records_(nullptr) {
+  if (capacity == 0) {
+    throw std::runtime_error(
+        "TelemetryRecorder: the capacity must be positive");
+  }
+
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open " + path + ": " +
+                             std::strerror(errno));
+  }
+  if (ftruncate(fd, this->size_) != 0) {
+    const int error = errno;
+    close(fd);
+    throw std::runtime_error("Cannot resize " + path + ": " +
+                             std::strerror(error));
+  }
+
+  this->mapping_ =
+      mmap(nullptr, this->size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const int error = errno;
+  close(fd);  // the mapping holds the file
+  if (this->mapping_ == MAP_FAILED) {
+    this->mapping_ = nullptr;
+    throw std::runtime_error("Cannot map " + path + ": " +
+                             std::strerror(error));
+  }
+
+  // Touch every page now, not in the control loop.
+  std::memset(this->mapping_, 0, this->size_);
+
+  TelemetryHeader header = {};
+  std::memcpy(header.magic, "MCTELEM", 8);
+  header.version = kVersion;
+  header.recordSize = sizeof(TelemetryRecord);
+  header.capacity = capacity;
+  std::memcpy(this->mapping_, &header, sizeof(header));
+
+  char* base = static_cast<char*>(this->mapping_);
+  this->writeIndex_ = reinterpret_cast<std::atomic<uint64_t>*>(
+      base + offsetof(TelemetryHeader, writeIndex));
+  this->records_ =
+      reinterpret_cast<TelemetryRecord*>(base + sizeof(TelemetryHeader));
+}
+
+TelemetryRecorder::~TelemetryRecorder() {
+  if (this->mapping_) {
+    munmap(this->mapping_, this->size_);
+  }
+}
+
+}  // namespace motor
+}  // namespace motor_controllers
@@ -11,6 +11,7 @@
 %}
 
 wrap_future(FutureBinarySignal, motor_controllers::communication::BinarySignal)
+wrap_future(FutureEdgeEvent, motor_controllers::communication::EdgeEvent)
 
 wrap_unique_ptr(PWMChannelPtr, motor_controllers::communication::IPWMSignalChannel, std::function<void(motor_controllers::communication::IPWMSignalChannel*)>);
 wrap_unique_ptr(BinaryChannelPtr, motor_controllers::communication::IBinarySignalChannel, std::function<void(motor_controllers::communication::IBinarySignalChannel*)>);
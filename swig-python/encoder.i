@@ -4,6 +4,7 @@
 
 %{
   #include <motor_controllers/encoder/encoder.h>
+  #include <motor_controllers/encoder/encoder_service.h>
 %}
 
 namespace motor_controllers {
@@ -16,10 +17,14 @@ namespace motor_controllers {
 
     %ignore Encoder::Encoder(communication::IBinarySignalChannel::Ref,unsigned int);
 
+    // The estimators are not wrapped, the Encoder keeps its default one
+    %ignore Encoder::setVelocityEstimator;
+
   }
 }
 
 %include <motor_controllers/encoder/encoder.h>
+%include <motor_controllers/encoder/encoder_service.h>
 
 namespace motor_controllers {
   namespace encoder {
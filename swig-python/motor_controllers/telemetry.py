@@ -0,0 +1,94 @@
+"""Read the telemetry of a DCMotor, as written by TelemetryRecorder.
+
+The file is mapped read-only: ``TelemetryFile.records`` is the ring itself as
+a numpy structured array, without any copy. ``TelemetryFile.latest`` returns
+the last records in time order, without the ones the control loop overwrote
+while they were being copied.
+
+Example::
+
+    telemetry = TelemetryFile("/tmp/motor.bin")
+    records = telemetry.latest()
+    plt.plot(records["timestamp"] * 1e-9, records["speed"])
+"""
+from typing import Optional
+
+import numpy as np
+
+HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "S8"),
+        ("version", "<u4"),
+        ("record_size", "<u4"),
+        ("capacity", "<u8"),
+        ("write_index", "<u8"),
+        ("reserved", "u1", (32,)),
+    ]
+)
+
+RECORD_DTYPE = np.dtype(
+    [
+        ("timestamp", "<i8"),  # CLOCK_MONOTONIC, in nanoseconds
+        ("setpoint", "<f8"),
+        ("speed", "<f8"),
+        ("error", "<f8"),
+        ("integral", "<f8"),
+        ("duty_cycle", "<f8"),
+    ]
+)
+
+VERSION = 1
+
+
+class TelemetryFile(object):
+    def __init__(self, path: str) -> None:
+        """Map a telemetry file, while or after it is written.
+
+        Args:
+            path (str): file given to the TelemetryRecorder
+        """
+        self._map = np.memmap(path, dtype=np.uint8, mode="r")
+        header = self._map[: HEADER_DTYPE.itemsize].view(HEADER_DTYPE)[0]
+        if header["magic"] != b"MCTELEM" or header["version"] != VERSION:
+            raise ValueError(f"{path} is not a telemetry file")
+        if header["record_size"] != RECORD_DTYPE.itemsize:
+            raise ValueError(f"Unexpected record size in {path}")
+
+        self.capacity = int(header["capacity"])
+        self.records = self._map[
+            HEADER_DTYPE.itemsize : HEADER_DTYPE.itemsize
+            + self.capacity * RECORD_DTYPE.itemsize
+        ].view(RECORD_DTYPE)
+        self._write_index = self._map[
+            HEADER_DTYPE.fields["write_index"][1] :
+        ][:8].view("<u8")
+
+    @property
+    def write_index(self) -> int:
+        """Number of records written since the creation of the file."""
+        return int(self._write_index[0])
+
+    def latest(self, count: Optional[int] = None) -> np.ndarray:
+        """Copy the last records, oldest first.
+
+        Args:
+            count (Optional[int]): at most that many, all the ring by default
+
+        Returns:
+            np.ndarray: of RECORD_DTYPE
+        """
+        end = self.write_index
+        begin = max(0, end - self.capacity)
+        if count is not None:
+            begin = max(begin, end - count)
+
+        indices = np.arange(begin, end) % self.capacity
+        records = self.records[indices]  # fancy indexing copies
+
+        # Drop what the control loop overwrote during the copy, up to the
+        # record it may be writing at write_index, on the slot of the record
+        # write_index - capacity.
+        overwritten = self.write_index - self.capacity - begin + 1
+        if overwritten > 0:
+            records = records[overwritten:]
+        return records